@@ -23,21 +23,22 @@ public:
     }
 
     void initializeRestaurants() {
-        Restaurant* restaurant1 = new Restaurant("Bikaner", "Delhi");
-        restaurant1->addMenuItem(MenuItem("P1", "Chole Bhature", 120));
-        restaurant1->addMenuItem(MenuItem("P2", "Samosa", 15));
+        RestaurantManager* restaurantManager = RestaurantManager::getInstance();
 
-        Restaurant* restaurant2 = new Restaurant("Haldiram", "Kolkata");
-        restaurant2->addMenuItem(MenuItem("P1", "Raj Kachori", 80));
-        restaurant2->addMenuItem(MenuItem("P2", "Pav Bhaji", 100));
-        restaurant2->addMenuItem(MenuItem("P3", "Dhokla", 50));
+        Restaurant* restaurant1 = new Restaurant("Bikaner", "Delhi", 28.6519, 77.1909);
+        restaurantManager->addMenuItem(restaurant1, MenuItem("P1", "Chole Bhature", 120));
+        restaurantManager->addMenuItem(restaurant1, MenuItem("P2", "Samosa", 15));
 
-        Restaurant* restaurant3 = new Restaurant("Saravana Bhavan", "Chennai");
-        restaurant3->addMenuItem(MenuItem("P1", "Masala Dosa", 90));
-        restaurant3->addMenuItem(MenuItem("P2", "Idli Vada", 60));
-        restaurant3->addMenuItem(MenuItem("P3", "Filter Coffee", 30));
+        Restaurant* restaurant2 = new Restaurant("Haldiram", "Kolkata", 22.5448, 88.3426);
+        restaurantManager->addMenuItem(restaurant2, MenuItem("P1", "Raj Kachori", 80));
+        restaurantManager->addMenuItem(restaurant2, MenuItem("P2", "Pav Bhaji", 100));
+        restaurantManager->addMenuItem(restaurant2, MenuItem("P3", "Dhokla", 50));
+
+        Restaurant* restaurant3 = new Restaurant("Saravana Bhavan", "Chennai", 13.0418, 80.2341);
+        restaurantManager->addMenuItem(restaurant3, MenuItem("P1", "Masala Dosa", 90));
+        restaurantManager->addMenuItem(restaurant3, MenuItem("P2", "Idli Vada", 60));
+        restaurantManager->addMenuItem(restaurant3, MenuItem("P3", "Filter Coffee", 30));
 
-        RestaurantManager* restaurantManager = RestaurantManager::getInstance();
         restaurantManager->addRestaurant(restaurant1);
         restaurantManager->addRestaurant(restaurant2);
         restaurantManager->addRestaurant(restaurant3);
@@ -49,6 +50,14 @@ public:
         return RestaurantManager::getInstance()->searchByLocation(location);
     }
 
+    vector<Restaurant*> searchRestaurantsNearby(double latitude, double longitude, double radiusKm, const string& menuItem = "") {
+        return RestaurantManager::getInstance()->searchNearby(latitude, longitude, radiusKm, menuItem);
+    }
+
+    vector<Restaurant*> searchRestaurantsByMenuItem(const string& itemName) {
+        return RestaurantManager::getInstance()->searchByMenuItem(itemName);
+    }
+
     void selectRestaurant(User* user, Restaurant* restaurant) {
         Cart* cart = user->getCart();
         cart->setRestaurant(restaurant);
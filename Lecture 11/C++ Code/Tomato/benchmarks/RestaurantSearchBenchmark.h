@@ -0,0 +1,194 @@
+#ifndef RESTAURANT_SEARCH_BENCHMARK_H
+#define RESTAURANT_SEARCH_BENCHMARK_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "../managers/RestaurantManager.h"
+using namespace std;
+
+// Fills RestaurantManager with generated restaurants and measures queries
+// per second for each kind of search. Every kind is also checked against
+// a linear scan on a sample of its queries.
+class RestaurantSearchBenchmark {
+private:
+    struct Random {
+        uint64_t state;
+        uint32_t next() {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            return (uint32_t)(state >> 33);
+        }
+        double uniform() {
+            return next() / 4294967296.0;
+        }
+        // Skewed towards small values, like dish popularity
+        uint32_t skewed(uint32_t range) {
+            return (uint32_t)((uint64_t)(next() % range) * (next() % range) / range);
+        }
+    };
+
+    struct Query {
+        string location;
+        double latitude;
+        double longitude;
+        string menuItem;
+    };
+
+    static double distanceKm(double lat1, double lon1, double lat2, double lon2) {
+        double dLat = (lat2 - lat1) * M_PI / 180.0;
+        double dLon = (lon2 - lon1) * M_PI / 180.0;
+        double a = sin(dLat / 2) * sin(dLat / 2)
+                 + cos(lat1 * M_PI / 180.0) * cos(lat2 * M_PI / 180.0) * sin(dLon / 2) * sin(dLon / 2);
+        return 2 * 6371.0 * asin(min(1.0, sqrt(a)));
+    }
+
+    // What a search cost before the indexes: every restaurant, every time
+    static vector<Restaurant*> scan(const vector<Restaurant*>& all, const Query& query, double radiusKm) {
+        vector<Restaurant*> result;
+        string loc = TextUtils::normalize(query.location);
+        vector<string> words = TextUtils::splitWords(TextUtils::normalize(query.menuItem));
+        for (Restaurant* r : all) {
+            if (!query.location.empty() && TextUtils::normalize(r->getLocation()) != loc) {
+                continue;
+            }
+            if (radiusKm > 0 && distanceKm(query.latitude, query.longitude, r->getLatitude(), r->getLongitude()) > radiusKm) {
+                continue;
+            }
+            if (!words.empty()) {
+                bool serves = false;
+                for (const auto& item : r->getMenu()) {
+                    vector<string> itemWords = TextUtils::splitWords(TextUtils::normalize(item.getName()));
+                    bool all = true;
+                    for (const string& word : words) {
+                        all = all && find(itemWords.begin(), itemWords.end(), word) != itemWords.end();
+                    }
+                    serves = serves || all;
+                }
+                if (!serves) {
+                    continue;
+                }
+            }
+            result.push_back(r);
+        }
+        return result;
+    }
+
+    static bool sameRestaurants(vector<Restaurant*> a, vector<Restaurant*> b) {
+        sort(a.begin(), a.end());
+        sort(b.begin(), b.end());
+        return a == b;
+    }
+
+    template <typename Search>
+    static void measure(const string& label, const vector<Query>& queries, const vector<Restaurant*>& all,
+                        double radiusKm, Search search) {
+        size_t results = 0;
+        auto start = chrono::steady_clock::now();
+        for (const Query& query : queries) {
+            results += search(query).size();
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        const int checks = 3;
+        bool matches = true;
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < checks; i++) {
+            matches = matches && sameRestaurants(search(queries[i]), scan(all, queries[i], radiusKm));
+        }
+        double scanMillis = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / checks;
+        cout << "  " << label << ": " << (long long)(queries.size() / seconds) << " QPS, "
+             << (double)results / queries.size() << " results; linear scan " << (long long)scanMillis
+             << " ms per query, same results: " << (matches ? "yes" : "NO") << endl;
+    }
+
+public:
+    static void run(int restaurantCount) {
+        const char* fillings[] = {"Paneer", "Chicken", "Veg", "Masala", "Butter", "Tandoori", "Egg", "Mutton",
+                                  "Aloo", "Dal", "Fish", "Mushroom", "Kadai", "Malai", "Schezwan"};
+        const char* dishes[] = {"Tikka", "Biryani", "Curry", "Dosa", "Roll", "Naan", "Fried Rice", "Momos",
+                                "Pizza", "Burger", "Thali", "Kebab", "Noodles", "Paratha", "Korma"};
+        const int cityCount = 500;
+        Random random = {42};
+        vector<double> cityLatitude, cityLongitude;
+        for (int c = 0; c < cityCount; c++) {
+            cityLatitude.push_back(8.0 + 26.0 * random.uniform());
+            cityLongitude.push_back(68.0 + 29.0 * random.uniform());
+        }
+
+        cout << "=== RESTAURANT SEARCH: " << restaurantCount << " restaurants in " << cityCount << " cities ===" << endl;
+        RestaurantManager* manager = RestaurantManager::getInstance();
+        vector<Restaurant*> all;
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < restaurantCount; i++) {
+            int city = random.skewed(cityCount);
+            // Within about 15 km of the city centre
+            Restaurant* r = new Restaurant("Restaurant " + to_string(i), "City " + to_string(city),
+                                           cityLatitude[city] + 0.27 * (random.uniform() - 0.5),
+                                           cityLongitude[city] + 0.27 * (random.uniform() - 0.5));
+            for (int m = 0; m < 5; m++) {
+                manager->addMenuItem(r, MenuItem("P" + to_string(m + 1),
+                                                 string(fillings[random.skewed(15)]) + " " + dishes[random.skewed(15)],
+                                                 50 + random.next() % 400));
+            }
+            manager->addRestaurant(r);
+            all.push_back(r);
+        }
+        cout << "indexed in " << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s" << endl;
+
+        // Queries centred on random restaurants, typed the way users type
+        const int queryCount = 20000;
+        vector<Query> queries;
+        for (int q = 0; q < queryCount; q++) {
+            Restaurant* around = all[random.next() % all.size()];
+            string location = around->getLocation();
+            if (q % 2) {
+                transform(location.begin(), location.end(), location.begin(), ::toupper);
+            }
+            string item = string(fillings[random.next() % 15]) + " " + dishes[random.next() % 15];
+            queries.push_back({" " + location + " ", around->getLatitude(), around->getLongitude(), item});
+        }
+        vector<Query> rareDishes = queries;
+        for (Query& query : rareDishes) {
+            query.location.clear();
+            query.menuItem = dishes[14 - random.skewed(3)];
+        }
+        vector<Query> locationOnly = queries, nearbyOnly = queries, menuOnly = queries;
+        for (size_t q = 0; q < queries.size(); q++) {
+            locationOnly[q].menuItem.clear();
+            nearbyOnly[q].location.clear();
+            nearbyOnly[q].menuItem.clear();
+            menuOnly[q].location.clear();
+        }
+        vector<Query> nearbyWithItem = menuOnly;
+        // Menu-only searches return tens of thousands of restaurants each; fewer of them
+        menuOnly.resize(1000);
+
+        measure("location", locationOnly, all, 0, [&](const Query& query) {
+            return manager->searchByLocation(query.location);
+        });
+        measure("within 2 km", nearbyOnly, all, 2, [&](const Query& query) {
+            return manager->searchNearby(query.latitude, query.longitude, 2);
+        });
+        measure("within 5 km", nearbyOnly, all, 5, [&](const Query& query) {
+            return manager->searchNearby(query.latitude, query.longitude, 5);
+        });
+        measure("menu item, one rare word", rareDishes, all, 0, [&](const Query& query) {
+            return manager->searchByMenuItem(query.menuItem);
+        });
+        measure("menu item, two words", menuOnly, all, 0, [&](const Query& query) {
+            return manager->searchByMenuItem(query.menuItem);
+        });
+        measure("within 5 km serving a two-word item", nearbyWithItem, all, 5, [&](const Query& query) {
+            return manager->searchNearby(query.latitude, query.longitude, 5, query.menuItem);
+        });
+        measure("within 5 km serving a rare dish", rareDishes, all, 5, [&](const Query& query) {
+            return manager->searchNearby(query.latitude, query.longitude, 5, query.menuItem);
+        });
+    }
+};
+
+#endif // RESTAURANT_SEARCH_BENCHMARK_H
@@ -1,8 +1,15 @@
 #include <iostream>
+#include <string>
 #include "TomatoApp.h"
+#include "benchmarks/RestaurantSearchBenchmark.h"
 using namespace std;
 
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--benchmark") {
+        RestaurantSearchBenchmark::run(1000000);
+        return 0;
+    }
+
     // Create TomatoApp Object
     TomatoApp* tomato = new TomatoApp();
 
@@ -22,6 +29,12 @@ int main() {
         cout << " - " << restaurant->getName() << endl;
     }
 
+    // User looks for a dish within 10 km of Connaught Place
+    cout << "Serving Samosa nearby:" << endl;
+    for (auto restaurant : tomato->searchRestaurantsNearby(28.6315, 77.2167, 10, "samosa")) {
+        cout << " - " << restaurant->getName() << endl;
+    }
+
     // User selects a restaurant
     tomato->selectRestaurant(user, restaurantList[0]);
 
@@ -3,19 +3,198 @@
 
 #include <vector>
 #include <string>
+#include <unordered_map>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include "../models/Restaurant.h"
+#include "../utils/TextUtils.h"
 using namespace std;
 
+// Keeps every registered restaurant plus three indexes built in
+// addRestaurant, so that a search only touches restaurants that can match:
+//  - normalized location -> restaurants
+//  - a lat/lon grid for radius search
+//  - menu item name word -> (restaurant, item) pairs
+// Index lists hold positions in `restaurants` and are kept sorted.
 class RestaurantManager {
 private:
+    struct GeoPoint {
+        double latitude;
+        double longitude;
+        int index;
+    };
+
+    struct MenuEntry {
+        int index;
+        int item;     // position in the restaurant's menu
+        bool operator<(const MenuEntry& other) const {
+            return index != other.index ? index < other.index : item < other.item;
+        }
+        bool operator==(const MenuEntry& other) const {
+            return index == other.index && item == other.item;
+        }
+    };
+
+    static constexpr double CELL_DEGREES = 0.02;      // about 2.2 km north-south
+    static constexpr double EARTH_RADIUS_KM = 6371.0;
+    static constexpr double KM_PER_DEGREE = EARTH_RADIUS_KM * M_PI / 180.0;
+    static const int64_t LATITUDE_CELLS = 9000;       // 180 / CELL_DEGREES
+    static const int64_t LONGITUDE_CELLS = 18000;     // 360 / CELL_DEGREES
+
     vector<Restaurant*> restaurants;
+    unordered_map<int, int> indexById;
+    unordered_map<string, vector<int>> byLocation;
+    unordered_map<int64_t, vector<GeoPoint>> grid;
+    unordered_map<string, vector<MenuEntry>> byMenuWord;
     static RestaurantManager* instance;
 
     RestaurantManager() {
         // private constructor
     }
 
+    static int64_t latitudeCell(double latitude) {
+        return min(LATITUDE_CELLS - 1, max<int64_t>(0, (int64_t)floor((latitude + 90.0) / CELL_DEGREES)));
+    }
+
+    // Not wrapped yet, so that ranges across the antimeridian stay contiguous
+    static int64_t unwrappedLongitudeCell(double longitude) {
+        return (int64_t)floor((longitude + 180.0) / CELL_DEGREES);
+    }
+
+    static int64_t longitudeCell(int64_t unwrapped) {
+        int64_t cell = unwrapped % LONGITUDE_CELLS;
+        return cell < 0 ? cell + LONGITUDE_CELLS : cell;
+    }
+
+    static int64_t cellKey(int64_t latCell, int64_t lonCell) {
+        return latCell * LONGITUDE_CELLS + lonCell;
+    }
+
+    static double distanceKm(double lat1, double lon1, double lat2, double lon2) {
+        double dLat = (lat2 - lat1) * M_PI / 180.0;
+        double dLon = (lon2 - lon1) * M_PI / 180.0;
+        double a = sin(dLat / 2) * sin(dLat / 2)
+                 + cos(lat1 * M_PI / 180.0) * cos(lat2 * M_PI / 180.0) * sin(dLon / 2) * sin(dLon / 2);
+        return 2 * EARTH_RADIUS_KM * asin(min(1.0, sqrt(a)));
+    }
+
+    void indexMenuItem(int index, int item, const string& name) {
+        MenuEntry entry = {index, item};
+        for (const string& word : TextUtils::splitWords(TextUtils::normalize(name))) {
+            vector<MenuEntry>& postings = byMenuWord[word];
+            // Appends while restaurants are being added; items added later are slotted in
+            auto at = lower_bound(postings.begin(), postings.end(), entry);
+            if (at == postings.end() || !(*at == entry)) {
+                postings.insert(at, entry);
+            }
+        }
+    }
+
+    // Posting lists of the query words, shortest first; empty if any word is unknown
+    vector<const vector<MenuEntry>*> menuPostings(const string& itemName) {
+        vector<const vector<MenuEntry>*> lists;
+        for (const string& word : TextUtils::splitWords(TextUtils::normalize(itemName))) {
+            auto found = byMenuWord.find(word);
+            if (found == byMenuWord.end()) {
+                return {};
+            }
+            lists.push_back(&found->second);
+        }
+        sort(lists.begin(), lists.end(), [](const vector<MenuEntry>* a, const vector<MenuEntry>* b) {
+            return a->size() < b->size();
+        });
+        return lists;
+    }
+
+    // First position at or after `from` not less than target. Steps double
+    // from `from`, so a walk through the whole list stays linear overall.
+    static vector<MenuEntry>::const_iterator gallop(vector<MenuEntry>::const_iterator from,
+                                                    vector<MenuEntry>::const_iterator end, const MenuEntry& target) {
+        ptrdiff_t step = 1;
+        while (step < end - from && *(from + step) < target) {
+            from += step;
+            step *= 2;
+        }
+        return lower_bound(from, from + min(step, (ptrdiff_t)(end - from)), target);
+    }
+
+    // Restaurants with one item that has every word, in index order
+    static vector<int> servingRestaurants(const vector<const vector<MenuEntry>*>& lists) {
+        vector<int> result;
+        vector<vector<MenuEntry>::const_iterator> from;
+        for (const auto* list : lists) {
+            from.push_back(list->begin());
+        }
+        for (const MenuEntry& entry : *lists[0]) {
+            if (!result.empty() && result.back() == entry.index) {
+                continue;
+            }
+            bool inAll = true;
+            for (size_t l = 1; l < lists.size() && inAll; l++) {
+                from[l] = gallop(from[l], lists[l]->end(), entry);
+                inAll = from[l] != lists[l]->end() && *from[l] == entry;
+            }
+            if (inAll) {
+                result.push_back(entry.index);
+            }
+        }
+        return result;
+    }
+
+    static bool serves(int index, const vector<const vector<MenuEntry>*>& lists) {
+        auto item = lower_bound(lists[0]->begin(), lists[0]->end(), MenuEntry{index, 0});
+        for (; item != lists[0]->end() && item->index == index; ++item) {
+            bool inAll = true;
+            for (size_t l = 1; l < lists.size() && inAll; l++) {
+                inAll = binary_search(lists[l]->begin(), lists[l]->end(), *item);
+            }
+            if (inAll) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Calls visit(points) for each occupied grid cell that overlaps the circle
+    template <typename Visit>
+    void forEachCell(double latitude, double longitude, double radiusKm, Visit visit) {
+        double latSpan = radiusKm / KM_PER_DEGREE;
+        double lonSpan = latSpan / cos(min(89.9, fabs(latitude) + latSpan) * M_PI / 180.0);
+        int64_t latFirst = latitudeCell(latitude - latSpan);
+        int64_t latLast = latitudeCell(latitude + latSpan);
+        int64_t lonFirst = unwrappedLongitudeCell(longitude - min(180.0, lonSpan));
+        int64_t lonCount = min(LONGITUDE_CELLS, unwrappedLongitudeCell(longitude + min(180.0, lonSpan)) - lonFirst + 1);
+
+        // A huge radius covers more cells than are occupied: walk those instead
+        if ((latLast - latFirst + 1) * lonCount > (int64_t)grid.size()) {
+            for (const auto& cell : grid) {
+                visit(cell.second);
+            }
+            return;
+        }
+        for (int64_t latCell = latFirst; latCell <= latLast; latCell++) {
+            for (int64_t step = 0; step < lonCount; step++) {
+                auto found = grid.find(cellKey(latCell, longitudeCell(lonFirst + step)));
+                if (found != grid.end()) {
+                    visit(found->second);
+                }
+            }
+        }
+    }
+
+    static vector<Restaurant*> nearestFirst(vector<pair<double, Restaurant*>>& found) {
+        sort(found.begin(), found.end(), [](const pair<double, Restaurant*>& a, const pair<double, Restaurant*>& b) {
+            return a.first < b.first;
+        });
+        vector<Restaurant*> result;
+        result.reserve(found.size());
+        for (const auto& entry : found) {
+            result.push_back(entry.second);
+        }
+        return result;
+    }
+
 public:
     static RestaurantManager* getInstance() {
         if (!instance) {
@@ -24,19 +203,111 @@ public:
         return instance;
     }
 
+    // Indexes the restaurant as it is now. Restaurant only lets this class
+    // change its menu or location, so addMenuItem / updateLocation below
+    // keep the indexes current.
     void addRestaurant(Restaurant* r) {
+        int index = (int)restaurants.size();
         restaurants.push_back(r);
+        indexById[r->getRestaurantId()] = index;
+        byLocation[TextUtils::normalize(r->getLocation())].push_back(index);
+        if (r->hasCoordinates()) {
+            grid[cellKey(latitudeCell(r->getLatitude()), longitudeCell(unwrappedLongitudeCell(r->getLongitude())))]
+                .push_back({r->getLatitude(), r->getLongitude(), index});
+        }
+        const vector<MenuItem>& menu = r->getMenu();
+        for (size_t item = 0; item < menu.size(); item++) {
+            indexMenuItem(index, (int)item, menu[item].getName());
+        }
     }
 
+    void addMenuItem(Restaurant* r, const MenuItem& item) {
+        r->addMenuItem(item);
+        auto found = indexById.find(r->getRestaurantId());
+        if (found != indexById.end()) {
+            indexMenuItem(found->second, (int)r->getMenu().size() - 1, item.getName());
+        }
+    }
+
+    void updateLocation(Restaurant* r, const string& location) {
+        auto found = indexById.find(r->getRestaurantId());
+        if (found != indexById.end()) {
+            vector<int>& postings = byLocation[TextUtils::normalize(r->getLocation())];
+            auto at = lower_bound(postings.begin(), postings.end(), found->second);
+            if (at != postings.end() && *at == found->second) {
+                postings.erase(at);
+            }
+            vector<int>& moved = byLocation[TextUtils::normalize(location)];
+            moved.insert(lower_bound(moved.begin(), moved.end(), found->second), found->second);
+        }
+        r->setLocation(location);
+    }
+
+    // Case, spacing and punctuation do not matter: "new  delhi" finds "New Delhi"
     vector<Restaurant*> searchByLocation(string loc) {
         vector<Restaurant*> result;
-        transform(loc.begin(), loc.end(), loc.begin(), ::tolower);
-        for (auto r : restaurants) {
-            string rl = r->getLocation();
-            transform(rl.begin(), rl.end(), rl.begin(), ::tolower);
-            if (rl == loc) {
-                result.push_back(r);
+        auto found = byLocation.find(TextUtils::normalize(loc));
+        if (found != byLocation.end()) {
+            result.reserve(found->second.size());
+            for (int index : found->second) {
+                result.push_back(restaurants[index]);
+            }
+        }
+        return result;
+    }
+
+    // Restaurants within radiusKm, nearest first. With a menu item, only
+    // those serving it; whichever is smaller of the grid cells and the
+    // rarest query word's list is scanned.
+    vector<Restaurant*> searchNearby(double latitude, double longitude, double radiusKm, const string& menuItem = "") {
+        vector<pair<double, Restaurant*>> found;
+        vector<const vector<MenuEntry>*> lists;
+        if (!TextUtils::normalize(menuItem).empty()) {
+            lists = menuPostings(menuItem);
+            if (lists.empty()) {
+                return {};
+            }
+        }
+
+        size_t inCells = 0;
+        if (!lists.empty()) {
+            forEachCell(latitude, longitude, radiusKm, [&](const vector<GeoPoint>& points) {
+                inCells += points.size();
+            });
+        }
+        if (!lists.empty() && lists[0]->size() < inCells) {
+            for (int index : servingRestaurants(lists)) {
+                Restaurant* r = restaurants[index];
+                if (r->hasCoordinates()) {
+                    double distance = distanceKm(latitude, longitude, r->getLatitude(), r->getLongitude());
+                    if (distance <= radiusKm) {
+                        found.push_back({distance, r});
+                    }
+                }
+            }
+            return nearestFirst(found);
+        }
+        forEachCell(latitude, longitude, radiusKm, [&](const vector<GeoPoint>& points) {
+            for (const GeoPoint& point : points) {
+                double distance = distanceKm(latitude, longitude, point.latitude, point.longitude);
+                if (distance <= radiusKm && (lists.empty() || serves(point.index, lists))) {
+                    found.push_back({distance, restaurants[point.index]});
+                }
             }
+        });
+        return nearestFirst(found);
+    }
+
+    // Restaurants with a menu item whose name contains every word of the
+    // query, in any order: "dosa masala" finds "Masala Dosa"
+    vector<Restaurant*> searchByMenuItem(const string& itemName) {
+        vector<Restaurant*> result;
+        vector<const vector<MenuEntry>*> lists = menuPostings(itemName);
+        if (lists.empty()) {
+            return result;
+        }
+        for (int index : servingRestaurants(lists)) {
+            result.push_back(restaurants[index]);
         }
         return result;
     }
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <cmath>
 #include "MenuItem.h"
 using namespace std;
 
@@ -13,15 +14,37 @@ private:
     int restaurantId;
     string name;
     string location;
+    double latitude;    // NAN when the address has not been geocoded
+    double longitude;
     vector<MenuItem> menu;
 
+    // Menu and location changes go through RestaurantManager, which keeps
+    // its search indexes in step with them
+    friend class RestaurantManager;
+
+    void setLocation(const string &loc) {
+        location = loc;
+    }
+
+    void addMenuItem(const MenuItem &item) {
+        menu.push_back(item);
+    }
+
 public:
     Restaurant(const string& name, const string& location) {
         this->name = name;
         this->location = location;
+        this->latitude = NAN;
+        this->longitude = NAN;
         this->restaurantId = ++nextRestaurantId;
     }
 
+    Restaurant(const string& name, const string& location, double latitude, double longitude)
+        : Restaurant(name, location) {
+        this->latitude = latitude;
+        this->longitude = longitude;
+    }
+
     ~Restaurant() {
         // Optional: just for clarity or debug
         cout << "Destroying Restaurant: " << name << ", and clearing its menu." << endl;
@@ -29,6 +52,10 @@ public:
     }
 
     //Getters and setters
+    int getRestaurantId() const {
+        return restaurantId;
+    }
+
     string getName() const {
         return name;
     }
@@ -41,12 +68,16 @@ public:
         return location;
     }
 
-    void setLocation(const string &loc) {
-        location = loc;
+    double getLatitude() const {
+        return latitude;
     }
 
-    void addMenuItem(const MenuItem &item) {
-        menu.push_back(item);
+    double getLongitude() const {
+        return longitude;
+    }
+
+    bool hasCoordinates() const {
+        return !isnan(latitude) && !isnan(longitude);
     }
 
     const vector<MenuItem>& getMenu() const {
@@ -0,0 +1,46 @@
+#ifndef TEXT_UTILS_H
+#define TEXT_UTILS_H
+
+#include <string>
+#include <vector>
+#include <cctype>
+using namespace std;
+
+class TextUtils {
+public:
+    // Lower-cases ASCII letters and turns every run of spaces and
+    // punctuation into one space, trimmed: "  New  Delhi," -> "new delhi".
+    // Other bytes (UTF-8 names) are kept as they are.
+    static string normalize(const string& text) {
+        string result;
+        result.reserve(text.size());
+        for (unsigned char c : text) {
+            if (c >= 0x80 || isalnum(c)) {
+                result += (char)tolower(c);
+            } else if (!result.empty() && result.back() != ' ') {
+                result += ' ';
+            }
+        }
+        if (!result.empty() && result.back() == ' ') {
+            result.pop_back();
+        }
+        return result;
+    }
+
+    // Words of an already normalized string
+    static vector<string> splitWords(const string& normalized) {
+        vector<string> words;
+        size_t start = 0;
+        while (start < normalized.size()) {
+            size_t end = normalized.find(' ', start);
+            if (end == string::npos) {
+                end = normalized.size();
+            }
+            words.push_back(normalized.substr(start, end - start));
+            start = end + 1;
+        }
+        return words;
+    }
+};
+
+#endif // TEXT_UTILS_H
@@ -2,6 +2,15 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <cstdint>
+#include <cstdlib>
 
 using namespace std;
 
@@ -20,46 +29,267 @@ public:
     virtual ~IChannel() {}
 };
 
+// Subscribers grouped by topic. Each group is a dense array and
+// subscribers are removed by swapping the last one into their slot; a hash
+// map from subscriber to (group, slot) makes subscribe and unsubscribe O(1)
+// instead of a linear find. Group 0 holds subscribers to every topic.
+class SubscriberIndex {
+private:
+    struct Location {
+        uint32_t group;
+        uint32_t slot;
+    };
+
+    vector<vector<ISubscriber*>> groups;
+    unordered_map<string, uint32_t> groupOfTopic;
+    unordered_map<ISubscriber*, Location> where;
+
+public:
+    static const uint32_t ALL_TOPICS = 0;
+    static const uint32_t NO_GROUP = UINT32_MAX;
+
+    SubscriberIndex() : groups(1) {}
+
+    // One subscription per subscriber; subscribing again moves it to topic
+    // ("" = all topics). Returns false if it was already there.
+    bool add(ISubscriber* subscriber, const string& topic) {
+        uint32_t group = ALL_TOPICS;
+        if (!topic.empty()) {
+            auto it = groupOfTopic.find(topic);
+            if (it == groupOfTopic.end()) {
+                it = groupOfTopic.emplace(topic, (uint32_t)groups.size()).first;
+                groups.emplace_back();
+            }
+            group = it->second;
+        }
+        auto found = where.find(subscriber);
+        if (found != where.end()) {
+            if (found->second.group == group) {
+                return false;
+            }
+            remove(subscriber);
+        }
+        where[subscriber] = {group, (uint32_t)groups[group].size()};
+        groups[group].push_back(subscriber);
+        return true;
+    }
+
+    bool remove(ISubscriber* subscriber) {
+        auto found = where.find(subscriber);
+        if (found == where.end()) {
+            return false;
+        }
+        vector<ISubscriber*>& members = groups[found->second.group];
+        uint32_t slot = found->second.slot;
+        ISubscriber* last = members.back();
+        members[slot] = last;
+        where[last].slot = slot;
+        members.pop_back();
+        where.erase(subscriber);
+        return true;
+    }
+
+    uint32_t findGroup(const string& topic) const {
+        auto it = groupOfTopic.find(topic);
+        return it == groupOfTopic.end() ? NO_GROUP : it->second;
+    }
+
+    const vector<ISubscriber*>& members(uint32_t group) const {
+        return groups[group];
+    }
+
+    size_t size() const {
+        return where.size();
+    }
+
+    void reserve(size_t subscribers) {
+        where.reserve(subscribers);
+        groups[ALL_TOPICS].reserve(subscribers);
+    }
+};
+
+// Threads for sharded delivery, started once and parked between publishes.
+// run() wakes them, delivers shard 0 on the calling thread and returns once
+// every shard is done. Worker k only ever delivers shard k.
+class DeliveryPool {
+private:
+    vector<thread> workers;
+    mutex mtx;
+    condition_variable wake;
+    condition_variable finished;
+    const vector<ISubscriber*>* group;
+    size_t shards;
+    size_t running;             // shards still being delivered by workers
+    uint64_t generation;        // bumped once per run()
+    bool stopping;
+
+    static void deliverShard(const vector<ISubscriber*>& group, size_t shard, size_t shards) {
+        size_t last = group.size() * (shard + 1) / shards;
+        for (size_t i = group.size() * shard / shards; i < last; i++) {
+            group[i]->update();
+        }
+    }
+
+    void workerLoop(size_t shard) {
+        uint64_t seen = 0;
+        unique_lock<mutex> lock(mtx);
+        while (true) {
+            wake.wait(lock, [this, seen]() { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+            if (shard >= shards) {
+                continue;       // this publish needs fewer shards
+            }
+            const vector<ISubscriber*>& work = *group;
+            size_t count = shards;
+            lock.unlock();
+            deliverShard(work, shard, count);
+            lock.lock();
+            if (--running == 0) {
+                finished.notify_one();
+            }
+        }
+    }
+
+    void stop() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+        stopping = false;
+    }
+
+public:
+    DeliveryPool() {
+        group = nullptr;
+        shards = 0;
+        running = 0;
+        generation = 0;
+        stopping = false;
+    }
+
+    ~DeliveryPool() {
+        stop();
+    }
+
+    // Total threads including the caller of run()
+    void resize(int threads) {
+        stop();
+        for (int shard = 1; shard < threads; shard++) {
+            workers.emplace_back(&DeliveryPool::workerLoop, this, (size_t)shard);
+        }
+    }
+
+    size_t size() {
+        return workers.size() + 1;
+    }
+
+    // shards must not exceed size()
+    void run(const vector<ISubscriber*>& members, size_t count) {
+        {
+            lock_guard<mutex> lock(mtx);
+            group = &members;
+            shards = count;
+            running = count - 1;
+            generation++;
+        }
+        wake.notify_all();
+        deliverShard(members, 0, count);
+        unique_lock<mutex> lock(mtx);
+        finished.wait(lock, [this]() { return running == 0; });
+    }
+};
+
 // Concrete Subject: a YouTube channel that observers can subscribe to
 class Channel : public IChannel {
 private:
-    vector<ISubscriber*> subscribers;  // list of subscribers
+    SubscriberIndex subscribers;       // subscribers by topic
     string name;
     string latestVideo;               // latest uploaded video title
+    string latestTopic;
+    DeliveryPool pool;
+
+    static const size_t MIN_SHARD = 16384;
+
+    // Large groups are split into shards delivered by the pool's threads
+    void deliver(const vector<ISubscriber*>& group) {
+        size_t shards = min(pool.size(), group.size() / MIN_SHARD);
+        if (shards <= 1) {
+            for (ISubscriber* sub : group) {
+                sub->update();
+            }
+            return;
+        }
+        pool.run(group, shards);
+    }
+
 public:
     Channel(const string& name) {
         this->name = name;
     }
 
-    // Add a subscriber (avoid duplicates)
+    // Add a subscriber to every upload (avoid duplicates)
     void subscribe(ISubscriber* subscriber) override {
-        if (find(subscribers.begin(), subscribers.end(), subscriber) == subscribers.end()) {
-            subscribers.push_back(subscriber);
-        }
+        subscribers.add(subscriber, "");
+    }
+
+    // Add a subscriber to uploads of one topic only
+    void subscribe(ISubscriber* subscriber, const string& topic) {
+        subscribers.add(subscriber, topic);
     }
 
     // Remove a subscriber if present
     void unsubscribe(ISubscriber* subscriber) override {
-        auto it = find(subscribers.begin(), subscribers.end(), subscriber);
-        if (it != subscribers.end()) {
-            subscribers.erase(it);
-        }
+        subscribers.remove(subscriber);
     }
 
-    // Notify all subscribers of the latest video
+    // Notify the subscribers of the latest video: everyone on every topic,
+    // plus those following its topic
     void notifySubscribers() override {
-        for (ISubscriber* sub : subscribers) {
-            sub->update();
+        deliver(subscribers.members(SubscriberIndex::ALL_TOPICS));
+        if (!latestTopic.empty()) {
+            uint32_t group = subscribers.findGroup(latestTopic);
+            if (group != SubscriberIndex::NO_GROUP) {
+                deliver(subscribers.members(group));
+            }
         }
     }
 
     // Upload a new video and notify all subscribers
-    void uploadVideo(const string& title) {
+    void uploadVideo(const string& title, const string& topic = "") {
         latestVideo = title;
+        latestTopic = topic;
         cout << "\n[" << name << " uploaded \"" << title << "\"]\n";
         notifySubscribers();
     }
 
+    // With more than one thread, big fan-outs call update() concurrently
+    // from several threads; subscribers must then be safe for that. The
+    // extra threads are started here and live as long as the channel. Not
+    // safe to call during an upload.
+    void setDeliveryThreads(int threads) {
+        pool.resize(max(1, threads));
+    }
+
+    void reserveSubscribers(size_t count) {
+        subscribers.reserve(count);
+    }
+
+    size_t getSubscriberCount() {
+        return subscribers.size();
+    }
+
+    const string& getLatestVideo() {
+        return latestVideo;
+    }
+
     // Read video data
     string getVideoData() {
         return "\nCheckout our new Video : " + latestVideo + "\n";
@@ -83,7 +313,102 @@ public:
     }
 };
 
-int main() {
+// Subscriber that only counts what it receives; each has its own counter,
+// so sharded delivery needs no synchronisation.
+class CountingSubscriber : public ISubscriber {
+private:
+    Channel* channel;
+    size_t received;
+public:
+    CountingSubscriber(Channel* channel) {
+        this->channel = channel;
+        received = 0;
+    }
+    void update() override {
+        received += channel->getLatestVideo().size() > 0;
+    }
+    size_t getReceived() {
+        return received;
+    }
+};
+
+void runFanOutBenchmark(int count) {
+    cout << "=== FAN-OUT: " << count << " subscribers ===\n";
+    Channel* channel = new Channel("BigChannel");
+    channel->reserveSubscribers(count);
+    vector<CountingSubscriber*> subs;
+    for (int i = 0; i < count; i++) {
+        subs.push_back(new CountingSubscriber(channel));
+    }
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        channel->subscribe(subs[i], i % 10 == 0 ? "shorts" : "");
+    }
+    double subscribeNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / count;
+
+    // At least 4 threads, so the sharded path runs even on a single core.
+    // Each round must reach every subscriber exactly once per upload it
+    // follows: general subscribers get both, "shorts" ones only the short.
+    int threads = max(4u, thread::hardware_concurrency());
+    vector<size_t> before(count);
+    for (int t : {1, threads}) {
+        channel->setDeliveryThreads(t);
+        for (int i = 0; i < count; i++) {
+            before[i] = subs[i]->getReceived();
+        }
+        start = chrono::steady_clock::now();
+        channel->uploadVideo("Upload to everyone");
+        double allMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        start = chrono::steady_clock::now();
+        channel->uploadVideo("A short", "shorts");
+        double topicMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        int wrong = 0;
+        for (int i = 0; i < count; i++) {
+            wrong += subs[i]->getReceived() - before[i] != (i % 10 == 0 ? 1u : 2u);
+        }
+        cout << t << " delivery thread(s): general upload " << allMs << " ms, \"shorts\" upload (all + topic) "
+             << topicMs << " ms, " << wrong << " subscribers not updated exactly once per upload\n";
+    }
+
+    vector<int> order(count);
+    for (int i = 0; i < count; i++) order[i] = i;
+    shuffle(order.begin(), order.end(), mt19937(42));
+    start = chrono::steady_clock::now();
+    for (int i : order) {
+        channel->unsubscribe(subs[i]);
+    }
+    double unsubscribeNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / count;
+    cout << "subscribe " << subscribeNs << " ns, unsubscribe (random order) " << unsubscribeNs << " ns, "
+         << channel->getSubscriberCount() << " left\n";
+
+    // The previous vector + find/erase, at a size it can finish
+    const int legacyCount = 20000;
+    vector<ISubscriber*> legacy(subs.begin(), subs.begin() + legacyCount);
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < legacyCount; i++) {
+        ISubscriber* target = subs[order[i] % legacyCount];
+        auto it = find(legacy.begin(), legacy.end(), target);
+        if (it != legacy.end()) legacy.erase(it);
+    }
+    cout << "vector find/erase unsubscribe with " << legacyCount << " subscribers: "
+         << chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / legacyCount << " ns\n";
+
+    size_t received = 0;
+    for (CountingSubscriber* sub : subs) {
+        received += sub->getReceived();
+        delete sub;
+    }
+    cout << "updates delivered: " << received << "\n";
+    delete channel;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--benchmark") {
+        runFanOutBenchmark(argc > 2 ? atoi(argv[2]) : 1000000);
+        return 0;
+    }
+
     // Create a channel and subscribers
     Channel* channel = new Channel("CoderArmy");
 
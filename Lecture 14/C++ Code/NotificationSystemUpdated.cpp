@@ -2,6 +2,25 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <fstream>
+#include <cstdlib>
+#include <unordered_map>
+#include <map>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
 
 using namespace std;
 
@@ -11,7 +30,15 @@ using namespace std;
 
 class INotification {
 public:
-    virtual string getContent() const = 0;
+    // Appends this notification's text to out. Decorators append around
+    // the wrapped notification, so a whole chain renders into one buffer.
+    virtual void renderTo(string& out) const = 0;
+
+    virtual string getContent() const {
+        string content;
+        renderTo(content);
+        return content;
+    }
 
     virtual ~INotification() {}
 };
@@ -24,8 +51,8 @@ public:
     SimpleNotification(const string& msg) {
         text = msg;
     }
-    string getContent() const override {
-        return text;
+    void renderTo(string& out) const override {
+        out += text;
     }
 };
 
@@ -47,8 +74,9 @@ class TimestampDecorator : public INotificationDecorator {
 public:
     TimestampDecorator(INotification* n) : INotificationDecorator(n) { }
     
-    string getContent() const override {
-        return "[2025-04-13 14:22:00] " + notification->getContent();
+    void renderTo(string& out) const override {
+        out += "[2025-04-13 14:22:00] ";
+        notification->renderTo(out);
     }
 };
 
@@ -60,8 +88,158 @@ public:
     SignatureDecorator(INotification* n, const string& sig) : INotificationDecorator(n) {
         signature = sig;
     }
-    string getContent() const override {
-        return notification->getContent() + "\n-- " + signature + "\n\n";
+    void renderTo(string& out) const override {
+        notification->renderTo(out);
+        out += "\n-- ";
+        out += signature;
+        out += "\n\n";
+    }
+};
+
+/*============================
+   Rendered content & storage
+=============================*/
+
+// A notification rendered once, shared read-only by every observer and
+// channel queue.
+typedef shared_ptr<const string> NotificationContent;
+
+// Pool of render buffers (Singleton). When the last reference to a rendered
+// notification goes away its buffer comes back here with its capacity
+// intact, so sustained traffic reuses the same few buffers.
+class RenderedNotificationPool {
+private:
+    static RenderedNotificationPool* instance;
+    mutex mtx;
+    vector<string*> freeBuffers;
+    size_t maxFree;
+    size_t maxBufferBytes;
+
+    RenderedNotificationPool() {
+        maxFree = 4096;
+        maxBufferBytes = 4096;
+    }
+
+    void release(string* buffer) {
+        if (buffer->capacity() <= maxBufferBytes) {
+            lock_guard<mutex> lock(mtx);
+            if (freeBuffers.size() < maxFree) {
+                freeBuffers.push_back(buffer);
+                return;
+            }
+        }
+        delete buffer;
+    }
+
+public:
+    static RenderedNotificationPool* getInstance() {
+        if (instance == nullptr) {
+            instance = new RenderedNotificationPool();
+        }
+        return instance;
+    }
+
+    NotificationContent render(const INotification& notification) {
+        string* buffer = nullptr;
+        {
+            lock_guard<mutex> lock(mtx);
+            if (!freeBuffers.empty()) {
+                buffer = freeBuffers.back();
+                freeBuffers.pop_back();
+            }
+        }
+        if (buffer == nullptr) {
+            buffer = new string();
+        }
+        buffer->clear();
+        notification.renderTo(*buffer);
+        return NotificationContent(buffer, [this](const string* done) { release(const_cast<string*>(done)); });
+    }
+};
+
+RenderedNotificationPool* RenderedNotificationPool::instance = nullptr;
+
+// History of sent notifications, kept in a fixed byte arena used as a ring.
+// Each entry is stored contiguously; appending evicts the oldest entries
+// until the new one fits, and at most maxEntries are kept. Memory never
+// grows past the arena and the entry table.
+class NotificationStore {
+private:
+    struct Entry {
+        uint64_t id;
+        size_t offset;
+        size_t length;
+    };
+
+    vector<char> arena;
+    vector<Entry> entries;      // ring of up to maxEntries
+    size_t oldest;
+    size_t count;
+    size_t writePos;
+    uint64_t nextId;
+    long long evicted;
+    long long rejected;
+
+    void evictOldest() {
+        oldest = (oldest + 1) % entries.size();
+        count--;
+        evicted++;
+    }
+
+public:
+    NotificationStore(size_t arenaBytes, size_t maxEntries) : arena(arenaBytes), entries(maxEntries) {
+        oldest = count = writePos = 0;
+        nextId = 1;
+        evicted = rejected = 0;
+    }
+
+    // Returns the new entry's id, or 0 if it is larger than the whole arena
+    uint64_t append(const string& content) {
+        size_t length = content.size();
+        if (length > arena.size()) {
+            rejected++;
+            return 0;
+        }
+        bool wrap = writePos + length > arena.size();
+        size_t pos = wrap ? 0 : writePos;
+        while (count > 0) {
+            const Entry& old = entries[oldest];
+            // When wrapping, everything between writePos and the end is older
+            bool inSkippedTail = wrap && old.offset >= writePos;
+            bool overlaps = old.offset < pos + length && pos < old.offset + old.length;
+            if (!inSkippedTail && !overlaps && count < entries.size()) {
+                break;
+            }
+            evictOldest();
+        }
+        content.copy(arena.data() + pos, length);
+        Entry& entry = entries[(oldest + count) % entries.size()];
+        entry.id = nextId++;
+        entry.offset = pos;
+        entry.length = length;
+        count++;
+        writePos = pos + length;
+        return entry.id;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    size_t capacityBytes() const {
+        return arena.size() + entries.size() * sizeof(Entry);
+    }
+
+    long long getEvicted() const {
+        return evicted;
+    }
+
+    // Visits up to n of the most recent notifications, newest first
+    void forEachRecent(size_t n, const function<void(uint64_t, const char*, size_t)>& visit) const {
+        for (size_t i = 0; i < n && i < count; i++) {
+            const Entry& entry = entries[(oldest + count - 1 - i) % entries.size()];
+            visit(entry.id, arena.data() + entry.offset, entry.length);
+        }
     }
 };
 
@@ -84,50 +262,260 @@ public:
     virtual void notifyObservers() = 0;
 };
 
+// Observers grouped by topic, each group a dense array with swap-remove.
+// A hash map from observer to (group, slot) makes add and remove O(1).
+// Group 0 holds observers of every notification.
+class ObserverIndex {
+private:
+    struct Location {
+        uint32_t group;
+        uint32_t slot;
+    };
+
+    vector<vector<IObserver*>> groups;
+    unordered_map<string, uint32_t> groupOfTopic;
+    unordered_map<IObserver*, Location> where;
+
+public:
+    static const uint32_t ALL_TOPICS = 0;
+    static const uint32_t NO_GROUP = UINT32_MAX;
+
+    ObserverIndex() : groups(1) {}
+
+    // One registration per observer; adding again moves it to topic
+    void add(IObserver* observer, const string& topic) {
+        uint32_t group = ALL_TOPICS;
+        if (!topic.empty()) {
+            auto it = groupOfTopic.find(topic);
+            if (it == groupOfTopic.end()) {
+                it = groupOfTopic.emplace(topic, (uint32_t)groups.size()).first;
+                groups.emplace_back();
+            }
+            group = it->second;
+        }
+        auto found = where.find(observer);
+        if (found != where.end()) {
+            if (found->second.group == group) {
+                return;
+            }
+            remove(observer);
+        }
+        where[observer] = {group, (uint32_t)groups[group].size()};
+        groups[group].push_back(observer);
+    }
+
+    void remove(IObserver* observer) {
+        auto found = where.find(observer);
+        if (found == where.end()) {
+            return;
+        }
+        vector<IObserver*>& members = groups[found->second.group];
+        uint32_t slot = found->second.slot;
+        IObserver* last = members.back();
+        members[slot] = last;
+        where[last].slot = slot;
+        members.pop_back();
+        where.erase(observer);
+    }
+
+    uint32_t findGroup(const string& topic) const {
+        auto it = groupOfTopic.find(topic);
+        return it == groupOfTopic.end() ? NO_GROUP : it->second;
+    }
+
+    const vector<IObserver*>& members(uint32_t group) const {
+        return groups[group];
+    }
+
+    size_t size() const {
+        return where.size();
+    }
+};
+
+// Threads for sharded delivery, started once and parked between publishes.
+// run() wakes them, delivers shard 0 on the calling thread and returns once
+// every shard is done. Worker k only ever delivers shard k.
+class DeliveryPool {
+private:
+    vector<thread> workers;
+    mutex mtx;
+    condition_variable wake;
+    condition_variable finished;
+    const vector<IObserver*>* group;
+    size_t shards;
+    size_t running;             // shards still being delivered by workers
+    uint64_t generation;        // bumped once per run()
+    bool stopping;
+
+    static void deliverShard(const vector<IObserver*>& group, size_t shard, size_t shards) {
+        size_t last = group.size() * (shard + 1) / shards;
+        for (size_t i = group.size() * shard / shards; i < last; i++) {
+            group[i]->update();
+        }
+    }
+
+    void workerLoop(size_t shard) {
+        uint64_t seen = 0;
+        unique_lock<mutex> lock(mtx);
+        while (true) {
+            wake.wait(lock, [this, seen]() { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+            if (shard >= shards) {
+                continue;       // this publish needs fewer shards
+            }
+            const vector<IObserver*>& work = *group;
+            size_t count = shards;
+            lock.unlock();
+            deliverShard(work, shard, count);
+            lock.lock();
+            if (--running == 0) {
+                finished.notify_one();
+            }
+        }
+    }
+
+    void stop() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+        stopping = false;
+    }
+
+public:
+    DeliveryPool() {
+        group = nullptr;
+        shards = 0;
+        running = 0;
+        generation = 0;
+        stopping = false;
+    }
+
+    ~DeliveryPool() {
+        stop();
+    }
+
+    // Total threads including the caller of run()
+    void resize(int threads) {
+        stop();
+        for (int shard = 1; shard < threads; shard++) {
+            workers.emplace_back(&DeliveryPool::workerLoop, this, (size_t)shard);
+        }
+    }
+
+    size_t size() {
+        return workers.size() + 1;
+    }
+
+    // shards must not exceed size()
+    void run(const vector<IObserver*>& members, size_t count) {
+        {
+            lock_guard<mutex> lock(mtx);
+            group = &members;
+            shards = count;
+            running = count - 1;
+            generation++;
+        }
+        wake.notify_all();
+        deliverShard(members, 0, count);
+        unique_lock<mutex> lock(mtx);
+        finished.wait(lock, [this]() { return running == 0; });
+    }
+};
+
 // Concrete Observable
 class NotificationObservable :  public IObservable {
 private:
-    vector<IObserver*> observers;
-    INotification* currentNotification;
+    ObserverIndex observers;
+    NotificationContent currentContent;
+    string currentTopic;
+    DeliveryPool pool;
+
+    static const size_t MIN_SHARD = 16384;
+
+    // Large groups are split into shards delivered by the pool's threads
+    void deliver(const vector<IObserver*>& group) {
+        size_t shards = min(pool.size(), group.size() / MIN_SHARD);
+        if (shards <= 1) {
+            for (unsigned int i = 0; i < group.size(); i++) {
+                group[i]->update();
+            }
+            return;
+        }
+        pool.run(group, shards);
+    }
+
 public:
     NotificationObservable() { 
-        currentNotification = nullptr; 
     }
 
     void addObserver(IObserver* obs) override {
-        observers.push_back(obs);
+        observers.add(obs, "");
+    }
+
+    // Only notified of notifications sent with this topic
+    void addObserver(IObserver* obs, const string& topic) {
+        observers.add(obs, topic);
     }
 
     void removeObserver(IObserver* obs) override {
-        observers.erase(remove(observers.begin(), observers.end(), obs), observers.end());
+        observers.remove(obs);
     }
 
+    // Observers of every notification, plus those of the current topic
     void notifyObservers() override {
-        for (unsigned int i = 0; i < observers.size(); i++) {
-            observers[i]->update();
+        deliver(observers.members(ObserverIndex::ALL_TOPICS));
+        if (!currentTopic.empty()) {
+            uint32_t group = observers.findGroup(currentTopic);
+            if (group != ObserverIndex::NO_GROUP) {
+                deliver(observers.members(group));
+            }
         }
     }
 
-    void setNotification(INotification* notification) {
-        if (currentNotification != nullptr) {
-            delete currentNotification;
-        }
-        currentNotification = notification;
+    // With more than one thread, large fan-outs call update() concurrently;
+    // observers must then be safe for that. The extra threads are started
+    // here and kept until the next call. Not safe during a notification.
+    void setDeliveryThreads(int threads) {
+        pool.resize(max(1, threads));
+    }
+
+    size_t getObserverCount() {
+        return observers.size();
+    }
+
+    // Renders the notification once and drops its decorator chain
+    void setNotification(INotification* notification, const string& topic = "") {
+        NotificationContent content = RenderedNotificationPool::getInstance()->render(*notification);
+        delete notification;
+        setContent(content, topic);
+    }
+
+    void setContent(const NotificationContent& content, const string& topic = "") {
+        currentContent = content;
+        currentTopic = topic;
         notifyObservers();
     }
 
-    INotification* getNotification() {
-        return currentNotification;
+    const string& getNotificationTopic() {
+        return currentTopic;
     }
 
-    string getNotificationContent() {
-        return currentNotification->getContent();
+    const string& getNotificationContent() {
+        return *currentContent;
     }
 
-    ~NotificationObservable() {
-        if (currentNotification != NULL) {
-            delete currentNotification;
-        }
+    // For observers that keep the content past update()
+    NotificationContent getSharedContent() {
+        return currentContent;
     }
 };
 
@@ -143,9 +531,10 @@ class NotificationService {
 private:
     NotificationObservable* observable;
     static NotificationService* instance;
-    vector<INotification*> notifications;
+    // Bounded history: 1 MB of rendered text, at most 10k notifications
+    NotificationStore notifications;
 
-    NotificationService() {
+    NotificationService() : notifications(1 << 20, 10000) {
         // private constructor
         observable = new NotificationObservable();
     }
@@ -163,10 +552,16 @@ public:
         return observable;
     }
 
-    // Creates a new Notification and notifies observers.
-    void sendNotification(INotification* notification) {
-        notifications.push_back(notification);
-        observable->setNotification(notification);
+    // Renders the notification once, records it and notifies observers.
+    void sendNotification(INotification* notification, const string& topic = "") {
+        NotificationContent content = RenderedNotificationPool::getInstance()->render(*notification);
+        delete notification;
+        notifications.append(*content);
+        observable->setContent(content, topic);
+    }
+
+    const NotificationStore& getHistory() {
+        return notifications;
     }
 
     ~NotificationService() {
@@ -203,10 +598,47 @@ public:
   Strategy Pattern Components (Concrete Observer 2)
 =============================*/
 
+// How a channel is driven when the engine dispatches asynchronously.
+struct ChannelConfig {
+    int workers;
+    size_t queueCapacity;
+    size_t maxBatch;
+    double ratePerSecond;   // 0 = unlimited
+
+    ChannelConfig(int workers = 1, size_t queueCapacity = 1024, size_t maxBatch = 1, double ratePerSecond = 0) {
+        this->workers = workers;
+        this->queueCapacity = queueCapacity;
+        this->maxBatch = maxBatch;
+        this->ratePerSecond = ratePerSecond;
+    }
+};
+
 // Abstract class for different Notification Strategies.
 class INotificationStrategy {
 public:    
     virtual void sendNotification(string content) = 0;
+
+    // Channels that can deliver several messages at once override this
+    virtual void sendBatch(const vector<NotificationContent>& batch) {
+        for (const NotificationContent& content : batch) {
+            sendNotification(*content);
+        }
+    }
+
+    // Used by the outbox: false means the provider did not take the
+    // message and it should be retried later.
+    virtual bool trySend(const string& content) {
+        sendNotification(content);
+        return true;
+    }
+
+    virtual ChannelConfig getChannelConfig() {
+        return ChannelConfig();
+    }
+
+    virtual string getChannelName() = 0;
+
+    virtual ~INotificationStrategy() {}
 };
 
 class EmailStrategy : public INotificationStrategy {
@@ -223,6 +655,24 @@ public:
         // representing the dispatch of messages to users via email.​
         cout << "Sending email Notification to: " << emailId << "\n" << content;
     }
+
+    // One SMTP session for the whole batch
+    void sendBatch(const vector<NotificationContent>& batch) override {
+        if (batch.size() > 1) {
+            cout << "Opening SMTP session for " << batch.size() << " emails\n";
+        }
+        for (const NotificationContent& content : batch) {
+            sendNotification(*content);
+        }
+    }
+
+    ChannelConfig getChannelConfig() override {
+        return ChannelConfig(1, 4096, 50);
+    }
+
+    string getChannelName() override {
+        return "Email";
+    }
 };
 
 class SMSStrategy : public INotificationStrategy {
@@ -239,6 +689,15 @@ public:
         // representing the dispatch of messages to users via SMS.​
         cout << "Sending SMS Notification to: " << mobileNumber << "\n" << content;
     }
+
+    // SMS providers throttle per account
+    ChannelConfig getChannelConfig() override {
+        return ChannelConfig(4, 4096, 1, 100);
+    }
+
+    string getChannelName() override {
+        return "SMS";
+    }
 };
 
 class PopUpStrategy : public INotificationStrategy {
@@ -247,38 +706,1339 @@ public:
         // Simulate the process of sending popup notification.
         cout << "Sending Popup Notification: \n" << content;
     }
+
+    string getChannelName() override {
+        return "Popup";
+    }
+};
+
+/*============================
+    Asynchronous Dispatch Engine
+=============================*/
+
+// Each channel (strategy) gets its own bounded queue and worker pool, so a
+// slow SMS provider no longer holds up email or popups, and the observer
+// only enqueues. Workers drain up to maxBatch messages at a time and hand
+// them to the channel in one sendBatch call (e.g. one SMTP session), after
+// taking tokens from the channel's rate limiter.
+
+// Token bucket; blocks the caller until enough tokens have accumulated.
+class RateLimiter {
+private:
+    double ratePerSecond;
+    double burst;
+    double tokens;
+    chrono::steady_clock::time_point last;
+    mutex mtx;
+public:
+    RateLimiter(double ratePerSecond, double burst) {
+        this->ratePerSecond = ratePerSecond;
+        this->burst = burst;
+        tokens = burst;
+        last = chrono::steady_clock::now();
+    }
+
+    void acquire(int count) {
+        if (ratePerSecond <= 0) {
+            return;
+        }
+        while (true) {
+            double missing;
+            {
+                lock_guard<mutex> lock(mtx);
+                chrono::steady_clock::time_point now = chrono::steady_clock::now();
+                tokens = min(burst, tokens + chrono::duration<double>(now - last).count() * ratePerSecond);
+                last = now;
+                if (tokens >= count) {
+                    tokens -= count;
+                    return;
+                }
+                missing = count - tokens;
+            }
+            this_thread::sleep_for(chrono::duration<double>(missing / ratePerSecond));
+        }
+    }
+};
+
+class ChannelPipeline {
+private:
+    INotificationStrategy* strategy;
+    ChannelConfig config;
+    RateLimiter limiter;
+    deque<NotificationContent> queue;
+    int busyWorkers;
+    bool stopping;
+    mutex mtx;
+    condition_variable notEmpty;
+    condition_variable notFull;
+    condition_variable idle;
+    vector<thread> workers;
+    atomic<long long> delivered;
+    atomic<long long> batches;
+    atomic<long long> producerWaits;
+
+    void workerLoop() {
+        vector<NotificationContent> batch;
+        while (true) {
+            {
+                unique_lock<mutex> lock(mtx);
+                notEmpty.wait(lock, [this]() { return stopping || !queue.empty(); });
+                if (queue.empty()) {
+                    return;
+                }
+                while (!queue.empty() && batch.size() < config.maxBatch) {
+                    batch.push_back(move(queue.front()));
+                    queue.pop_front();
+                }
+                busyWorkers++;
+            }
+            notFull.notify_all();
+
+            limiter.acquire((int)batch.size());
+            strategy->sendBatch(batch);
+            delivered += batch.size();
+            batches++;
+            batch.clear();
+
+            lock_guard<mutex> lock(mtx);
+            busyWorkers--;
+            if (queue.empty() && busyWorkers == 0) {
+                idle.notify_all();
+            }
+        }
+    }
+
+public:
+    ChannelPipeline(INotificationStrategy* strategy, const ChannelConfig& config)
+        : limiter(config.ratePerSecond, max((double)config.maxBatch, config.ratePerSecond / 10)) {
+        this->strategy = strategy;
+        this->config = config;
+        busyWorkers = 0;
+        stopping = false;
+        delivered = batches = producerWaits = 0;
+        for (int i = 0; i < config.workers; i++) {
+            workers.emplace_back(&ChannelPipeline::workerLoop, this);
+        }
+    }
+
+    // Delivers everything already queued, then stops the workers
+    ~ChannelPipeline() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        notEmpty.notify_all();
+        for (thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Blocks while the queue is full (backpressure on the producer)
+    void submit(const NotificationContent& content) {
+        {
+            unique_lock<mutex> lock(mtx);
+            if (queue.size() >= config.queueCapacity) {
+                producerWaits++;
+                notFull.wait(lock, [this]() { return queue.size() < config.queueCapacity; });
+            }
+            queue.push_back(content);
+        }
+        notEmpty.notify_one();
+    }
+
+    void waitIdle() {
+        unique_lock<mutex> lock(mtx);
+        idle.wait(lock, [this]() { return queue.empty() && busyWorkers == 0; });
+    }
+
+    void printStats(ostream& out) {
+        long long sent = delivered;
+        long long sessions = batches;
+        out << "  [" << strategy->getChannelName() << "] workers=" << config.workers << " delivered=" << sent
+            << " batches=" << sessions << " (avg " << (sessions ? (double)sent / sessions : 0.0) << ")"
+            << " producer-waits=" << producerWaits << "\n";
+    }
+};
+
+class NotificationDispatcher {
+private:
+    vector<ChannelPipeline*> channels;
+public:
+    ~NotificationDispatcher() {
+        for (ChannelPipeline* channel : channels) {
+            delete channel;
+        }
+    }
+
+    void addChannel(INotificationStrategy* strategy, const ChannelConfig& config) {
+        channels.push_back(new ChannelPipeline(strategy, config));
+    }
+
+    // Every channel queue shares the same rendered content
+    void dispatch(const NotificationContent& content) {
+        for (ChannelPipeline* channel : channels) {
+            channel->submit(content);
+        }
+    }
+
+    void waitIdle() {
+        for (ChannelPipeline* channel : channels) {
+            channel->waitIdle();
+        }
+    }
+
+    void printStats(ostream& out) {
+        for (ChannelPipeline* channel : channels) {
+            channel->printStats(out);
+        }
+    }
 };
 
 class NotificationEngine : public IObserver {
 private:
     NotificationObservable* notificationObservable;
     vector<INotificationStrategy*> notificationStrategies;
+    NotificationDispatcher* dispatcher;   // null: strategies run inline in update()
 
 public:
     NotificationEngine() {
         this->notificationObservable = NotificationService::getInstance()->getObservable();
         notificationObservable->addObserver(this);
+        dispatcher = nullptr;
     }
 
     NotificationEngine(NotificationObservable* observable) {
         this->notificationObservable = observable;
+        notificationObservable->addObserver(this);
+        dispatcher = nullptr;
+    }
+
+    ~NotificationEngine() {
+        notificationObservable->removeObserver(this);
+        delete dispatcher;
     }
 
     void addNotificationStrategy(INotificationStrategy* ns) {
         this->notificationStrategies.push_back(ns);
+        if (dispatcher) {
+            dispatcher->addChannel(ns, ns->getChannelConfig());
+        }
     }
 
     // Can have RemoveNotificationStrategy as well.
 
+    // From now on update() only enqueues; each strategy is driven by its
+    // own worker pool as described by its ChannelConfig.
+    void enableAsyncDispatch() {
+        if (dispatcher) {
+            return;
+        }
+        dispatcher = new NotificationDispatcher();
+        for (INotificationStrategy* strategy : notificationStrategies) {
+            dispatcher->addChannel(strategy, strategy->getChannelConfig());
+        }
+    }
+
+    // Block until every queued notification has been delivered
+    void waitForDelivery() {
+        if (dispatcher) {
+            dispatcher->waitIdle();
+        }
+    }
+
+    NotificationDispatcher* getDispatcher() {
+        return dispatcher;
+    }
+
     void update() {
-        string notificationContent = notificationObservable->getNotificationContent();
+        if (dispatcher) {
+            dispatcher->dispatch(notificationObservable->getSharedContent());
+            return;
+        }
+        const string& notificationContent = notificationObservable->getNotificationContent();
         for(const auto notificationStrategy : notificationStrategies) {
             notificationStrategy->sendNotification(notificationContent);
         }
     }
 };
 
-int main() {
+/*============================
+    Durable Outbox
+=============================*/
+
+// Hierarchical timer wheel: four levels of 256 slots. A timer due within
+// 256 ticks sits in level 0, within 65536 ticks in level 1 and so on; each
+// time a level wraps, the next slot of the level above is cascaded down.
+// Scheduling and cancelling are O(1) list operations and a tick only looks
+// at one slot, so ticking costs the same with ten timers or ten million.
+// Timers are identified by small integer ids chosen by the caller.
+class TimerWheel {
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 8;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const uint32_t NONE = 0xFFFFFFFFu;
+
+    struct Node {
+        uint32_t next;
+        uint32_t prev;
+        uint32_t bucket;   // level * SLOTS + slot, NONE when not scheduled
+        uint64_t dueTick;
+    };
+
+    vector<Node> nodes;
+    uint32_t heads[LEVELS * SLOTS];
+    uint64_t currentTick;
+    size_t pending;
+
+    void link(uint32_t id) {
+        Node& node = nodes[id];
+        uint64_t delta = node.dueTick - currentTick;
+        int level = 0;
+        while (level < LEVELS - 1 && delta >= (1ull << (SLOT_BITS * (level + 1)))) {
+            level++;
+        }
+        node.bucket = level * SLOTS + ((node.dueTick >> (SLOT_BITS * level)) & (SLOTS - 1));
+        node.prev = NONE;
+        node.next = heads[node.bucket];
+        if (node.next != NONE) {
+            nodes[node.next].prev = id;
+        }
+        heads[node.bucket] = id;
+    }
+
+    void unlink(uint32_t id) {
+        Node& node = nodes[id];
+        if (node.prev != NONE) {
+            nodes[node.prev].next = node.next;
+        } else {
+            heads[node.bucket] = node.next;
+        }
+        if (node.next != NONE) {
+            nodes[node.next].prev = node.prev;
+        }
+        node.bucket = NONE;
+    }
+
+    // Re-files every timer of one upper-level slot into the levels below
+    void cascade(int level) {
+        uint32_t bucket = level * SLOTS + ((currentTick >> (SLOT_BITS * level)) & (SLOTS - 1));
+        uint32_t id = heads[bucket];
+        heads[bucket] = NONE;
+        while (id != NONE) {
+            uint32_t next = nodes[id].next;
+            link(id);
+            id = next;
+        }
+    }
+
+public:
+    static const uint64_t MAX_DELAY_TICKS = (1ull << (SLOT_BITS * LEVELS)) - 1;
+
+    TimerWheel(uint64_t startTick = 0) {
+        currentTick = startTick;
+        pending = 0;
+        fill(heads, heads + LEVELS * SLOTS, NONE);
+    }
+
+    // Due ticks in the past fire on the next tick
+    void schedule(uint32_t id, uint64_t dueTick) {
+        if (id >= nodes.size()) {
+            nodes.resize(id + 1, Node{NONE, NONE, NONE, 0});
+        }
+        if (nodes[id].bucket != NONE) {
+            unlink(id);
+        } else {
+            pending++;
+        }
+        nodes[id].dueTick = min(max(dueTick, currentTick + 1), currentTick + MAX_DELAY_TICKS);
+        link(id);
+    }
+
+    void cancel(uint32_t id) {
+        if (id < nodes.size() && nodes[id].bucket != NONE) {
+            unlink(id);
+            pending--;
+        }
+    }
+
+    // Moves the wheel forward to tick, appending the ids that came due
+    void advance(uint64_t tick, vector<uint32_t>& expired) {
+        if (pending == 0) {
+            currentTick = max(currentTick, tick);
+            return;
+        }
+        while (currentTick < tick) {
+            currentTick++;
+            if ((currentTick & (SLOTS - 1)) == 0) {
+                int level = 1;
+                while (level < LEVELS - 1 && ((currentTick >> (SLOT_BITS * level)) & (SLOTS - 1)) == 0) {
+                    level++;
+                }
+                for (; level >= 1; level--) {
+                    cascade(level);
+                }
+            }
+            uint32_t bucket = currentTick & (SLOTS - 1);
+            uint32_t id = heads[bucket];
+            heads[bucket] = NONE;
+            while (id != NONE) {
+                nodes[id].bucket = NONE;
+                expired.push_back(id);
+                pending--;
+                id = nodes[id].next;
+            }
+        }
+    }
+
+    uint64_t getCurrentTick() {
+        return currentTick;
+    }
+
+    size_t getPending() {
+        return pending;
+    }
+};
+
+// Retry state of one undelivered message. The content itself stays in the
+// segment file and is read back only when the message is attempted.
+struct OutboxEntry {
+    uint64_t id;
+    uint64_t offset;    // of the content within its segment
+    uint32_t segment;
+    uint32_t length;
+    uint16_t attempts;
+    uint8_t channel;
+    bool live;
+};
+
+// Durable outbox in front of channels that talk to external providers
+// (email, SMS). A message is appended to the current segment file before it
+// is attempted, and every outcome (retry scheduled, delivered, given up) is
+// appended as another record, so the segments are the whole retry state.
+// Failed sends are retried with exponential backoff on a TimerWheel.
+// open() replays the segments and schedules only the messages that have no
+// delivered/dead record. Segments are deleted oldest first once every
+// message in them is settled.
+//
+// Records are made durable by flush(), which poll() calls on every tick, so
+// a crash loses at most the last tick of enqueues. Delivery is
+// at-least-once: a crash between a send and its record reaching disk sends
+// that message again after restart.
+//
+// I/O errors are never papered over: records that could not be written stay
+// buffered and are retried on the next flush, which reports false until they
+// are on disk. If no segment could be created, enqueue() refuses messages.
+class NotificationOutbox {
+private:
+    enum RecordType : uint8_t { ENQUEUED = 1, RETRY = 2, DELIVERED = 3, DEAD = 4 };
+
+    // checksum(4) type(1) channel(1) attempts(2) length(4) id(8) dueMs(8)
+    static const size_t HEADER_BYTES = 28;
+
+    struct Segment {
+        int fd;
+        size_t live;
+    };
+
+    string directory;
+    uint64_t (*clock)();
+    size_t segmentBytes;
+    int maxAttempts;
+    uint64_t baseBackoffMs;
+    uint64_t maxBackoffMs;
+
+    mutex mtx;
+    vector<INotificationStrategy*> channels;
+    vector<OutboxEntry> entries;
+    vector<uint32_t> freeSlots;
+    TimerWheel wheel;
+    map<uint32_t, Segment> segments;
+    uint32_t currentSegment;
+    uint64_t currentSize;       // bytes in the segment including the buffer
+    uint64_t syncedSize;
+    bool writable;              // the current segment is open for appends
+    string writeBuffer;
+    uint64_t nextId;
+    uint64_t randomState;
+    size_t live;
+
+    long long delivered;
+    long long retried;
+    long long deadLettered;
+    long long ioErrors;
+
+    thread pump;
+    atomic<bool> pumping;
+
+    static uint32_t checksum(const char* data, size_t length) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ (unsigned char)data[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    string segmentPath(uint32_t segment) {
+        char name[32];
+        snprintf(name, sizeof(name), "/segment-%08u.log", segment);
+        return directory + name;
+    }
+
+    // Returns the offset of the payload within the current segment
+    uint64_t appendRecord(RecordType type, const OutboxEntry& entry, uint64_t dueMs, const string* payload) {
+        char header[HEADER_BYTES];
+        uint32_t length = payload ? (uint32_t)payload->size() : 0;
+        header[4] = type;
+        header[5] = entry.channel;
+        memcpy(header + 6, &entry.attempts, 2);
+        memcpy(header + 8, &length, 4);
+        memcpy(header + 12, &entry.id, 8);
+        memcpy(header + 20, &dueMs, 8);
+        uint32_t sum = checksum(header + 4, HEADER_BYTES - 4);
+        if (payload) {
+            sum ^= checksum(payload->data(), length);
+        }
+        memcpy(header, &sum, 4);
+
+        writeBuffer.append(header, HEADER_BYTES);
+        if (payload) {
+            writeBuffer.append(*payload);
+        }
+        uint64_t payloadOffset = currentSize + HEADER_BYTES;
+        currentSize += HEADER_BYTES + length;
+        if (writeBuffer.size() >= (1 << 20)) {
+            writeOut();
+        }
+        return payloadOffset;
+    }
+
+    // Writes as much of the buffer as the file takes; whatever is left after
+    // an error stays buffered for the next attempt.
+    bool writeOut() {
+        if (!writable) {
+            return false;
+        }
+        size_t done = 0;
+        bool ok = true;
+        while (done < writeBuffer.size()) {
+            ssize_t written = write(segments[currentSegment].fd, writeBuffer.data() + done, writeBuffer.size() - done);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                cout << "Outbox: write to " << segmentPath(currentSegment) << " failed: " << strerror(errno) << "\n";
+                ioErrors++;
+                ok = false;
+                break;
+            }
+            done += written;
+        }
+        writeBuffer.erase(0, done);
+        return ok;
+    }
+
+    // Leaves the current segment in place if the new one cannot be created
+    bool startSegment(uint32_t segment) {
+        string path = segmentPath(segment);
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_APPEND, 0644);
+        if (fd < 0) {
+            cout << "Outbox: cannot create " << path << ": " << strerror(errno) << "\n";
+            ioErrors++;
+            return false;
+        }
+        segments[segment] = Segment{fd, 0};
+        currentSegment = segment;
+        currentSize = 0;
+        syncedSize = 0;
+        writable = true;
+        return true;
+    }
+
+    // false: some records are not yet durable; they are retried next time
+    bool syncLocked() {
+        if (segments.empty() || syncedSize == currentSize) {
+            return true;
+        }
+        if (!writeOut()) {
+            return false;
+        }
+        int synced;
+        do {
+            synced = fdatasync(segments[currentSegment].fd);
+        } while (synced != 0 && errno == EINTR);
+        if (synced != 0) {
+            cout << "Outbox: sync of " << segmentPath(currentSegment) << " failed: " << strerror(errno) << "\n";
+            ioErrors++;
+            return false;
+        }
+        syncedSize = currentSize;
+        if (currentSize >= segmentBytes) {
+            startSegment(currentSegment + 1);
+        }
+        return true;
+    }
+
+    // Reads a message's content back from its segment; false on a short read
+    bool readContent(const OutboxEntry& entry, string& content) {
+        content.resize(entry.length);
+        size_t done = 0;
+        while (done < entry.length) {
+            ssize_t got = pread(segments[entry.segment].fd, &content[done], entry.length - done, entry.offset + done);
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got <= 0) {
+                return false;
+            }
+            done += got;
+        }
+        return true;
+    }
+
+    // Deletes settled segments from the front; a later segment may hold the
+    // delivered record of a message in an earlier one, so order matters.
+    void dropSettledSegments() {
+        while (segments.size() > 1 && segments.begin()->second.live == 0) {
+            close(segments.begin()->second.fd);
+            unlink(segmentPath(segments.begin()->first).c_str());
+            segments.erase(segments.begin());
+        }
+    }
+
+    uint32_t allocateSlot() {
+        if (!freeSlots.empty()) {
+            uint32_t slot = freeSlots.back();
+            freeSlots.pop_back();
+            return slot;
+        }
+        entries.push_back(OutboxEntry());
+        return entries.size() - 1;
+    }
+
+    void settle(uint32_t slot) {
+        segments[entries[slot].segment].live--;
+        entries[slot].live = false;
+        freeSlots.push_back(slot);
+        live--;
+    }
+
+    // Exponential backoff with equal jitter: half the delay is fixed, half
+    // random, so a provider outage does not end in a synchronized stampede.
+    uint64_t backoffMs(int attempts) {
+        uint64_t delay = min(maxBackoffMs, baseBackoffMs << min(attempts - 1, 20));
+        randomState ^= randomState << 13;
+        randomState ^= randomState >> 7;
+        randomState ^= randomState << 17;
+        return delay / 2 + randomState % (delay / 2 + 1);
+    }
+
+    static uint64_t tickOf(uint64_t ms) {
+        return ms / TICK_MS;
+    }
+
+    // Reads one segment's records; stops at the first torn or corrupt one.
+    // An unreadable segment is left on disk untouched and reported.
+    bool replaySegment(uint32_t segment, unordered_map<uint64_t, uint32_t>& pendingById, vector<uint64_t>& dueMs) {
+        string path = segmentPath(segment);
+        int fd = ::open(path.c_str(), O_RDONLY);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) != 0) {
+            cout << "Outbox: cannot read " << path << ": " << strerror(errno) << "\n";
+            ioErrors++;
+            if (fd >= 0) {
+                close(fd);
+            }
+            return false;
+        }
+        string data(info.st_size, '\0');
+        size_t done = 0;
+        while (done < data.size()) {
+            ssize_t got = pread(fd, &data[done], data.size() - done, done);
+            if (got < 0 && errno == EINTR) continue;
+            if (got < 0) {
+                cout << "Outbox: read of " << path << " failed at " << done << ": " << strerror(errno) << "\n";
+                ioErrors++;
+            }
+            if (got <= 0) break;
+            done += got;
+        }
+        segments[segment] = Segment{fd, 0};
+
+        size_t position = 0;
+        while (position + HEADER_BYTES <= done) {
+            const char* header = data.data() + position;
+            OutboxEntry entry;
+            uint32_t sum, length;
+            uint64_t due;
+            memcpy(&sum, header, 4);
+            RecordType type = (RecordType)header[4];
+            entry.channel = header[5];
+            memcpy(&entry.attempts, header + 6, 2);
+            memcpy(&length, header + 8, 4);
+            memcpy(&entry.id, header + 12, 8);
+            memcpy(&due, header + 20, 8);
+            if (position + HEADER_BYTES + length > done
+                || sum != (checksum(header + 4, HEADER_BYTES - 4) ^ (length ? checksum(header + HEADER_BYTES, length) : 0))) {
+                cout << "Outbox: ignoring torn record at " << segmentPath(segment) << ":" << position << "\n";
+                break;
+            }
+            nextId = max(nextId, entry.id + 1);
+
+            if (type == ENQUEUED) {
+                uint32_t slot = allocateSlot();
+                entry.segment = segment;
+                entry.offset = position + HEADER_BYTES;
+                entry.length = length;
+                entry.attempts = 0;
+                entry.live = true;
+                entries[slot] = entry;
+                if (dueMs.size() <= slot) {
+                    dueMs.resize(slot + 1);
+                }
+                dueMs[slot] = 0;
+                pendingById[entry.id] = slot;
+                segments[segment].live++;
+                live++;
+            } else {
+                auto found = pendingById.find(entry.id);
+                if (found == pendingById.end()) {
+                    // Its segment was already settled and deleted
+                } else if (type == RETRY) {
+                    entries[found->second].attempts = entry.attempts;
+                    dueMs[found->second] = due;
+                } else {
+                    settle(found->second);
+                    pendingById.erase(found);
+                }
+            }
+            position += HEADER_BYTES + length;
+        }
+        return true;
+    }
+
+public:
+    static const uint64_t TICK_MS = 10;
+
+    static uint64_t wallClockMs() {
+        return chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    NotificationOutbox(const string& directory, uint64_t (*clock)() = wallClockMs, size_t segmentBytes = 64 << 20)
+        : wheel(tickOf(clock())) {
+        this->directory = directory;
+        this->clock = clock;
+        this->segmentBytes = segmentBytes;
+        maxAttempts = 10;
+        baseBackoffMs = 1000;
+        maxBackoffMs = 10 * 60 * 1000;
+        currentSegment = 0;
+        currentSize = 0;
+        syncedSize = 0;
+        writable = false;
+        nextId = 1;
+        randomState = 0x9E3779B97F4A7C15ull ^ clock();
+        live = 0;
+        delivered = retried = deadLettered = 0;
+        ioErrors = 0;
+        pumping = false;
+    }
+
+    ~NotificationOutbox() {
+        stopPump();
+        lock_guard<mutex> lock(mtx);
+        syncLocked();
+        for (auto& segment : segments) {
+            close(segment.second.fd);
+        }
+    }
+
+    // Channels must be added in the same order on every start, before
+    // open(), because records refer to them by index.
+    int addChannel(INotificationStrategy* channel) {
+        lock_guard<mutex> lock(mtx);
+        channels.push_back(channel);
+        return channels.size() - 1;
+    }
+
+    // Replays existing segments and returns how many messages are still
+    // undelivered; those are scheduled for their recorded retry time.
+    // Check isWritable() afterwards: without a segment nothing is accepted.
+    size_t open() {
+        lock_guard<mutex> lock(mtx);
+        mkdir(directory.c_str(), 0755);
+        vector<uint32_t> found;
+        if (DIR* dir = opendir(directory.c_str())) {
+            while (dirent* item = readdir(dir)) {
+                unsigned segment;
+                if (sscanf(item->d_name, "segment-%8u.log", &segment) == 1) {
+                    found.push_back(segment);
+                }
+            }
+            closedir(dir);
+        }
+        sort(found.begin(), found.end());
+
+        unordered_map<uint64_t, uint32_t> pendingById;
+        vector<uint64_t> dueMs;
+        for (uint32_t segment : found) {
+            replaySegment(segment, pendingById, dueMs);
+        }
+        for (auto& pending : pendingById) {
+            wheel.schedule(pending.second, tickOf(dueMs[pending.second]));
+        }
+        // New records always go to a fresh segment, never after a torn tail
+        startSegment(found.empty() ? 0 : found.back() + 1);
+        dropSettledSegments();
+        return pendingById.size();
+    }
+
+    // Records the message and schedules its first attempt for the next tick.
+    // Returns 0 (never a message id) if there is no segment to record it in.
+    uint64_t enqueue(int channel, const string& content) {
+        lock_guard<mutex> lock(mtx);
+        if (!writable) {
+            return 0;
+        }
+        uint32_t slot = allocateSlot();
+        OutboxEntry& entry = entries[slot];
+        entry.id = nextId++;
+        entry.segment = currentSegment;
+        entry.length = content.size();
+        entry.attempts = 0;
+        entry.channel = channel;
+        entry.live = true;
+        entry.offset = appendRecord(ENQUEUED, entry, 0, &content);
+        segments[currentSegment].live++;
+        live++;
+        wheel.schedule(slot, tickOf(clock()));
+        return entry.id;
+    }
+
+    // Makes every record appended so far durable; false if some could not be
+    bool flush() {
+        lock_guard<mutex> lock(mtx);
+        return syncLocked();
+    }
+
+    // Attempts every message whose retry time has come and records the
+    // outcomes. Providers are called without holding the outbox lock. A
+    // message whose content cannot be read back is not attempted; it is
+    // rescheduled without using up an attempt.
+    size_t poll() {
+        vector<uint32_t> due;
+        vector<string> contents;
+        vector<INotificationStrategy*> targets;
+        vector<char> readable;
+        {
+            lock_guard<mutex> lock(mtx);
+            syncLocked();
+            wheel.advance(tickOf(clock()), due);
+            contents.resize(due.size());
+            targets.resize(due.size());
+            readable.resize(due.size());
+            for (size_t i = 0; i < due.size(); i++) {
+                const OutboxEntry& entry = entries[due[i]];
+                readable[i] = readContent(entry, contents[i]);
+                if (!readable[i]) {
+                    cout << "Outbox: cannot read message " << entry.id << " from " << segmentPath(entry.segment) << "\n";
+                    ioErrors++;
+                }
+                targets[i] = entry.channel < channels.size() ? channels[entry.channel] : nullptr;
+            }
+        }
+
+        vector<char> sent(due.size());
+        for (size_t i = 0; i < due.size(); i++) {
+            sent[i] = readable[i] && targets[i] && targets[i]->trySend(contents[i]);
+        }
+
+        lock_guard<mutex> lock(mtx);
+        uint64_t now = clock();
+        for (size_t i = 0; i < due.size(); i++) {
+            uint32_t slot = due[i];
+            OutboxEntry& entry = entries[slot];
+            if (!readable[i]) {
+                wheel.schedule(slot, tickOf(now + backoffMs(max<int>(entry.attempts, 1))));
+            } else if (sent[i]) {
+                appendRecord(DELIVERED, entry, 0, nullptr);
+                settle(slot);
+                delivered++;
+            } else if (++entry.attempts >= maxAttempts) {
+                appendRecord(DEAD, entry, 0, nullptr);
+                settle(slot);
+                deadLettered++;
+            } else {
+                uint64_t retryAt = now + backoffMs(entry.attempts);
+                appendRecord(RETRY, entry, retryAt, nullptr);
+                wheel.schedule(slot, tickOf(retryAt));
+                retried++;
+            }
+        }
+        syncLocked();
+        dropSettledSegments();
+        return due.size();
+    }
+
+    // Background thread calling poll() once per tick
+    void startPump() {
+        if (pumping.exchange(true)) {
+            return;
+        }
+        pump = thread([this]() {
+            while (pumping) {
+                poll();
+                this_thread::sleep_for(chrono::milliseconds(TICK_MS));
+            }
+        });
+    }
+
+    void stopPump() {
+        if (pumping.exchange(false)) {
+            pump.join();
+        }
+    }
+
+    size_t getPending() {
+        lock_guard<mutex> lock(mtx);
+        return live;
+    }
+
+    bool isWritable() {
+        lock_guard<mutex> lock(mtx);
+        return writable;
+    }
+
+    size_t getSegmentCount() {
+        lock_guard<mutex> lock(mtx);
+        return segments.size();
+    }
+
+    void printStats(ostream& out) {
+        lock_guard<mutex> lock(mtx);
+        out << "Outbox: " << live << " pending, " << delivered << " delivered, " << retried << " retries scheduled, "
+            << deadLettered << " dead-lettered, " << segments.size() << " segment(s), " << ioErrors << " I/O error(s)\n";
+    }
+};
+
+// Strategy handed to the NotificationEngine in place of the real channel:
+// sending only records the message in the outbox, which delivers it.
+class OutboxChannel : public INotificationStrategy {
+private:
+    NotificationOutbox* outbox;
+    int channel;
+    string name;
+public:
+    OutboxChannel(NotificationOutbox* outbox, int channel, const string& name) {
+        this->outbox = outbox;
+        this->channel = channel;
+        this->name = name;
+    }
+
+    void sendNotification(string content) override {
+        if (outbox->enqueue(channel, content) == 0) {
+            cout << "Outbox: " << name << " message dropped, outbox is not writable\n";
+        }
+    }
+
+    string getChannelName() override {
+        return name;
+    }
+};
+
+/*============================
+  Benchmark: local stub channels
+=============================*/
+
+// Stand-in for a provider: a fixed cost per session (one per batch) plus a
+// cost per message, simulated with sleeps.
+class StubChannel : public INotificationStrategy {
+private:
+    string name;
+    int sessionMicros;
+    int perMessageMicros;
+    ChannelConfig config;
+    atomic<long long> delivered;
+
+public:
+    StubChannel(const string& name, int sessionMicros, int perMessageMicros, const ChannelConfig& config) {
+        this->name = name;
+        this->sessionMicros = sessionMicros;
+        this->perMessageMicros = perMessageMicros;
+        this->config = config;
+        delivered = 0;
+    }
+
+    void sendNotification(string content) override {
+        sendBatch({make_shared<const string>(content)});
+    }
+
+    void sendBatch(const vector<NotificationContent>& batch) override {
+        this_thread::sleep_for(chrono::microseconds(sessionMicros + perMessageMicros * (int)batch.size()));
+        delivered += batch.size();
+    }
+
+    ChannelConfig getChannelConfig() override {
+        return config;
+    }
+
+    string getChannelName() override {
+        return name;
+    }
+
+    long long getDelivered() {
+        return delivered;
+    }
+};
+
+// Sends count notifications through the service and reports how long the
+// sender was blocked and how long until everything was delivered.
+void runDispatchRound(bool async, int count) {
+    NotificationService* service = NotificationService::getInstance();
+    NotificationEngine* engine = new NotificationEngine();
+    vector<StubChannel*> stubs = {
+        new StubChannel("Email", 2000, 20, ChannelConfig(2, 4096, 100)),
+        new StubChannel("SMS", 0, 1000, ChannelConfig(16, 4096, 1, 5000)),
+        new StubChannel("Popup", 0, 5, ChannelConfig(1, 4096, 1))
+    };
+    for (StubChannel* stub : stubs) {
+        engine->addNotificationStrategy(stub);
+    }
+    if (async) {
+        engine->enableAsyncDispatch();
+    }
+
+    double worstSendMicros = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        auto sendStart = chrono::steady_clock::now();
+        service->sendNotification(new SimpleNotification("Order #" + to_string(i) + " has been shipped!"));
+        worstSendMicros = max(worstSendMicros, chrono::duration<double, micro>(chrono::steady_clock::now() - sendStart).count());
+    }
+    double enqueueSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    engine->waitForDelivery();
+    double totalSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    long long delivered = 0;
+    for (StubChannel* stub : stubs) {
+        delivered += stub->getDelivered();
+    }
+    cout << (async ? "Async: " : "Inline:") << " " << count << " notifications, sender busy " << enqueueSeconds * 1000
+         << " ms (worst send " << (long long)worstSendMicros << " us), all " << delivered << " deliveries done in "
+         << totalSeconds * 1000 << " ms, " << (long long)(delivered / totalSeconds) << " deliveries/sec\n";
+    if (async) {
+        engine->getDispatcher()->printStats(cout);
+    }
+
+    delete engine;
+    for (StubChannel* stub : stubs) {
+        delete stub;
+    }
+}
+
+void runDispatchBenchmark() {
+    cout << "=== DISPATCH: stub Email (2ms session + 20us/msg), SMS (1ms/msg, 5000/s limit), Popup (5us/msg) ===\n";
+    runDispatchRound(false, 300);
+    runDispatchRound(true, 20000);
+}
+
+// Observer that only reads the content, like a logger writing it somewhere
+class ContentReader : public IObserver {
+private:
+    NotificationObservable* observable;
+    size_t bytesRead;
+    size_t updates;
+public:
+    ContentReader(NotificationObservable* observable) {
+        this->observable = observable;
+        bytesRead = 0;
+        updates = 0;
+        observable->addObserver(this);
+    }
+    ~ContentReader() {
+        observable->removeObserver(this);
+    }
+    void update() override {
+        bytesRead += observable->getNotificationContent().size();
+        updates++;
+    }
+    size_t getBytesRead() {
+        return bytesRead;
+    }
+    size_t getUpdates() {
+        return updates;
+    }
+};
+
+long long residentKb() {
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            return atoll(line.c_str() + 6);
+        }
+    }
+    return 0;
+}
+
+INotification* makeShippedNotification(int i) {
+    INotification* notification = new SimpleNotification("Your order #" + to_string(i) + " has been shipped!");
+    notification = new TimestampDecorator(notification);
+    return new SignatureDecorator(notification, "Customer Care");
+}
+
+// Sustained traffic with three reading observers: the service's rendered,
+// bounded storage against keeping every decorator chain and re-rendering
+// it for each reader.
+void runStorageBenchmark() {
+    const int count = 1000000;
+    const int readers = 3;
+    cout << "=== STORAGE: " << count << " decorated notifications, " << readers << " reading observers ===\n";
+
+    NotificationService* service = NotificationService::getInstance();
+    vector<ContentReader*> attached;
+    for (int i = 0; i < readers; i++) {
+        attached.push_back(new ContentReader(service->getObservable()));
+    }
+    long long rssBefore = residentKb();
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        service->sendNotification(makeShippedNotification(i));
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Rendered once, bounded store: " << (long long)(seconds * 1e9 / count) << " ns per notification, RSS +"
+         << residentKb() - rssBefore << " KB, " << service->getHistory().size() << " kept in "
+         << service->getHistory().capacityBytes() / 1024 << " KB, " << service->getHistory().getEvicted() << " evicted\n";
+    service->getHistory().forEachRecent(1, [](uint64_t id, const char* text, size_t length) {
+        cout << "Latest #" << id << ": " << string(text, length);
+    });
+    for (ContentReader* reader : attached) {
+        delete reader;
+    }
+
+    vector<INotification*> kept;
+    size_t bytesRead = 0;
+    rssBefore = residentKb();
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        kept.push_back(makeShippedNotification(i));
+        for (int r = 0; r < readers; r++) {
+            bytesRead += kept.back()->getContent().size();
+        }
+    }
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Chains kept, re-rendered per read: " << (long long)(seconds * 1e9 / count) << " ns per notification, RSS +"
+         << residentKb() - rssBefore << " KB (" << bytesRead / count << " bytes read each)\n";
+    for (INotification* notification : kept) {
+        delete notification;
+    }
+}
+
+// One notification to a million observers, and one to a topic that only a
+// tenth of them follow
+void runFanOutBenchmark(int count) {
+    NotificationService* service = NotificationService::getInstance();
+    NotificationObservable* observable = service->getObservable();
+    vector<ContentReader*> readers;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        readers.push_back(new ContentReader(observable));
+        if (i % 10 == 0) {
+            observable->addObserver(readers.back(), "orders");
+        }
+    }
+    double addNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / count;
+    cout << "=== FAN-OUT: " << observable->getObserverCount() << " observers, add " << addNs << " ns each ===\n";
+
+    // At least 4 threads, so the sharded path runs even on a single core.
+    // Observers of everything get both notifications, "orders" ones only
+    // the second; each exactly once.
+    int threads = max(4u, thread::hardware_concurrency());
+    vector<size_t> before(count);
+    for (int t : {1, threads}) {
+        observable->setDeliveryThreads(t);
+        for (int i = 0; i < count; i++) {
+            before[i] = readers[i]->getUpdates();
+        }
+        start = chrono::steady_clock::now();
+        service->sendNotification(new SimpleNotification("Sale starts now!"));
+        double allMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        start = chrono::steady_clock::now();
+        service->sendNotification(makeShippedNotification(1), "orders");
+        double topicMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        int wrong = 0;
+        for (int i = 0; i < count; i++) {
+            wrong += readers[i]->getUpdates() - before[i] != (i % 10 == 0 ? 1u : 2u);
+        }
+        cout << t << " delivery thread(s): broadcast " << allMs << " ms, \"orders\" topic " << topicMs << " ms, "
+             << wrong << " observers not updated exactly once per notification\n";
+    }
+    observable->setDeliveryThreads(1);
+
+    start = chrono::steady_clock::now();
+    for (ContentReader* reader : readers) {
+        delete reader;
+    }
+    cout << "remove " << chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / count
+         << " ns each, " << observable->getObserverCount() << " left\n";
+}
+
+// Provider that can be switched off to simulate an outage. Counts how often
+// each "Order #<n>" message arrives so duplicates and losses show up.
+class FlakyProvider : public INotificationStrategy {
+private:
+    vector<uint8_t> received;
+public:
+    bool down;
+
+    FlakyProvider(int messages) : received(messages, 0) {
+        down = false;
+    }
+
+    void sendNotification(string content) override {
+        trySend(content);
+    }
+
+    bool trySend(const string& content) override {
+        if (down) {
+            return false;
+        }
+        size_t hash = content.find('#');
+        if (hash != string::npos) {
+            received[atoi(content.c_str() + hash + 1)]++;
+        }
+        return true;
+    }
+
+    string getChannelName() override {
+        return "FlakySMS";
+    }
+
+    void countDeliveries(int& missing, int& duplicated) {
+        missing = duplicated = 0;
+        for (uint8_t count : received) {
+            missing += count == 0;
+            duplicated += count > 1;
+        }
+    }
+};
+
+uint64_t simulatedNowMs = 1700000000000ull;
+
+uint64_t simulatedClock() {
+    return simulatedNowMs;
+}
+
+void removeOutboxDirectory(const string& directory) {
+    if (DIR* dir = opendir(directory.c_str())) {
+        while (dirent* item = readdir(dir)) {
+            if (item->d_name[0] != '.') {
+                unlink((directory + "/" + item->d_name).c_str());
+            }
+        }
+        closedir(dir);
+    }
+    rmdir(directory.c_str());
+}
+
+// A million messages hit a provider outage, the process restarts halfway
+// through the recovery, and the restarted outbox finishes the job. Time is
+// simulated so the backoff schedule runs in seconds instead of minutes.
+void runOutboxBenchmark(int count) {
+    const string directory = "notification_outbox_bench";
+    removeOutboxDirectory(directory);
+    cout << "=== OUTBOX: " << count << " SMS during a provider outage, restart mid-recovery ===\n";
+
+    FlakyProvider provider(count);
+    provider.down = true;
+    NotificationOutbox* outbox = new NotificationOutbox(directory, simulatedClock, 16 << 20);
+    OutboxChannel channel(outbox, outbox->addChannel(&provider), "SMS");
+    outbox->open();
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        channel.sendNotification("Order #" + to_string(i) + " has been shipped!\n");
+    }
+    outbox->flush();
+    cout << "enqueue + fsync: " << chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / count
+         << " ns per message\n";
+
+    simulatedNowMs += NotificationOutbox::TICK_MS;
+    start = chrono::steady_clock::now();
+    size_t attempted = outbox->poll();
+    cout << "first attempt, all failing: " << attempted << " in "
+         << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << " ms\n";
+
+    // Nothing is due for the next ~500ms; each tick should cost the same
+    // whatever the number of pending retries.
+    const int idleTicks = 40;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < idleTicks; i++) {
+        simulatedNowMs += NotificationOutbox::TICK_MS;
+        outbox->poll();
+    }
+    double wheelTickNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / idleTicks;
+    vector<uint64_t> dueTimes(count, simulatedNowMs + 1000);
+    volatile size_t dueCount = 0;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < idleTicks; i++) {
+        size_t ready = 0;
+        for (uint64_t due : dueTimes) {
+            ready += due <= simulatedNowMs + i;
+        }
+        dueCount = dueCount + ready;
+    }
+    double scanTickNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / idleTicks;
+    cout << "idle tick with " << outbox->getPending() << " pending: timer wheel " << (long long)wheelTickNs
+         << " ns, scanning every deadline " << (long long)scanTickNs << " ns\n";
+
+    // The provider comes back; run until roughly half have gone out
+    provider.down = false;
+    start = chrono::steady_clock::now();
+    while (outbox->getPending() > (size_t)count / 2) {
+        simulatedNowMs += NotificationOutbox::TICK_MS;
+        outbox->poll();
+    }
+    double deliverSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    outbox->printStats(cout);
+    cout << "retried deliveries: " << (long long)((count - outbox->getPending()) / deliverSeconds) << " per second\n";
+    delete outbox;
+
+    outbox = new NotificationOutbox(directory, simulatedClock, 16 << 20);
+    outbox->addChannel(&provider);
+    start = chrono::steady_clock::now();
+    size_t recovered = outbox->open();
+    cout << "restart: replayed segments in " << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count()
+         << " ms, " << recovered << " unacknowledged messages rescheduled\n";
+    while (outbox->getPending() > 0) {
+        simulatedNowMs += NotificationOutbox::TICK_MS;
+        outbox->poll();
+    }
+    outbox->printStats(cout);
+    int missing, duplicated;
+    provider.countDeliveries(missing, duplicated);
+    cout << "provider saw " << count - missing << " of " << count << " messages, " << duplicated << " duplicated\n";
+    delete outbox;
+    removeOutboxDirectory(directory);
+
+    // A segment cannot be created under a regular file: nothing is accepted
+    NotificationOutbox broken("/dev/null/outbox", simulatedClock);
+    broken.addChannel(&provider);
+    broken.open();
+    uint64_t id = broken.enqueue(0, "lost?");
+    cout << "outbox without a segment: writable " << broken.isWritable() << ", enqueue returned " << id
+         << ", flush " << (broken.flush() ? "ok" : "failed") << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--benchmark") {
+        runDispatchBenchmark();
+        runStorageBenchmark();
+        runFanOutBenchmark(1000000);
+        runOutboxBenchmark(1000000);
+        return 0;
+    }
+
     // Create NotificationService.
     NotificationService* notificationService = NotificationService::getInstance();
    
@@ -1,5 +1,7 @@
 #pragma once
+#include<unordered_map>
 #include "managers/PlaylistManager.hpp"
+#include "library/SongLibrary.hpp"
 #include "MusicPlayerFacade.hpp"
 
 using namespace std;
@@ -8,7 +10,11 @@ class MusicPlayerApplication {
 private:
     static MusicPlayerApplication* instance;
     vector<Song*> songLibrary;
-    MusicPlayerApplication() {}
+    unordered_map<string, Song*> songsByTitle;   // first song created with each title
+    SongLibrary* catalog;                          // optional indexed catalog
+    MusicPlayerApplication() {
+        catalog = nullptr;
+    }
 
 public:
     static MusicPlayerApplication* getInstance() {
@@ -22,16 +28,46 @@ public:
                                 const string& path) {
         Song* newSong = new Song(title, artist, path);
         songLibrary.push_back(newSong);
+        songsByTitle.emplace(title, newSong);
     }
 
+    // Songs not created yet come from the catalog, if one is open
     Song* findSongByTitle(const string& title) {
-        for (Song* s : songLibrary) {
-            if (s->getTitle() == title) {
-                return s;
+        auto found = songsByTitle.find(title);
+        if (found != songsByTitle.end()) {
+            return found->second;
+        }
+        if (catalog) {
+            vector<uint32_t> ids = catalog->findExact(LibraryField::TITLE, title, 1);
+            if (!ids.empty()) {
+                Song* song = catalog->createSong(ids[0]);
+                songLibrary.push_back(song);
+                songsByTitle.emplace(title, song);
+                return song;
             }
         }
         return nullptr;
     }
+
+    // Uses an index written by LibraryIndexBuilder as the song catalog
+    void openCatalog(const string& indexPath) {
+        SongLibrary* opened = new SongLibrary(indexPath);
+        delete catalog;
+        catalog = opened;
+        cout << "Opened catalog of " << catalog->getSongCount() << " songs\n";
+    }
+
+    // Prints catalog songs whose title or artist contains query
+    void searchCatalog(const string& query, size_t limit) {
+        if (!catalog) {
+            throw runtime_error("No catalog is open.");
+        }
+        for (LibraryField field : {LibraryField::TITLE, LibraryField::ARTIST}) {
+            for (uint32_t id : catalog->searchSubstring(field, query, limit)) {
+                cout << "Found: " << catalog->getTitle(id) << " by " << catalog->getArtist(id) << "\n";
+            }
+        }
+    }
     void createPlaylist(const string& playlistName) {
         PlaylistManager::getInstance()->createPlaylist(playlistName);
     }
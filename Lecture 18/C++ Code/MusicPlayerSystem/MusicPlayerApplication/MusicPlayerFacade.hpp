@@ -75,6 +75,18 @@ public:
         cout << "Completed playlist: " << loadedPlaylist->getPlaylistName() << "\n";
     }
 
+    // Like playAllTracks, but decodes the audio files and streams PCM with
+    // gapless transitions, to every connected device at once.
+    void streamAllTracks() {
+        if (!loadedPlaylist) {
+            throw runtime_error("No playlist loaded.");
+        }
+        IAudioOutputDevice* device = DeviceManager::getInstance()->getStreamOutput();
+        audioEngine->startStream(device, playStrategy);
+        audioEngine->waitForStream();
+        cout << "Completed playlist: " << loadedPlaylist->getPlaylistName() << "\n";
+    }
+
     void playNextTrack() {
         if (!loadedPlaylist) {
             throw runtime_error("No playlist loaded.");
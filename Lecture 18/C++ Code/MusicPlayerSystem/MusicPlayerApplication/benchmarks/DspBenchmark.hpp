@@ -0,0 +1,170 @@
+#pragma once
+#include<iostream>
+#include<string>
+#include<vector>
+#include<chrono>
+#include<cmath>
+#include<ctime>
+#include<sys/stat.h>
+#include<unistd.h>
+#include "../dsp/DspKernels.hpp"
+#include "../dsp/Resampler.hpp"
+#include "../core/PlaybackPipeline.hpp"
+#include "../device/WavFileOutputDevice.hpp"
+#include "../strategies/SequentialPlayStrategy.hpp"
+#include "PipelineBenchmark.hpp"
+
+using namespace std;
+
+class DspBenchmark {
+private:
+    static double cpuSeconds() {
+        timespec now;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        return now.tv_sec + now.tv_nsec / 1e9;
+    }
+
+    static float maxDifference(const vector<float>& a, const vector<float>& b) {
+        float worst = a.size() == b.size() ? 0.0f : INFINITY;
+        for (size_t i = 0; i < min(a.size(), b.size()); i++) {
+            worst = max(worst, fabs(a[i] - b[i]));
+        }
+        return worst;
+    }
+
+    struct KernelRun {
+        vector<float> gain;
+        vector<float> crossfade;
+        vector<float> resampled;
+        double gainRate;
+        double crossfadeRate;
+        double resampleRate;
+    };
+
+    // Runs each kernel over the same input repeatedly; rates are output
+    // samples per CPU second
+    static KernelRun runKernels(const DspKernelSet& kernels, const vector<float>& a, const vector<float>& b,
+                                const vector<float>& fadeOut, const vector<float>& fadeIn) {
+        const int repeats = 20;
+        size_t frames = a.size() / 2;
+        KernelRun run;
+
+        run.gain = a;
+        double start = cpuSeconds();
+        for (int r = 0; r < repeats; r++) {
+            run.gain = a;
+            kernels.applyGain(run.gain.data(), frames, 0.25f, 0.5f / frames);
+        }
+        run.gainRate = 2.0 * frames * repeats / (cpuSeconds() - start);
+
+        run.crossfade.resize(a.size());
+        start = cpuSeconds();
+        for (int r = 0; r < repeats; r++) {
+            kernels.crossfade(run.crossfade.data(), a.data(), b.data(), fadeOut.data(), fadeIn.data(), frames);
+        }
+        run.crossfadeRate = 2.0 * frames * repeats / (cpuSeconds() - start);
+
+        uint64_t step = (44100ull << 32) / 48000;
+        run.resampled.resize(a.size() * 48000 / 44100 + 16);
+        size_t produced = 0;
+        start = cpuSeconds();
+        for (int r = 0; r < repeats; r++) {
+            uint64_t position = 1ull << 32;
+            produced = kernels.resample(a.data(), frames, run.resampled.data(), run.resampled.size() / 2, position, step);
+        }
+        run.resampleRate = 2.0 * produced * repeats / (cpuSeconds() - start);
+        run.resampled.resize(2 * produced);
+        return run;
+    }
+
+public:
+    static void run() {
+        const size_t frames = 1 << 18;
+        vector<float> a(2 * frames), b(2 * frames), fadeOut(frames), fadeIn(frames);
+        uint32_t seed = 12345;
+        for (size_t i = 0; i < 2 * frames; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            a[i] = (int32_t)seed / 2147483648.0f;
+            b[i] = sinf(i * 0.001f);
+        }
+        for (size_t f = 0; f < frames; f++) {
+            fadeOut[f] = cosf((f + 0.5f) / frames * (float)M_PI / 2);
+            fadeIn[f] = sinf((f + 0.5f) / frames * (float)M_PI / 2);
+        }
+
+        cout << "=== DSP: stereo float kernels, output samples per CPU second (active: "
+             << DspKernels::active().name << ") ===\n";
+        KernelRun reference = runKernels(DspKernels::get(DspIsa::SCALAR), a, b, fadeOut, fadeIn);
+        for (DspIsa isa : {DspIsa::SCALAR, DspIsa::SSE, DspIsa::AVX2}) {
+            if (!DspKernels::supported(isa)) {
+                cout << DspKernels::get(isa).name << ": not supported on this CPU\n";
+                continue;
+            }
+            KernelRun run = isa == DspIsa::SCALAR ? reference
+                                                  : runKernels(DspKernels::get(isa), a, b, fadeOut, fadeIn);
+            cout << DspKernels::get(isa).name << ": gain " << (long long)(run.gainRate / 1e6) << "M/s, crossfade "
+                 << (long long)(run.crossfadeRate / 1e6) << "M/s, resample 44.1k->48k "
+                 << (long long)(run.resampleRate / 1e6) << "M/s; max |difference| from scalar "
+                 << maxDifference(run.gain, reference.gain) << " / " << maxDifference(run.crossfade, reference.crossfade)
+                 << " / " << maxDifference(run.resampled, reference.resampled) << "\n";
+        }
+
+        // Resampling accuracy: a 1 kHz tone at 44.1 kHz against the same
+        // tone computed directly at 48 kHz
+        {
+            vector<float> tone(2 * 44100);
+            for (int i = 0; i < 44100; i++) {
+                tone[2 * i] = tone[2 * i + 1] = 0.5f * sinf(2 * (float)M_PI * 1000 * i / 44100);
+            }
+            Resampler resampler(44100, 48000);
+            vector<float> out(2 * 48100);
+            resampler.push(tone.data(), 44100);
+            resampler.finish();
+            size_t produced = resampler.drain(out.data(), 48100);
+            // The last few outputs interpolate against the repeated final
+            // frame, not a continuing tone, so they are left out
+            float worst = 0;
+            for (size_t i = 0; i + 3 < produced; i++) {
+                worst = max(worst, fabs(out[2 * i] - 0.5f * sinf(2 * (float)M_PI * 1000 * i / 48000)));
+            }
+            cout << "1 kHz tone 44.1k->48k: " << produced << " frames, max error " << worst << " ("
+                 << 20 * log10(worst / 0.5) << " dB)\n";
+        }
+
+        // Whole stage: mixed-rate tracks resampled to 48 kHz, crossfaded
+        // and attenuated on the way to a file
+        {
+            const string directory = "dsp_benchmark_audio";
+            mkdir(directory.c_str(), 0755);
+            const int rates[] = {44100, 48000, 22050, 96000};
+            vector<Song*> songs;
+            double inputSeconds = 0;
+            for (int i = 0; i < 4; i++) {
+                string path = directory + "/tone" + to_string(i) + ".wav";
+                PipelineBenchmark::writeToneWav(path, 3.0, 2, 16, 330.0 * (i + 1), rates[i]);
+                songs.push_back(new Song("Tone " + to_string(i), "Benchmark", path));
+                inputSeconds += 3.0;
+            }
+            Playlist* playlist = PipelineBenchmark::makePlaylist("dsp", songs, 1);
+            SequentialPlayStrategy strategy;
+            strategy.setPlaylist(playlist);
+            WavFileOutputDevice file(directory + "/mixed.wav");
+            PlaybackPipeline pipeline(&file, &strategy, 48000);
+            pipeline.setCrossfade(0.5);
+            pipeline.setDeviceGain(0.5f);
+            pipeline.start();
+            pipeline.wait();
+            double seconds = (double)pipeline.getFramesPlayed() / 48000;
+            cout << "pipeline: 4 x 3 s tracks at 44.1/48/22.05/96 kHz -> 48 kHz with 0.5 s crossfades: " << seconds
+                 << " s out (expected " << inputSeconds - 3 * 0.5 << "), CPU " << 100 * pipeline.getCpuSeconds() / seconds
+                 << "% of a core\n";
+            delete playlist;
+            for (Song* song : songs) {
+                unlink(song->getFilePath().c_str());
+                delete song;
+            }
+            unlink((directory + "/mixed.wav").c_str());
+            rmdir(directory.c_str());
+        }
+    }
+};
\ No newline at end of file
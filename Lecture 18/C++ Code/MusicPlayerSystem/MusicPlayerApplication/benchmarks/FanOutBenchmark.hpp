@@ -0,0 +1,75 @@
+#pragma once
+#include<iostream>
+#include<string>
+#include<vector>
+#include<chrono>
+#include<sys/stat.h>
+#include<unistd.h>
+#include "../core/PlaybackPipeline.hpp"
+#include "../device/FanOutOutputDevice.hpp"
+#include "../device/SimulatedOutputDevice.hpp"
+#include "../strategies/SequentialPlayStrategy.hpp"
+#include "PipelineBenchmark.hpp"
+
+using namespace std;
+
+class FanOutBenchmark {
+public:
+    // One stream decoded once and played in real time on four simulated
+    // devices with different latencies and clock errors; one of them
+    // freezes for half a second partway through.
+    static void run() {
+        const int sampleRate = 48000;
+        const string directory = "fanout_benchmark_audio";
+        mkdir(directory.c_str(), 0755);
+        vector<Song*> songs;
+        for (int i = 0; i < 3; i++) {
+            string path = directory + "/tone" + to_string(i) + ".wav";
+            PipelineBenchmark::writeToneWav(path, 2.0, 2, 16, 440.0 * (i + 1), sampleRate);
+            songs.push_back(new Song("Tone " + to_string(i), "Benchmark", path));
+        }
+        Playlist* playlist = PipelineBenchmark::makePlaylist("fanout", songs, 1);
+        SequentialPlayStrategy strategy;
+        strategy.setPlaylist(playlist);
+
+        vector<SimulatedOutputDevice*> devices = {
+            new SimulatedOutputDevice("Wired speaker", 0.005, 0),
+            new SimulatedOutputDevice("Headphones", 0.030, 3000),
+            new SimulatedOutputDevice("Bluetooth speaker", 0.180, -3000),
+            new SimulatedOutputDevice("Flaky Bluetooth", 0.120, 500, 2.0, 500)
+        };
+        FanOutOutputDevice* fanOut = new FanOutOutputDevice();
+        for (SimulatedOutputDevice* device : devices) {
+            fanOut->addDevice(device);
+        }
+
+        cout << "=== FAN-OUT: 6 s stream decoded once, played on " << devices.size() << " devices in real time ===\n";
+        PlaybackPipeline pipeline(fanOut, &strategy, sampleRate);
+        auto start = chrono::steady_clock::now();
+        pipeline.start();
+        pipeline.wait();
+        double wall = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        double seconds = (double)pipeline.getFramesPlayed() / sampleRate;
+        cout << "decoded " << seconds << " s once in " << wall << " s wall, " << pipeline.getUnderruns()
+             << " pipeline underruns, decode+fan-out CPU " << 100 * pipeline.getCpuSeconds() / seconds << "% of a core\n";
+        for (int i = 0; i < (int)devices.size(); i++) {
+            FanOutBranchStats stats = fanOut->getStats(i);
+            cout << "  " << devices[i]->getName() << " (" << (int)(devices[i]->getLatencySeconds() * 1000) << " ms): "
+                 << (double)stats.framesPlayed / sampleRate << " s played, " << stats.underruns << " underruns, "
+                 << stats.droppedFrames << " frames dropped, " << stats.resyncs << " resyncs, clock measured at "
+                 << (long long)stats.driftPpm << " ppm (actual " << devices[i]->getClockPpm() << "), buffer "
+                 << stats.fillError << " frames off target\n";
+        }
+
+        delete fanOut;
+        for (SimulatedOutputDevice* device : devices) {
+            delete device;
+        }
+        delete playlist;
+        for (Song* song : songs) {
+            unlink(song->getFilePath().c_str());
+            delete song;
+        }
+        rmdir(directory.c_str());
+    }
+};
\ No newline at end of file
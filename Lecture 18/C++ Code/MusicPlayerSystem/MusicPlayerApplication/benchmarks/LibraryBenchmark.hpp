@@ -0,0 +1,173 @@
+#pragma once
+#include<iostream>
+#include<string>
+#include<vector>
+#include<chrono>
+#include<algorithm>
+#include<cstdio>
+#include<sys/stat.h>
+#include "../library/LibraryIndexBuilder.hpp"
+#include "../library/SongLibrary.hpp"
+
+using namespace std;
+
+class LibraryBenchmark {
+private:
+    struct Random {
+        uint64_t state;
+        uint32_t next() {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            return (uint32_t)(state >> 33);
+        }
+        // Skewed towards small values, like word and artist popularity
+        uint32_t skewed(uint32_t range) {
+            return (uint32_t)((uint64_t)(next() % range) * (next() % range) / range);
+        }
+    };
+
+    static vector<string> makeWords(Random& random, int count) {
+        const char* syllables[] = {"ka", "ri", "lo", "ve", "na", "mi", "so", "ta", "re", "du", "ba", "ne", "zi",
+                                   "ho", "ja", "el", "an", "or", "sha", "tum", "dil", "ya", "ro", "me", "sun",
+                                   "ki", "la", "pa", "de", "go", "nu", "chi"};
+        vector<string> words;
+        for (int i = 0; i < count; i++) {
+            string word;
+            for (int s = 2 + random.next() % 2; s > 0; s--) {
+                word += syllables[random.next() % 32];
+            }
+            word[0] = (char)toupper(word[0]);
+            words.push_back(word);
+        }
+        return words;
+    }
+
+    template <typename Query>
+    static void timeQueries(const string& label, int count, Query query) {
+        vector<double> micros;
+        size_t results = 0;
+        for (int i = 0; i < count; i++) {
+            auto start = chrono::steady_clock::now();
+            results += query(i);
+            micros.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+        }
+        sort(micros.begin(), micros.end());
+        double total = 0;
+        for (double m : micros) {
+            total += m;
+        }
+        cout << "  " << label << ": " << total / count << " us mean, " << micros[count * 99 / 100] << " us p99, "
+             << (double)results / count << " results\n";
+    }
+
+public:
+    static void run(int songCount) {
+        Random random = {42};
+        vector<string> words = makeWords(random, 30000);
+        vector<string> artists;
+        for (int i = 0; i < 300000; i++) {
+            artists.push_back(words[random.next() % words.size()] + " " + words[random.next() % words.size()]);
+        }
+
+        cout << "=== LIBRARY: " << songCount << " songs ===\n";
+        auto start = chrono::steady_clock::now();
+        LibraryIndexBuilder builder;
+        for (int i = 0; i < songCount; i++) {
+            string title;
+            for (int w = 1 + random.next() % 4; w > 0; w--) {
+                title += words[random.skewed(words.size())] + (w > 1 ? " " : "");
+            }
+            int artist = random.skewed(artists.size());
+            builder.addSong(title, artists[artist], "/music/" + to_string(artist) + "/" + to_string(i) + ".wav");
+        }
+        double added = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        const string indexPath = "library_benchmark.idx";
+        builder.write(indexPath);
+        double built = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        struct stat info;
+        stat(indexPath.c_str(), &info);
+        cout << "build: " << added << " s to add, " << built - added << " s to index and write "
+             << info.st_size / (1 << 20) << " MB\n";
+
+        start = chrono::steady_clock::now();
+        SongLibrary library(indexPath);
+        cout << "open (mmap): " << chrono::duration<double, micro>(chrono::steady_clock::now() - start).count()
+             << " us\n";
+
+        // Queries are cut from random songs so most of them match: from the
+        // start of a word (as people type), from inside one word, and
+        // across a word boundary starting and ending mid-word
+        const int queries = 20000;
+        const size_t limit = 20;
+        vector<string> titles, titlePrefixes, artistPrefixes, typed, inWord, acrossWords, artistFragments;
+        for (int i = 0; titles.size() < (size_t)queries; i++) {
+            uint32_t song = random.next() % songCount;
+            string title = library.getTitle(song);
+            string text = SearchText::normalize(title);
+            string artist = SearchText::normalize(library.getArtist(song));
+            size_t length = 3 + i % 6;
+            size_t space = text.find(' ');
+            if (space == string::npos || space < 2 || text.size() - space < 3 || text.size() < length) {
+                continue;
+            }
+            titles.push_back(title);
+            titlePrefixes.push_back(text.substr(0, length));
+            artistPrefixes.push_back(artist.substr(0, min(length, artist.size())));
+            size_t wordStart = text.rfind(' ', text.size() - length);
+            wordStart = wordStart == string::npos ? 0 : wordStart + 1;
+            typed.push_back(text.substr(wordStart, length));
+            inWord.push_back(text.substr(1, min(space - 1, length)));
+            acrossWords.push_back(text.substr(space - 2, 4));
+            artistFragments.push_back(artist.substr(1, min(artist.find(' ') - 1, length)));
+        }
+        cout << "queries (limit " << limit << ", 3-8 characters):\n";
+        timeQueries("exact title", queries, [&](int i) {
+            return library.findExact(LibraryField::TITLE, titles[i], limit).size();
+        });
+        timeQueries("title prefix", queries, [&](int i) {
+            return library.searchPrefix(LibraryField::TITLE, titlePrefixes[i], limit).size();
+        });
+        timeQueries("title substring, from a word start", queries, [&](int i) {
+            return library.searchSubstring(LibraryField::TITLE, typed[i], limit).size();
+        });
+        timeQueries("title substring, inside a word", queries, [&](int i) {
+            return library.searchSubstring(LibraryField::TITLE, inWord[i], limit).size();
+        });
+        timeQueries("title substring, \"xx yy\" across words", queries, [&](int i) {
+            return library.searchSubstring(LibraryField::TITLE, acrossWords[i], limit).size();
+        });
+        timeQueries("artist prefix", queries, [&](int i) {
+            return library.searchPrefix(LibraryField::ARTIST, artistPrefixes[i], limit).size();
+        });
+        timeQueries("artist substring, inside a word", queries, [&](int i) {
+            return library.searchSubstring(LibraryField::ARTIST, artistFragments[i], limit).size();
+        });
+
+        // What a search cost before: a linear pass over every song's title
+        start = chrono::steady_clock::now();
+        const int scans = 3;
+        size_t found = 0;
+        string text;
+        for (int q = 0; q < scans; q++) {
+            const string& needle = inWord[q];
+            for (uint32_t id = 0; id < (uint32_t)songCount && found < (size_t)(q + 1) * limit; id++) {
+                string title = library.getTitle(id);
+                SearchText::normalize(title.data(), title.size(), text);
+                if (text.find(needle) != string::npos) {
+                    found++;
+                }
+            }
+        }
+        cout << "linear scan to the same " << limit << " substring matches: "
+             << chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / scans << " us\n";
+        start = chrono::steady_clock::now();
+        size_t all = 0;
+        for (uint32_t id = 0; id < (uint32_t)songCount; id++) {
+            string title = library.getTitle(id);
+            SearchText::normalize(title.data(), title.size(), text);
+            all += text.find(inWord[0]) != string::npos;
+        }
+        cout << "linear scan of every title: " << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count()
+             << " ms (" << all << " matches)\n";
+        remove(indexPath.c_str());
+    }
+};
\ No newline at end of file
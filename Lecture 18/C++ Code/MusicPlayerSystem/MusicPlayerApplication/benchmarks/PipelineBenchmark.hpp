@@ -0,0 +1,202 @@
+#pragma once
+#include<iostream>
+#include<string>
+#include<vector>
+#include<chrono>
+#include<cmath>
+#include<cstdio>
+#include<sys/stat.h>
+#include<unistd.h>
+#include "../core/PlaybackPipeline.hpp"
+#include "../core/WavDecoder.hpp"
+#include "../device/NullOutputDevice.hpp"
+#include "../device/WavFileOutputDevice.hpp"
+#include "../strategies/SequentialPlayStrategy.hpp"
+
+using namespace std;
+
+class PipelineBenchmark {
+private:
+    static const int SAMPLE_RATE = 44100;
+
+public:
+    static Playlist* makePlaylist(const string& name, const vector<Song*>& songs, int repeats) {
+        Playlist* playlist = new Playlist(name);
+        for (int r = 0; r < repeats; r++) {
+            for (Song* song : songs) {
+                playlist->addSongToPlaylist(song);
+            }
+        }
+        return playlist;
+    }
+
+    // Sine tone in the given encoding (16/24-bit integer or 32-bit float)
+    static void writeToneWav(const string& path, double seconds, int channels, int bits, double frequency,
+                             int sampleRate = SAMPLE_RATE) {
+        uint32_t frames = (uint32_t)(seconds * sampleRate);
+        uint16_t format = bits == 32 ? 3 : 1;
+        uint16_t channelCount = channels, bitCount = bits;
+        uint16_t blockAlign = channels * bits / 8;
+        uint32_t rate = sampleRate, byteRate = sampleRate * blockAlign;
+        uint32_t dataBytes = frames * blockAlign, riffSize = 36 + dataBytes, formatSize = 16;
+
+        FILE* file = fopen(path.c_str(), "wb");
+        fwrite("RIFF", 1, 4, file);
+        fwrite(&riffSize, 4, 1, file);
+        fwrite("WAVEfmt ", 1, 8, file);
+        fwrite(&formatSize, 4, 1, file);
+        fwrite(&format, 2, 1, file);
+        fwrite(&channelCount, 2, 1, file);
+        fwrite(&rate, 4, 1, file);
+        fwrite(&byteRate, 4, 1, file);
+        fwrite(&blockAlign, 2, 1, file);
+        fwrite(&bitCount, 2, 1, file);
+        fwrite("data", 1, 4, file);
+        fwrite(&dataBytes, 4, 1, file);
+        vector<uint8_t> samples(dataBytes);
+        uint8_t* out = samples.data();
+        for (uint32_t i = 0; i < frames; i++) {
+            for (int c = 0; c < channels; c++) {
+                double value = 0.5 * sin(2 * M_PI * frequency * (c + 1) * i / sampleRate);
+                if (bits == 16) {
+                    int16_t sample = (int16_t)(value * 32767);
+                    memcpy(out, &sample, 2);
+                } else if (bits == 24) {
+                    int32_t sample = (int32_t)(value * 8388607);
+                    out[0] = sample & 0xFF;
+                    out[1] = (sample >> 8) & 0xFF;
+                    out[2] = (sample >> 16) & 0xFF;
+                } else {
+                    float sample = (float)value;
+                    memcpy(out, &sample, 4);
+                }
+                out += bits / 8;
+            }
+        }
+        fwrite(samples.data(), 1, samples.size(), file);
+        fclose(file);
+    }
+
+    static vector<float> decodeAll(const string& path) {
+        WavDecoder decoder(path);
+        vector<float> samples(decoder.getTotalFrames() * 2);
+        decoder.decode(samples.data(), decoder.getTotalFrames());
+        return samples;
+    }
+
+    static void run() {
+        const string directory = "pipeline_benchmark_audio";
+        mkdir(directory.c_str(), 0755);
+        vector<Song*> songs;
+        const int bits[] = {16, 24, 32, 16};
+        const int channels[] = {2, 1, 2, 1};
+        for (int i = 0; i < 4; i++) {
+            string path = directory + "/tone" + to_string(i) + ".wav";
+            writeToneWav(path, 1.0 + 0.25 * i, channels[i], bits[i], 220.0 * (i + 1));
+            songs.push_back(new Song("Tone " + to_string(i), "Benchmark", path));
+        }
+        cout << "=== PIPELINE: mmap WAV decoder -> SPSC ring -> output thread ===\n";
+
+        // Gapless: the file sink must hold exactly the tracks' frames, in order
+        {
+            Playlist* playlist = makePlaylist("gapless", songs, 1);
+            SequentialPlayStrategy strategy;
+            strategy.setPlaylist(playlist);
+            string outputPath = directory + "/gapless.wav";
+            WavFileOutputDevice file(outputPath);
+            PlaybackPipeline pipeline(&file, &strategy, SAMPLE_RATE);
+            pipeline.start();
+            pipeline.wait();
+            file.closeStream();
+
+            vector<float> expected;
+            for (Song* song : songs) {
+                vector<float> track = decodeAll(song->getFilePath());
+                expected.insert(expected.end(), track.begin(), track.end());
+            }
+            vector<float> written = decodeAll(outputPath);
+            float maxError = written.size() == expected.size() ? 0.0f : 1.0f;
+            for (size_t i = 0; i < min(written.size(), expected.size()); i++) {
+                maxError = max(maxError, fabs(written[i] - expected[i]));
+            }
+            cout << "gapless: " << pipeline.getTracksStarted() << " tracks, " << written.size() / 2 << " frames written for "
+                 << expected.size() / 2 << " decoded, max sample error " << maxError << "\n";
+            delete playlist;
+        }
+
+        // Throughput with an unclocked sink: how much CPU a stream costs
+        {
+            Playlist* playlist = makePlaylist("throughput", songs, 100);
+            SequentialPlayStrategy strategy;
+            strategy.setPlaylist(playlist);
+            NullOutputDevice sink(false);
+            PlaybackPipeline pipeline(&sink, &strategy, SAMPLE_RATE);
+            auto start = chrono::steady_clock::now();
+            pipeline.start();
+            pipeline.wait();
+            double wall = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            double audio = (double)pipeline.getFramesPlayed() / SAMPLE_RATE;
+            cout << "unclocked: " << audio << " s of audio (" << pipeline.getTracksStarted() << " tracks) in " << wall * 1000
+                 << " ms, " << pipeline.getCpuSeconds() * 1e9 / pipeline.getFramesPlayed() << " ns CPU per frame, "
+                 << 100 * pipeline.getCpuSeconds() / audio << "% of a core per real-time stream\n";
+            delete playlist;
+        }
+
+        // Real time: several clocked devices at once, counting underruns
+        {
+            const int streams = 4;
+            vector<Playlist*> playlists;
+            vector<SequentialPlayStrategy*> strategies;
+            vector<NullOutputDevice*> devices;
+            vector<PlaybackPipeline*> pipelines;
+            for (int i = 0; i < streams; i++) {
+                playlists.push_back(makePlaylist("realtime" + to_string(i), {songs[i], songs[(i + 1) % 4]}, 1));
+                strategies.push_back(new SequentialPlayStrategy());
+                strategies.back()->setPlaylist(playlists.back());
+                devices.push_back(new NullOutputDevice(true));
+                pipelines.push_back(new PlaybackPipeline(devices.back(), strategies.back(), SAMPLE_RATE));
+                pipelines.back()->start();
+            }
+            for (int i = 0; i < streams; i++) {
+                pipelines[i]->wait();
+                double audio = (double)pipelines[i]->getFramesPlayed() / SAMPLE_RATE;
+                cout << "clocked stream " << i << ": " << audio << " s played, " << pipelines[i]->getUnderruns()
+                     << " underruns, CPU " << 100 * pipelines[i]->getCpuSeconds() / audio << "% of a core\n";
+                delete pipelines[i];
+                delete devices[i];
+                delete strategies[i];
+                delete playlists[i];
+            }
+        }
+
+        // A header claiming 0 Hz is skipped instead of streaming forever
+        {
+            string path = directory + "/zero-rate.wav";
+            writeToneWav(path, 0.5, 2, 16, 440.0);
+            uint32_t zero = 0;
+            FILE* file = fopen(path.c_str(), "r+b");
+            fseek(file, 24, SEEK_SET);
+            fwrite(&zero, 4, 1, file);
+            fclose(file);
+            Song broken("Zero rate", "Benchmark", path);
+            Playlist* playlist = makePlaylist("malformed", {songs[0], &broken, songs[1]}, 1);
+            SequentialPlayStrategy strategy;
+            strategy.setPlaylist(playlist);
+            NullOutputDevice sink(false);
+            PlaybackPipeline pipeline(&sink, &strategy, SAMPLE_RATE);
+            pipeline.start();
+            pipeline.wait();
+            cout << "malformed: " << pipeline.getTracksStarted() << " of 3 tracks played, "
+                 << (double)pipeline.getFramesPlayed() / SAMPLE_RATE << " s\n";
+            delete playlist;
+            unlink(path.c_str());
+        }
+
+        for (int i = 0; i < 4; i++) {
+            unlink(songs[i]->getFilePath().c_str());
+            delete songs[i];
+        }
+        unlink((directory + "/gapless.wav").c_str());
+        rmdir(directory.c_str());
+    }
+};
\ No newline at end of file
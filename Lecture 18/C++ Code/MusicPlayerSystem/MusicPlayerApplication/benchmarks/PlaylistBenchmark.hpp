@@ -0,0 +1,83 @@
+#pragma once
+#include<iostream>
+#include<string>
+#include<vector>
+#include<chrono>
+#include "../MusicPlayerFacade.hpp"
+#include "../managers/PlaylistManager.hpp"
+
+using namespace std;
+
+// Swallows everything written to it, so printing does not dominate timings
+class NullBuffer : public streambuf {
+protected:
+    int overflow(int c) override {
+        return c;
+    }
+    streamsize xsputn(const char*, streamsize count) override {
+        return count;
+    }
+};
+
+class PlaylistBenchmark {
+private:
+    static Playlist* buildPlaylist(int size) {
+        string name = "benchmark-" + to_string(size);
+        PlaylistManager::getInstance()->createPlaylist(name);
+        for (int i = 0; i < size; i++) {
+            PlaylistManager::getInstance()->addSongToPlaylist(name,
+                new Song("Track " + to_string(i), "Artist " + to_string(i % 5000), "/music/" + to_string(i) + ".wav"));
+        }
+        return PlaylistManager::getInstance()->getPlaylist(name);
+    }
+
+    // playAllTracks with output silenced; returns nanoseconds per track
+    static double timePlayAll(Playlist* playlist, PlayStrategyType type, int queued) {
+        MusicPlayerFacade* player = MusicPlayerFacade::getInstance();
+        player->setPlayStrategy(type);
+        player->loadPlaylist(playlist->getPlaylistName());
+        for (int i = 0; i < queued; i++) {
+            player->enqueueNext(playlist->getSongAt((int)((long long)i * 7919 % playlist->getSize())));
+        }
+        NullBuffer sink;
+        streambuf* console = cout.rdbuf(&sink);
+        auto start = chrono::steady_clock::now();
+        player->playAllTracks();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout.rdbuf(console);
+        return seconds * 1e9 / playlist->getSize();
+    }
+
+    // What every next() used to pay when getSongs() returned a copy
+    static double timeCopyPerTrack(Playlist* playlist) {
+        volatile Song* last = nullptr;
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < playlist->getSize(); i++) {
+            vector<Song*> copy = playlist->getSongs();
+            last = copy[i];
+        }
+        (void)last;
+        return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / playlist->getSize();
+    }
+
+public:
+    static void run() {
+        NullBuffer sink;
+        streambuf* console = cout.rdbuf(&sink);
+        MusicPlayerFacade::getInstance()->connectDevice(DeviceType::WIRED);
+        cout.rdbuf(console);
+
+        cout << "=== PLAYLIST: playAllTracks, console output discarded ===\n";
+        for (int size : {10000, 100000, 1000000}) {
+            Playlist* playlist = buildPlaylist(size);
+            double sequential = timePlayAll(playlist, PlayStrategyType::SEQUENTIAL, 0);
+            double queue = timePlayAll(playlist, PlayStrategyType::CUSTOM_QUEUE, size / 100);
+            cout << size << " tracks: sequential " << (long long)sequential << " ns/track, custom queue ("
+                 << size / 100 << " queued) " << (long long)queue << " ns/track";
+            if (size == 10000) {
+                cout << "; copying the list per track would add " << (long long)timeCopyPerTrack(playlist) << " ns";
+            }
+            cout << "\n";
+        }
+    }
+};
@@ -0,0 +1,170 @@
+#pragma once
+#include<iostream>
+#include<string>
+#include<vector>
+#include<chrono>
+#include<algorithm>
+#include<cstdlib>
+#include<stack>
+#include "../models/Playlist.hpp"
+#include "../strategies/RandomPlayStrategy.hpp"
+#include "../strategies/WeightedShuffleStrategy.hpp"
+#include "../strategies/ArtistSpreadShuffleStrategy.hpp"
+
+using namespace std;
+
+class ShuffleBenchmark {
+private:
+    // The shuffle RandomPlayStrategy used before: copy the playlist, then
+    // rand() % size with swap and pop
+    class CopyingRandomStrategy : public PlayStrategy {
+    private:
+        vector<Song*> remainingSongs;
+        stack<Song*> history;
+    public:
+        void setPlaylist(Playlist* playlist) override {
+            remainingSongs = playlist->getSongs();
+            history = stack<Song*>();
+        }
+        bool hasNext() override {
+            return !remainingSongs.empty();
+        }
+        Song* next() override {
+            int idx = rand() % remainingSongs.size();
+            Song* selectedSong = remainingSongs[idx];
+            swap(remainingSongs[idx], remainingSongs.back());
+            remainingSongs.pop_back();
+            history.push(selectedSong);
+            return selectedSong;
+        }
+        bool hasPrevious() override {
+            return false;
+        }
+        Song* previous() override {
+            return nullptr;
+        }
+    };
+
+    // Artist popularity is skewed; dominantShare of the songs go to one artist
+    static Playlist* buildPlaylist(int size, double dominantShare, FastRandom& random) {
+        Playlist* playlist = new Playlist("shuffle-" + to_string(size));
+        for (int i = 0; i < size; i++) {
+            int artist = random.below(1000000) < dominantShare * 1000000
+                ? 0 : 1 + (int)(random.below(20000) * random.below(20000) / 20000);
+            Song* song = new Song("Track " + to_string(i), "Artist " + to_string(artist), "/music/" + to_string(i) + ".wav");
+            song->setRating((int)random.below(6));
+            for (int plays = (int)(random.below(100) * random.below(100) / 100); plays > 0; plays--) {
+                song->incrementPlayCount();
+            }
+            playlist->addSongToPlaylist(song);
+        }
+        return playlist;
+    }
+
+    struct Pass {
+        double loadMillis;
+        double firstSongsMicros;   // load plus the first 20 songs, as when playlists are switched often
+        double nanosPerNext;
+        vector<Song*> order;
+    };
+
+    static Pass timePass(PlayStrategy* strategy, Playlist* playlist) {
+        Pass pass;
+        auto start = chrono::steady_clock::now();
+        strategy->setPlaylist(playlist);
+        pass.loadMillis = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        pass.order.reserve(playlist->getSize());
+        start = chrono::steady_clock::now();
+        while (strategy->hasNext()) {
+            pass.order.push_back(strategy->next());
+        }
+        pass.nanosPerNext = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / playlist->getSize();
+
+        start = chrono::steady_clock::now();
+        strategy->setPlaylist(playlist);
+        for (int i = 0; i < 20; i++) {
+            strategy->next();
+        }
+        pass.firstSongsMicros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+        return pass;
+    }
+
+    static bool playsEverySongOnce(const Pass& pass, Playlist* playlist) {
+        vector<Song*> played = pass.order;
+        vector<Song*> all = playlist->getSongs();
+        sort(played.begin(), played.end());
+        sort(all.begin(), all.end());
+        return played == all;
+    }
+
+    static long long sameArtistPairs(const Pass& pass) {
+        long long pairs = 0;
+        for (size_t i = 1; i < pass.order.size(); i++) {
+            pairs += pass.order[i]->getArtist() == pass.order[i - 1]->getArtist();
+        }
+        return pairs;
+    }
+
+    // Mean of a song property over the first 1% played against the playlist mean
+    template <typename Property>
+    static void printEarlyBias(const string& label, const Pass& pass, Property property) {
+        double early = 0, all = 0;
+        size_t earlyCount = pass.order.size() / 100;
+        for (size_t i = 0; i < pass.order.size(); i++) {
+            all += property(pass.order[i]);
+            if (i < earlyCount) {
+                early += property(pass.order[i]);
+            }
+        }
+        cout << "    mean " << label << " of the first 1% played: " << early / earlyCount << " (playlist "
+             << all / pass.order.size() << ")\n";
+    }
+
+    static void printPass(const string& label, const Pass& pass, Playlist* playlist) {
+        cout << "  " << label << ": load " << pass.loadMillis << " ms, load + 20 songs " << pass.firstSongsMicros
+             << " us, next() " << pass.nanosPerNext << " ns, every song once: "
+             << (playsEverySongOnce(pass, playlist) ? "yes" : "NO") << ", same-artist neighbours "
+             << sameArtistPairs(pass) << "\n";
+    }
+
+public:
+    static void run() {
+        const int size = 1000000;
+        FastRandom random(7);
+        srand(7);
+        auto rating = [](Song* song) { return song->getRating() == 0 ? 3 : song->getRating(); };
+        auto plays = [](Song* song) { return song->getPlayCount(); };
+
+        for (double dominantShare : {0.0, 0.6}) {
+            Playlist* playlist = buildPlaylist(size, dominantShare, random);
+            cout << "=== SHUFFLE: " << size << " songs, "
+                 << (dominantShare > 0 ? "one artist has 60% of them" : "20000 artists, skewed") << " ===\n";
+
+            CopyingRandomStrategy copying;
+            printPass("copy + rand() (before)", timePass(&copying, playlist), playlist);
+            RandomPlayStrategy uniform(1);
+            Pass uniformPass = timePass(&uniform, playlist);
+            printPass("uniform, lazy Fisher-Yates", uniformPass, playlist);
+            ArtistSpreadShuffleStrategy spread(1);
+            Pass spreadPass = timePass(&spread, playlist);
+            printPass("artist spread", spreadPass, playlist);
+            if (dominantShare > 0) {
+                long long dominant = 0;
+                for (Song* song : playlist->getSongs()) {
+                    dominant += song->getArtist() == "Artist 0";
+                }
+                cout << "    fewest same-artist neighbours possible: " << max(0LL, 2 * dominant - size - 1) << "\n";
+                continue;
+            }
+            WeightedShuffleStrategy byPlays(ShuffleWeight::PLAY_COUNT, 1);
+            Pass playsPass = timePass(&byPlays, playlist);
+            printPass("weighted by play count", playsPass, playlist);
+            printEarlyBias("play count", playsPass, plays);
+            WeightedShuffleStrategy byRating(ShuffleWeight::RATING, 1);
+            Pass ratingPass = timePass(&byRating, playlist);
+            printPass("weighted by rating", ratingPass, playlist);
+            printEarlyBias("rating", ratingPass, rating);
+            printEarlyBias("rating (uniform shuffle)", uniformPass, rating);
+        }
+    }
+};
\ No newline at end of file
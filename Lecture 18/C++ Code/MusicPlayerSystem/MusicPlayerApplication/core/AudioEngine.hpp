@@ -1,6 +1,8 @@
 #pragma once
 #include "../models/Song.hpp"
 #include "../device/IAudioOutputDevice.hpp"
+#include "../strategies/PlayStrategy.hpp"
+#include "PlaybackPipeline.hpp"
 #include<string>
 #include<iostream>
 
@@ -10,10 +12,12 @@ class AudioEngine {
 private:
     Song* currentSong;
     bool songIsPaused;
+    PlaybackPipeline* stream;
 public:
     AudioEngine() {
         currentSong = nullptr;
         songIsPaused = false;
+        stream = nullptr;
     }
     string getCurrentSongTitle() const {
         if (currentSong) {
@@ -38,6 +42,7 @@ public:
 
         currentSong = song;
         songIsPaused = false;
+        song->incrementPlayCount();
         cout << "Playing song: " << song->getTitle() << "\n";
         aod->playAudio(song);
     }
@@ -52,4 +57,31 @@ public:
         songIsPaused = true;
         cout << "Pausing song: " << currentSong->getTitle() << "\n";
     }
+
+    // Decodes and plays, gaplessly, every track the strategy yields; the
+    // device receives PCM through writeFrames(). Returns immediately.
+    void startStream(IAudioOutputDevice* aod, PlayStrategy* strategy, int sampleRate = 44100) {
+        stopStream();
+        stream = new PlaybackPipeline(aod, strategy, sampleRate);
+        stream->setTrackListener([](Song* song) {
+            song->incrementPlayCount();
+            cout << "Playing song: " << song->getTitle() << "\n";
+        });
+        stream->start();
+    }
+
+    void waitForStream() {
+        if (stream) {
+            stream->wait();
+        }
+    }
+
+    void stopStream() {
+        delete stream;
+        stream = nullptr;
+    }
+
+    PlaybackPipeline* getStream() {
+        return stream;
+    }
 };
\ No newline at end of file
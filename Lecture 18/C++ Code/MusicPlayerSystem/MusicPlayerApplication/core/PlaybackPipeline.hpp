@@ -0,0 +1,282 @@
+#pragma once
+#include<iostream>
+#include<vector>
+#include<deque>
+#include<thread>
+#include<mutex>
+#include<atomic>
+#include<chrono>
+#include<functional>
+#include<ctime>
+#include "../models/Song.hpp"
+#include "../strategies/PlayStrategy.hpp"
+#include "../device/IAudioOutputDevice.hpp"
+#include "../dsp/Crossfade.hpp"
+#include "../dsp/GainStage.hpp"
+#include "TrackReader.hpp"
+#include "SpscRingBuffer.hpp"
+
+using namespace std;
+
+// Decoder thread -> lock-free ring -> output thread -> device.
+//
+// The decoder pulls tracks from the PlayStrategy, and as soon as a track
+// starts it already asks the strategy for the following one and maps it,
+// so its pages are being read while the current track decodes. Tracks are
+// written back to back into the same ring, which makes transitions
+// gapless: the output thread never sees a track boundary, only samples.
+// Boundaries travel separately (frame position + song) so the output
+// thread can report which song is audible.
+//
+// DSP: tracks at another sample rate are resampled by their TrackReader,
+// an optional crossfade overlaps the end of one track with the start of
+// the next (both are decoded at once), and the output thread applies the
+// device gain just before handing frames over.
+//
+// The strategy is driven from the decoder thread while the pipeline runs.
+class PlaybackPipeline {
+private:
+    IAudioOutputDevice* device;
+    PlayStrategy* strategy;
+    int sampleRate;
+    size_t periodFrames;
+    size_t crossfadeFrames;   // 0 = gapless
+    SpscRingBuffer<float> ring;
+    GainStage deviceGain;
+
+    thread decoderThread;
+    thread outputThread;
+    atomic<bool> decoderDone;
+    atomic<bool> stopping;
+
+    mutex boundaryLock;
+    deque<pair<size_t, Song*>> trackStarts;   // decoded frame index -> song
+    function<void(Song*)> trackListener;
+
+    atomic<size_t> framesPlayed;
+    atomic<size_t> underruns;
+    atomic<size_t> tracksStarted;
+    atomic<long long> decoderCpuNanos;
+    atomic<long long> outputCpuNanos;
+
+    static long long threadCpuNanos() {
+        timespec now;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        return now.tv_sec * 1000000000LL + now.tv_nsec;
+    }
+
+    // Next track from the strategy that can actually be decoded
+    TrackReader* openNext() {
+        while (!stopping && strategy->hasNext()) {
+            Song* song = strategy->next();
+            try {
+                TrackReader* reader = new TrackReader(song, sampleRate, periodFrames);
+                reader->prefetch();
+                return reader;
+            } catch (const exception& error) {
+                cout << "Skipping " << song->getTitle() << ": " << error.what() << "\n";
+            }
+        }
+        return nullptr;
+    }
+
+    void markTrackStart(size_t frame, Song* song) {
+        lock_guard<mutex> lock(boundaryLock);
+        trackStarts.push_back({frame, song});
+    }
+
+    void push(const float* samples, size_t count) {
+        size_t done = 0;
+        while (done < count && !stopping) {
+            done += ring.write(samples + done, count - done);
+            if (done < count) {
+                this_thread::sleep_for(chrono::microseconds(500));
+            }
+        }
+    }
+
+    void decodeLoop() {
+        vector<float> chunk(periodFrames * 2);
+        vector<float> incoming(periodFrames * 2);
+        vector<float> mixed(periodFrames * 2);
+        size_t framesDecoded = 0;
+        TrackReader* current = openNext();
+        if (current) {
+            markTrackStart(0, current->getSong());
+        }
+        TrackReader* upcoming = current ? openNext() : nullptr;
+        Crossfade* fade = nullptr;
+
+        while (current && !stopping) {
+            size_t frames = current->read(chunk.data(), periodFrames);
+            size_t left = frames + current->remainingFrames();
+            if (!fade && upcoming && crossfadeFrames > 0 && left <= crossfadeFrames) {
+                fade = new Crossfade(left);
+                markTrackStart(framesDecoded, upcoming->getSong());
+            }
+
+            if (fade) {
+                // Either track may end partway through the chunk
+                fill(chunk.begin() + 2 * frames, chunk.end(), 0.0f);
+                size_t incomingFrames = upcoming->read(incoming.data(), periodFrames);
+                fill(incoming.begin() + 2 * incomingFrames, incoming.end(), 0.0f);
+                frames = max(frames, incomingFrames);
+                fade->mix(mixed.data(), chunk.data(), incoming.data(), frames);
+                push(mixed.data(), frames * 2);
+            } else {
+                push(chunk.data(), frames * 2);
+            }
+            framesDecoded += frames;
+
+            if (current->finished()) {
+                delete current;
+                if (fade) {
+                    delete fade;
+                    fade = nullptr;
+                } else if (upcoming) {
+                    markTrackStart(framesDecoded, upcoming->getSong());
+                }
+                current = upcoming;
+                upcoming = current ? openNext() : nullptr;
+            }
+        }
+        delete fade;
+        delete current;
+        delete upcoming;
+        decoderCpuNanos = threadCpuNanos();
+        decoderDone.store(true, memory_order_release);
+    }
+
+    void announceTracks(size_t consumedUpTo) {
+        while (true) {
+            Song* song;
+            {
+                lock_guard<mutex> lock(boundaryLock);
+                if (trackStarts.empty() || trackStarts.front().first >= consumedUpTo) {
+                    return;
+                }
+                song = trackStarts.front().second;
+                trackStarts.pop_front();
+            }
+            tracksStarted++;
+            if (trackListener) {
+                trackListener(song);
+            }
+        }
+    }
+
+    void outputLoop() {
+        const size_t periodSamples = periodFrames * 2;
+        vector<float> period(periodSamples);
+        bool clocked = device->isClocked();
+        size_t consumed = 0;   // frames taken from the ring, excluding padding
+
+        // Prebuffer half the ring so playback does not start on an underrun
+        while (!stopping && !decoderDone.load(memory_order_acquire) && ring.size() < ring.capacity() / 2) {
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+        device->openStream(sampleRate);
+        while (!stopping) {
+            size_t got = ring.read(period.data(), periodSamples);
+            size_t padding = 0;
+            while (got < periodSamples) {
+                bool finished = decoderDone.load(memory_order_acquire);
+                got += ring.read(period.data() + got, periodSamples - got);
+                if (finished || got == periodSamples) {
+                    break;
+                }
+                if (clocked) {
+                    // The device will not wait: fill the gap with silence
+                    underruns++;
+                    fill(period.begin() + got, period.end(), 0.0f);
+                    padding = periodSamples - got;
+                    got = periodSamples;
+                    break;
+                }
+                this_thread::sleep_for(chrono::microseconds(200));
+            }
+            if (got == 0) {
+                break;
+            }
+            size_t frames = got / 2;
+            consumed += frames - padding / 2;
+            announceTracks(consumed);
+            deviceGain.process(period.data(), frames);
+            device->writeFrames(period.data(), frames);
+            framesPlayed += frames;
+        }
+        device->closeStream();
+        outputCpuNanos = threadCpuNanos();
+    }
+
+public:
+    PlaybackPipeline(IAudioOutputDevice* device, PlayStrategy* strategy, int sampleRate = 44100,
+                     size_t periodFrames = 512, size_t ringFrames = 32768)
+        : ring(ringFrames * 2) {
+        this->device = device;
+        this->strategy = strategy;
+        this->sampleRate = sampleRate;
+        this->periodFrames = periodFrames;
+        crossfadeFrames = 0;
+        decoderDone = false;
+        stopping = false;
+        framesPlayed = 0;
+        underruns = 0;
+        tracksStarted = 0;
+        decoderCpuNanos = 0;
+        outputCpuNanos = 0;
+    }
+
+    ~PlaybackPipeline() {
+        stop();
+    }
+
+    // Called on the output thread when a track's first frame is played
+    void setTrackListener(function<void(Song*)> listener) {
+        trackListener = listener;
+    }
+
+    // Overlap consecutive tracks by this long instead of playing them
+    // gaplessly; set before start()
+    void setCrossfade(double seconds) {
+        crossfadeFrames = (size_t)(seconds * sampleRate);
+    }
+
+    // Volume for the device, 1.0 = unchanged; may be called while playing
+    void setDeviceGain(float gain) {
+        deviceGain.setGain(gain);
+    }
+
+    void start() {
+        decoderThread = thread(&PlaybackPipeline::decodeLoop, this);
+        outputThread = thread(&PlaybackPipeline::outputLoop, this);
+    }
+
+    // Blocks until every track the strategy yields has been played
+    void wait() {
+        if (decoderThread.joinable()) decoderThread.join();
+        if (outputThread.joinable()) outputThread.join();
+    }
+
+    void stop() {
+        stopping = true;
+        wait();
+    }
+
+    size_t getFramesPlayed() {
+        return framesPlayed;
+    }
+    size_t getUnderruns() {
+        return underruns;
+    }
+    size_t getTracksStarted() {
+        return tracksStarted;
+    }
+    int getSampleRate() {
+        return sampleRate;
+    }
+    // CPU used by both threads, valid once wait() has returned
+    double getCpuSeconds() {
+        return (decoderCpuNanos + outputCpuNanos) / 1e9;
+    }
+};
\ No newline at end of file
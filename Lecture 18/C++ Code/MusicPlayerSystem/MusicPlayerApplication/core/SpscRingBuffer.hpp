@@ -0,0 +1,73 @@
+#pragma once
+#include<atomic>
+#include<vector>
+#include<cstring>
+#include<algorithm>
+
+using namespace std;
+
+// Single-producer/single-consumer ring of samples. The producer only writes
+// tail and the consumer only writes head, so neither side ever blocks or
+// takes a lock; each side caches the other's index and reloads it only when
+// the ring looks full (or empty). Capacity is rounded up to a power of two.
+template <typename T>
+class SpscRingBuffer {
+private:
+    vector<T> items;
+    size_t mask;
+    alignas(64) atomic<size_t> head;   // next item to read, owned by consumer
+    size_t cachedTail;
+    alignas(64) atomic<size_t> tail;   // next item to write, owned by producer
+    size_t cachedHead;
+
+public:
+    SpscRingBuffer(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        items.resize(size);
+        mask = size - 1;
+        head = 0;
+        tail = 0;
+        cachedTail = 0;
+        cachedHead = 0;
+    }
+
+    // Producer side; copies as many items as fit and returns that count
+    size_t write(const T* source, size_t count) {
+        size_t writePos = tail.load(memory_order_relaxed);
+        if (items.size() - (writePos - cachedHead) < count) {
+            cachedHead = head.load(memory_order_acquire);
+        }
+        count = min(count, items.size() - (writePos - cachedHead));
+        size_t first = min(count, items.size() - (writePos & mask));
+        memcpy(&items[writePos & mask], source, first * sizeof(T));
+        memcpy(&items[0], source + first, (count - first) * sizeof(T));
+        tail.store(writePos + count, memory_order_release);
+        return count;
+    }
+
+    // Consumer side; copies up to count items out and returns how many
+    size_t read(T* destination, size_t count) {
+        size_t readPos = head.load(memory_order_relaxed);
+        if (cachedTail - readPos < count) {
+            cachedTail = tail.load(memory_order_acquire);
+        }
+        count = min(count, cachedTail - readPos);
+        size_t first = min(count, items.size() - (readPos & mask));
+        memcpy(destination, &items[readPos & mask], first * sizeof(T));
+        memcpy(destination + first, &items[0], (count - first) * sizeof(T));
+        head.store(readPos + count, memory_order_release);
+        return count;
+    }
+
+    // Approximate when called from a third thread
+    size_t size() const {
+        return tail.load(memory_order_acquire) - head.load(memory_order_acquire);
+    }
+
+    size_t capacity() const {
+        return items.size();
+    }
+};
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+#include<vector>
+#include<string>
+#include "../models/Song.hpp"
+#include "../dsp/Resampler.hpp"
+#include "WavDecoder.hpp"
+
+using namespace std;
+
+// One track on its way into the pipeline: decodes the song's file and, if
+// its sample rate differs from the output, converts it on the fly.
+class TrackReader {
+private:
+    Song* song;
+    WavDecoder* decoder;
+    Resampler* resampler;
+    vector<float> raw;
+    bool flushed;
+    bool done;
+
+public:
+    // Throws if the file cannot be opened or decoded
+    TrackReader(Song* song, int outputRate, size_t chunkFrames) {
+        this->song = song;
+        decoder = new WavDecoder(song->getFilePath());
+        resampler = nullptr;
+        if (decoder->getSampleRate() != outputRate) {
+            resampler = new Resampler(decoder->getSampleRate(), outputRate);
+            raw.resize(2 * chunkFrames);
+        }
+        flushed = false;
+        done = false;
+    }
+
+    ~TrackReader() {
+        delete resampler;
+        delete decoder;
+    }
+
+    void prefetch() {
+        decoder->prefetch();
+    }
+
+    // Fills up to frames output frames; fewer means the track has ended
+    size_t read(float* out, size_t frames) {
+        if (done) {
+            return 0;
+        }
+        size_t produced;
+        if (!resampler) {
+            produced = decoder->decode(out, frames);
+        } else {
+            produced = resampler->drain(out, frames);
+            while (produced < frames) {
+                if (decoder->finished()) {
+                    if (flushed) {
+                        break;
+                    }
+                    resampler->finish();
+                    flushed = true;
+                } else {
+                    resampler->push(raw.data(), decoder->decode(raw.data(), raw.size() / 2));
+                }
+                produced += resampler->drain(out + 2 * produced, frames - produced);
+            }
+        }
+        done = produced < frames;
+        return produced;
+    }
+
+    // Output frames left, exact without resampling and within a frame or
+    // two with it
+    size_t remainingFrames() {
+        if (done) {
+            return 0;
+        }
+        size_t undecoded = decoder->getTotalFrames() - decoder->getPosition();
+        if (!resampler) {
+            return undecoded;
+        }
+        return (size_t)(undecoded * resampler->getRatio()) + resampler->bufferedOutputFrames();
+    }
+
+    bool finished() {
+        return done;
+    }
+
+    Song* getSong() {
+        return song;
+    }
+
+    int getSourceRate() {
+        return decoder->getSampleRate();
+    }
+};
\ No newline at end of file
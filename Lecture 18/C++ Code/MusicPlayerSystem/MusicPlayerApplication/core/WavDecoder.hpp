@@ -0,0 +1,192 @@
+#pragma once
+#include<string>
+#include<cstdint>
+#include<cstring>
+#include<stdexcept>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+
+using namespace std;
+
+// Reads a RIFF/WAVE file straight out of an mmap'd view and converts it to
+// interleaved stereo float frames in [-1, 1]. Handles 16/24/32-bit integer
+// and 32-bit float PCM; mono is duplicated to both channels and channels
+// beyond the second are dropped.
+class WavDecoder {
+public:
+    // Outside this range the header is taken to be corrupt
+    static const uint32_t MIN_SAMPLE_RATE = 1000;
+    static const uint32_t MAX_SAMPLE_RATE = 768000;
+
+private:
+    int fd;
+    const uint8_t* mapped;
+    size_t mappedBytes;
+    const uint8_t* data;
+    size_t totalFrames;
+    size_t position;
+    int channels;
+    int sampleRate;
+    int bitsPerSample;
+    bool isFloat;
+
+    static uint32_t read32(const uint8_t* p) {
+        uint32_t value;
+        memcpy(&value, p, 4);
+        return value;
+    }
+    static uint16_t read16(const uint8_t* p) {
+        uint16_t value;
+        memcpy(&value, p, 2);
+        return value;
+    }
+
+    float sampleAt(const uint8_t* p) const {
+        switch (bitsPerSample) {
+            case 16: {
+                int16_t value;
+                memcpy(&value, p, 2);
+                return value * (1.0f / 32768.0f);
+            }
+            case 24: {
+                int32_t value = (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24) >> 8;
+                return value * (1.0f / 8388608.0f);
+            }
+            default: {
+                if (isFloat) {
+                    float value;
+                    memcpy(&value, p, 4);
+                    return value;
+                }
+                int32_t value;
+                memcpy(&value, p, 4);
+                return value * (1.0f / 2147483648.0f);
+            }
+        }
+    }
+
+    void parse(const string& path) {
+        if (mappedBytes < 12 || memcmp(mapped, "RIFF", 4) != 0 || memcmp(mapped + 8, "WAVE", 4) != 0) {
+            throw runtime_error("\"" + path + "\" is not a WAV file.");
+        }
+        bool haveFormat = false;
+        size_t offset = 12;
+        while (offset + 8 <= mappedBytes) {
+            uint32_t chunkSize = read32(mapped + offset + 4);
+            const uint8_t* body = mapped + offset + 8;
+            size_t bodyBytes = min((size_t)chunkSize, mappedBytes - offset - 8);
+            if (memcmp(mapped + offset, "fmt ", 4) == 0 && bodyBytes >= 16) {
+                uint16_t format = read16(body);
+                channels = read16(body + 2);
+                sampleRate = read32(body + 4);
+                bitsPerSample = read16(body + 14);
+                if (format == 0xFFFE && bodyBytes >= 26) {   // WAVE_FORMAT_EXTENSIBLE
+                    format = read16(body + 24);
+                }
+                isFloat = format == 3;
+                uint32_t rate = read32(body + 4);
+                if (rate < MIN_SAMPLE_RATE || rate > MAX_SAMPLE_RATE) {
+                    throw runtime_error("\"" + path + "\" has an invalid sample rate (" + to_string(rate) + " Hz).");
+                }
+                if ((format != 1 && format != 3) || channels < 1
+                    || !(bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32)
+                    || (isFloat && bitsPerSample != 32)) {
+                    throw runtime_error("\"" + path + "\" uses an unsupported WAV encoding.");
+                }
+                haveFormat = true;
+            } else if (memcmp(mapped + offset, "data", 4) == 0 && haveFormat) {
+                data = body;
+                totalFrames = bodyBytes / (channels * (bitsPerSample / 8));
+                return;
+            }
+            offset += 8 + chunkSize + (chunkSize & 1);
+        }
+        throw runtime_error("\"" + path + "\" has no audio data.");
+    }
+
+public:
+    WavDecoder(const string& path) {
+        fd = -1;
+        mapped = nullptr;
+        mappedBytes = 0;
+        data = nullptr;
+        totalFrames = 0;
+        position = 0;
+        channels = sampleRate = bitsPerSample = 0;
+        isFloat = false;
+
+        fd = open(path.c_str(), O_RDONLY);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) != 0 || info.st_size == 0) {
+            if (fd >= 0) close(fd);
+            throw runtime_error("Cannot open \"" + path + "\".");
+        }
+        mappedBytes = info.st_size;
+        void* view = mmap(nullptr, mappedBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            close(fd);
+            throw runtime_error("Cannot map \"" + path + "\".");
+        }
+        mapped = (const uint8_t*)view;
+        try {
+            parse(path);
+        } catch (...) {
+            munmap(view, mappedBytes);
+            close(fd);
+            throw;
+        }
+    }
+
+    ~WavDecoder() {
+        munmap((void*)mapped, mappedBytes);
+        close(fd);
+    }
+
+    // Asks the kernel to start reading the file in the background, so the
+    // first decode() after a track change does not wait on the disk.
+    void prefetch() {
+        madvise((void*)mapped, mappedBytes, MADV_WILLNEED);
+        madvise((void*)mapped, mappedBytes, MADV_SEQUENTIAL);
+    }
+
+    // Decodes up to maxFrames stereo frames into out; returns how many
+    size_t decode(float* out, size_t maxFrames) {
+        size_t frames = min(maxFrames, totalFrames - position);
+        size_t bytesPerSample = bitsPerSample / 8;
+        size_t stride = channels * bytesPerSample;
+        const uint8_t* p = data + position * stride;
+        if (bitsPerSample == 16 && channels == 2) {
+            for (size_t i = 0; i < frames * 2; i++) {
+                int16_t value;
+                memcpy(&value, p + i * 2, 2);
+                out[i] = value * (1.0f / 32768.0f);
+            }
+        } else {
+            for (size_t i = 0; i < frames; i++, p += stride) {
+                float left = sampleAt(p);
+                out[2 * i] = left;
+                out[2 * i + 1] = channels > 1 ? sampleAt(p + bytesPerSample) : left;
+            }
+        }
+        position += frames;
+        return frames;
+    }
+
+    bool finished() const {
+        return position >= totalFrames;
+    }
+    size_t getTotalFrames() const {
+        return totalFrames;
+    }
+    size_t getPosition() const {
+        return position;
+    }
+    int getSampleRate() const {
+        return sampleRate;
+    }
+    int getChannels() const {
+        return channels;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,243 @@
+#pragma once
+#include<vector>
+#include<thread>
+#include<atomic>
+#include<chrono>
+#include<algorithm>
+#include "IAudioOutputDevice.hpp"
+#include "../core/SpscRingBuffer.hpp"
+#include "../dsp/Resampler.hpp"
+#include "../dsp/GainStage.hpp"
+
+using namespace std;
+
+struct FanOutBranchStats {
+    size_t framesPlayed;
+    size_t underruns;       // periods padded with silence
+    size_t droppedFrames;   // not accepted because the branch buffer was full
+    size_t resyncs;         // times a backlog was discarded after a stall
+    double driftPpm;        // device clock error learned by the controller
+    long long fillError;    // buffered frames minus the target
+};
+
+// Plays one decoded stream on several devices at once. The pipeline writes
+// into this device, paced by the system clock; every attached device gets
+// its own bounded ring and thread, so a device that stalls only loses its
+// own audio while the others keep playing.
+//
+// Each device's crystal runs slightly fast or slow against the system
+// clock, so its ring would slowly fill up or run dry. A PI controller on
+// the ring's fill level adjusts that branch's resampling ratio by up to 1%
+// to keep the fill at its target. Devices with less latency keep that much
+// more in their ring so all of them are heard in step, so each ring is
+// sized when the stream opens to hold the largest latency on top.
+class FanOutOutputDevice : public IAudioOutputDevice {
+private:
+    static const size_t PERIOD_FRAMES = 512;
+    static const size_t RING_FRAMES = 32768;   // plus the largest device latency
+    static const size_t TARGET_FRAMES = 4096;
+    static const size_t RESYNC_MARGIN_FRAMES = 8192;
+
+    struct Branch {
+        IAudioOutputDevice* device;
+        SpscRingBuffer<float>* ring;
+        GainStage gain;
+        thread worker;
+        atomic<size_t> framesPlayed;
+        atomic<size_t> underruns;
+        atomic<size_t> droppedFrames;
+        atomic<size_t> resyncs;
+        atomic<double> driftPpm;
+        atomic<long long> fillError;
+
+        Branch(IAudioOutputDevice* device) {
+            this->device = device;
+            ring = new SpscRingBuffer<float>(RING_FRAMES * 2);
+            framesPlayed = underruns = droppedFrames = resyncs = 0;
+            driftPpm = 0;
+            fillError = 0;
+        }
+
+        ~Branch() {
+            delete ring;
+        }
+    };
+
+    vector<Branch*> branches;
+    int sampleRate;
+    size_t framesWritten;
+    chrono::steady_clock::time_point streamStart;
+    atomic<bool> closing;
+    bool streaming;
+
+    void runBranch(Branch* branch, double maxLatencySeconds) {
+        IAudioOutputDevice* device = branch->device;
+        device->openStream(sampleRate);
+        vector<float> input(PERIOD_FRAMES * 2);
+        vector<float> output(PERIOD_FRAMES * 2, 0.0f);
+
+        // Every branch starts once the same amount is buffered; the device's
+        // own buffer then absorbs its latency and the ring keeps the rest
+        size_t deviceFrames = (size_t)(device->getLatencySeconds() * sampleRate);
+        size_t target = TARGET_FRAMES + (size_t)(maxLatencySeconds * sampleRate) - deviceFrames;
+        size_t resyncFrames = target + deviceFrames + RESYNC_MARGIN_FRAMES;
+        while (!closing && branch->ring->size() / 2 < target + deviceFrames) {
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+
+        // A device that returns without blocking (a title-only adapter) is
+        // held to the system clock instead of spinning through the stream
+        chrono::steady_clock::time_point branchStart = chrono::steady_clock::now();
+        double maxAheadSeconds = device->getLatencySeconds() + 0.25;
+        size_t framesSinceStart = 0;
+
+        Resampler resampler(sampleRate, sampleRate);
+        const double kp = 0.1, ki = 0.001, smoothing = 0.05, limit = 0.01;
+        double smoothedFill = (double)target, integral = 0;
+        while (true) {
+            size_t fill = branch->ring->size() / 2;
+            if (!closing && fill > resyncFrames) {
+                // Back from a stall with a backlog: skip to the target
+                // rather than playing late for the rest of the stream
+                for (size_t skip = fill - target; skip > 0;) {
+                    skip -= branch->ring->read(input.data(), 2 * min(skip, PERIOD_FRAMES)) / 2;
+                }
+                branch->resyncs++;
+                fill = target;
+                smoothedFill = target;
+            }
+            // Until the device's own buffer is full the ring drains by
+            // design; that is not drift and would wind the integral up
+            if (!closing && framesSinceStart >= deviceFrames) {
+                smoothedFill += smoothing * ((double)fill - smoothedFill);
+                double error = (smoothedFill - target) / TARGET_FRAMES;
+                integral = max(-limit / ki, min(limit / ki, integral + error));
+                double correction = max(-limit, min(limit, kp * error + ki * integral));
+                resampler.setStep(1.0 + correction);
+                branch->driftPpm = -ki * integral * 1e6;
+                branch->fillError = (long long)smoothedFill - (long long)target;
+            }
+
+            while (resampler.bufferedOutputFrames() < PERIOD_FRAMES) {
+                size_t got = branch->ring->read(input.data(), input.size()) / 2;
+                if (got == 0) {
+                    break;
+                }
+                resampler.push(input.data(), got);
+            }
+            size_t produced = resampler.drain(output.data(), PERIOD_FRAMES);
+            if (produced < PERIOD_FRAMES) {
+                if (closing && branch->ring->size() == 0) {
+                    resampler.finish();
+                    produced += resampler.drain(output.data() + 2 * produced, PERIOD_FRAMES - produced);
+                    branch->gain.process(output.data(), produced);
+                    device->writeFrames(output.data(), produced);
+                    branch->framesPlayed += produced;
+                    break;
+                }
+                branch->underruns++;
+                fill_n(output.begin() + 2 * produced, 2 * (PERIOD_FRAMES - produced), 0.0f);
+            }
+            branch->gain.process(output.data(), PERIOD_FRAMES);
+            device->writeFrames(output.data(), PERIOD_FRAMES);
+            branch->framesPlayed += PERIOD_FRAMES;
+            framesSinceStart += PERIOD_FRAMES;
+            this_thread::sleep_until(branchStart + chrono::microseconds(
+                (long long)(((double)framesSinceStart / sampleRate - maxAheadSeconds) * 1e6)));
+        }
+        device->closeStream();
+    }
+
+public:
+    FanOutOutputDevice() {
+        sampleRate = 44100;
+        framesWritten = 0;
+        closing = false;
+        streaming = false;
+    }
+
+    ~FanOutOutputDevice() {
+        closeStream();
+        for (Branch* branch : branches) {
+            delete branch;
+        }
+    }
+
+    // Devices are owned by the caller; add them before the stream opens
+    void addDevice(IAudioOutputDevice* device) {
+        branches.push_back(new Branch(device));
+    }
+
+    int getDeviceCount() {
+        return (int)branches.size();
+    }
+
+    void setDeviceGain(int index, float gain) {
+        branches[index]->gain.setGain(gain);
+    }
+
+    FanOutBranchStats getStats(int index) {
+        Branch* branch = branches[index];
+        return {branch->framesPlayed, branch->underruns, branch->droppedFrames, branch->resyncs,
+                branch->driftPpm, branch->fillError};
+    }
+
+    void playAudio(Song* song) override {
+        for (Branch* branch : branches) {
+            branch->device->playAudio(song);
+        }
+    }
+
+    void openStream(int sampleRate) override {
+        closeStream();
+        this->sampleRate = sampleRate;
+        framesWritten = 0;
+        closing = false;
+        streaming = true;
+        double maxLatency = 0;
+        for (Branch* branch : branches) {
+            maxLatency = max(maxLatency, branch->device->getLatencySeconds());
+        }
+        // A branch starts once TARGET_FRAMES plus the largest latency is
+        // buffered and resyncs RESYNC_MARGIN_FRAMES above that; both must
+        // stay well inside the ring or the branch never plays
+        size_t ringFrames = RING_FRAMES + (size_t)(maxLatency * sampleRate);
+        for (Branch* branch : branches) {
+            delete branch->ring;
+            branch->ring = new SpscRingBuffer<float>(ringFrames * 2);
+            branch->worker = thread(&FanOutOutputDevice::runBranch, this, branch, maxLatency);
+        }
+        streamStart = chrono::steady_clock::now();
+    }
+
+    // Never blocks on a device: frames a full branch cannot take are
+    // dropped for that branch only
+    void writeFrames(const float* samples, size_t frames) override {
+        for (Branch* branch : branches) {
+            size_t accepted = branch->ring->write(samples, frames * 2) / 2;
+            branch->droppedFrames += frames - accepted;
+        }
+        framesWritten += frames;
+        this_thread::sleep_until(streamStart + chrono::microseconds((long long)(framesWritten * 1e6 / sampleRate)));
+    }
+
+    // Lets every device play out what it has buffered, then stops
+    void closeStream() override {
+        if (!streaming) {
+            return;
+        }
+        closing = true;
+        for (Branch* branch : branches) {
+            branch->worker.join();
+        }
+        streaming = false;
+    }
+
+    double getLatencySeconds() override {
+        double maxLatency = 0;
+        for (Branch* branch : branches) {
+            maxLatency = max(maxLatency, branch->device->getLatencySeconds());
+        }
+        return maxLatency + (double)TARGET_FRAMES / sampleRate;
+    }
+};
\ No newline at end of file
@@ -1,8 +1,27 @@
 #pragma once
+#include<cstddef>
 #include "../models/Song.hpp"
 
 class IAudioOutputDevice {
 public:
     virtual ~IAudioOutputDevice() {}
     virtual void playAudio(Song* song) = 0;
+
+    // PCM path used by the PlaybackPipeline: interleaved stereo float
+    // frames. Devices that only take a title keep these no-ops.
+    virtual void openStream(int /*sampleRate*/) {}
+    virtual void writeFrames(const float* /*samples*/, size_t /*frames*/) {}
+    virtual void closeStream() {}
+
+    // A clocked device consumes audio in real time and plays silence when
+    // the pipeline falls behind; an unclocked one (a file) simply waits.
+    virtual bool isClocked() {
+        return true;
+    }
+
+    // How long written audio takes to become audible (device buffering,
+    // radio link); used to line up several devices playing together
+    virtual double getLatencySeconds() {
+        return 0;
+    }
 };
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+#include<chrono>
+#include<thread>
+#include "IAudioOutputDevice.hpp"
+
+using namespace std;
+
+// Discards PCM. When clocked it blocks like a sound card would, returning
+// only once the frames written so far would have been played.
+class NullOutputDevice : public IAudioOutputDevice {
+private:
+    bool clocked;
+    int sampleRate;
+    size_t framesWritten;
+    chrono::steady_clock::time_point streamStart;
+public:
+    NullOutputDevice(bool clocked) {
+        this->clocked = clocked;
+        sampleRate = 44100;
+        framesWritten = 0;
+    }
+
+    void playAudio(Song*) override {}
+
+    void openStream(int sampleRate) override {
+        this->sampleRate = sampleRate;
+        framesWritten = 0;
+        streamStart = chrono::steady_clock::now();
+    }
+
+    void writeFrames(const float*, size_t frames) override {
+        framesWritten += frames;
+        if (clocked) {
+            this_thread::sleep_until(streamStart + chrono::microseconds((long long)(framesWritten * 1000000.0 / sampleRate)));
+        }
+    }
+
+    bool isClocked() override {
+        return clocked;
+    }
+
+    size_t getFramesWritten() {
+        return framesWritten;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+#include<string>
+#include<chrono>
+#include<thread>
+#include "IAudioOutputDevice.hpp"
+
+using namespace std;
+
+// Stand-in for real hardware when testing multi-device output. It has its
+// own crystal (runs clockPpm fast or slow against the system clock), a
+// buffer of latencySeconds that absorbs writes before they start blocking,
+// and can freeze once for stallMs, like a Bluetooth link dropping out.
+class SimulatedOutputDevice : public IAudioOutputDevice {
+private:
+    string name;
+    double latencySeconds;
+    double clockPpm;
+    double stallAtSeconds;
+    int stallMs;
+    bool stalled;
+    int sampleRate;
+    size_t framesWritten;
+    chrono::steady_clock::time_point clockStart;
+
+    double actualRate() {
+        return sampleRate * (1.0 + clockPpm / 1e6);
+    }
+
+public:
+    SimulatedOutputDevice(const string& name, double latencySeconds, double clockPpm,
+                          double stallAtSeconds = -1, int stallMs = 0) {
+        this->name = name;
+        this->latencySeconds = latencySeconds;
+        this->clockPpm = clockPpm;
+        this->stallAtSeconds = stallAtSeconds;
+        this->stallMs = stallMs;
+        stalled = false;
+        sampleRate = 44100;
+        framesWritten = 0;
+    }
+
+    void playAudio(Song*) override {}
+
+    void openStream(int sampleRate) override {
+        this->sampleRate = sampleRate;
+        framesWritten = 0;
+        stalled = false;
+    }
+
+    void writeFrames(const float*, size_t frames) override {
+        // Playback starts with the first frames, not when the stream opens
+        if (framesWritten == 0) {
+            clockStart = chrono::steady_clock::now();
+        }
+        framesWritten += frames;
+        double played = framesWritten / actualRate();
+        if (!stalled && stallAtSeconds >= 0 && played >= stallAtSeconds) {
+            stalled = true;
+            this_thread::sleep_for(chrono::milliseconds(stallMs));
+            // Playback resumes from now; the device does not catch up
+            clockStart += chrono::milliseconds(stallMs);
+        }
+        this_thread::sleep_until(clockStart + chrono::microseconds((long long)((played - latencySeconds) * 1e6)));
+    }
+
+    double getLatencySeconds() override {
+        return latencySeconds;
+    }
+
+    string getName() {
+        return name;
+    }
+
+    double getClockPpm() {
+        return clockPpm;
+    }
+
+    size_t getFramesWritten() {
+        return framesWritten;
+    }
+};
\ No newline at end of file
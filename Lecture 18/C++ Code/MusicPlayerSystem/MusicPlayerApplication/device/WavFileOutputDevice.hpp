@@ -0,0 +1,87 @@
+#pragma once
+#include<cstdio>
+#include<cstdint>
+#include<string>
+#include<vector>
+#include<stdexcept>
+#include "IAudioOutputDevice.hpp"
+
+using namespace std;
+
+// Writes the stream to a 16-bit stereo WAV file; the header sizes are
+// filled in when the stream is closed.
+class WavFileOutputDevice : public IAudioOutputDevice {
+private:
+    string path;
+    FILE* file;
+    uint32_t sampleRate;
+    uint32_t dataBytes;
+    vector<int16_t> converted;
+
+    void writeHeader() {
+        uint32_t riffSize = 36 + dataBytes;
+        uint32_t formatSize = 16;
+        uint16_t format = 1, channels = 2, blockAlign = 4, bits = 16;
+        uint32_t byteRate = sampleRate * blockAlign;
+        fseek(file, 0, SEEK_SET);
+        fwrite("RIFF", 1, 4, file);
+        fwrite(&riffSize, 4, 1, file);
+        fwrite("WAVEfmt ", 1, 8, file);
+        fwrite(&formatSize, 4, 1, file);
+        fwrite(&format, 2, 1, file);
+        fwrite(&channels, 2, 1, file);
+        fwrite(&sampleRate, 4, 1, file);
+        fwrite(&byteRate, 4, 1, file);
+        fwrite(&blockAlign, 2, 1, file);
+        fwrite(&bits, 2, 1, file);
+        fwrite("data", 1, 4, file);
+        fwrite(&dataBytes, 4, 1, file);
+    }
+
+public:
+    WavFileOutputDevice(const string& path) {
+        this->path = path;
+        file = nullptr;
+        sampleRate = 44100;
+        dataBytes = 0;
+    }
+
+    ~WavFileOutputDevice() {
+        closeStream();
+    }
+
+    void playAudio(Song*) override {}
+
+    void openStream(int sampleRate) override {
+        closeStream();
+        file = fopen(path.c_str(), "wb");
+        if (!file) {
+            throw runtime_error("Cannot create \"" + path + "\".");
+        }
+        this->sampleRate = sampleRate;
+        dataBytes = 0;
+        writeHeader();
+    }
+
+    void writeFrames(const float* samples, size_t frames) override {
+        converted.resize(frames * 2);
+        for (size_t i = 0; i < frames * 2; i++) {
+            float value = samples[i] < -1.0f ? -1.0f : (samples[i] > 1.0f ? 1.0f : samples[i]);
+            converted[i] = (int16_t)(value * 32767.0f);
+        }
+        fwrite(converted.data(), sizeof(int16_t), converted.size(), file);
+        dataBytes += frames * 4;
+    }
+
+    void closeStream() override {
+        if (file) {
+            writeHeader();
+            fclose(file);
+            file = nullptr;
+        }
+    }
+
+    bool isClocked() override {
+        return false;
+    }
+};
\ No newline at end of file
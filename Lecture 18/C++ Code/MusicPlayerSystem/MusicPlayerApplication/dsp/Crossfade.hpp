@@ -0,0 +1,44 @@
+#pragma once
+#include<vector>
+#include<cmath>
+#include<algorithm>
+#include "DspKernels.hpp"
+
+using namespace std;
+
+// Equal-power crossfade over a fixed number of frames: the outgoing track
+// follows cos, the incoming one sin, so the combined loudness stays level
+// instead of dipping halfway as it does with straight-line fades.
+class Crossfade {
+private:
+    const DspKernelSet& kernels;
+    vector<float> fadeOut;
+    vector<float> fadeIn;
+    size_t position;
+
+public:
+    Crossfade(size_t frames, const DspKernelSet& kernels = DspKernels::active()) : kernels(kernels) {
+        frames = max(frames, (size_t)1);
+        fadeOut.resize(frames);
+        fadeIn.resize(frames);
+        for (size_t f = 0; f < frames; f++) {
+            double t = (f + 0.5) / frames * M_PI / 2;
+            fadeOut[f] = (float)cos(t);
+            fadeIn[f] = (float)sin(t);
+        }
+        position = 0;
+    }
+
+    // Mixes the next frames of both tracks into out; past the end of the
+    // fade the incoming track passes through unchanged
+    void mix(float* out, const float* from, const float* to, size_t frames) {
+        size_t fading = min(frames, fadeOut.size() - position);
+        kernels.crossfade(out, from, to, fadeOut.data() + position, fadeIn.data() + position, fading);
+        copy(to + 2 * fading, to + 2 * frames, out + 2 * fading);
+        position += fading;
+    }
+
+    bool done() const {
+        return position >= fadeOut.size();
+    }
+};
\ No newline at end of file
@@ -0,0 +1,253 @@
+#pragma once
+#include<cstddef>
+#include<cstdint>
+#include<cmath>
+#if defined(__x86_64__) || defined(__i386__)
+#include<immintrin.h>
+#define DSP_X86 1
+#endif
+
+using namespace std;
+
+enum class DspIsa {
+    SCALAR,
+    SSE,
+    AVX2
+};
+
+// One implementation of every DSP kernel. Buffers are interleaved stereo
+// floats and counts are in frames.
+//
+// Resampling positions are 32.32 fixed point (input frame << 32), so every
+// implementation computes bit-identical interpolation positions.
+struct DspKernelSet {
+    DspIsa isa;
+    const char* name;
+
+    // samples[f] *= from + step * f
+    void (*applyGain)(float* samples, size_t frames, float from, float step);
+
+    // out[f] = from[f] * fadeOut[f] + to[f] * fadeIn[f]
+    void (*crossfade)(float* out, const float* from, const float* to,
+                      const float* fadeOut, const float* fadeIn, size_t frames);
+
+    // Catmull-Rom interpolation of in at position, position + step, ...
+    // Stops at maxOut outputs or when frame (position >> 32) + 2 is not
+    // available; position must be at least one frame in. Returns outputs.
+    size_t (*resample)(const float* in, size_t inFrames, float* out, size_t maxOut,
+                       uint64_t& position, uint64_t step);
+};
+
+// The x86 versions are compiled with target attributes, so the binary needs
+// no -mavx2 and still runs on machines without it; active() picks the best
+// set the CPU supports.
+class DspKernels {
+private:
+    static float catmullRom(float xm1, float x0, float x1, float x2, float f) {
+        float c1 = 0.5f * (x1 - xm1);
+        float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+        float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+        return ((c3 * f + c2) * f + c1) * f + x0;
+    }
+
+    static float fraction(uint64_t position) {
+        return (float)(uint32_t)((position & 0xFFFFFFFFu) >> 8) * (1.0f / 16777216.0f);
+    }
+
+    static void applyGainScalar(float* samples, size_t frames, float from, float step) {
+        for (size_t f = 0; f < frames; f++) {
+            float gain = from + step * (float)(int)f;
+            samples[2 * f] *= gain;
+            samples[2 * f + 1] *= gain;
+        }
+    }
+
+    static void crossfadeScalar(float* out, const float* from, const float* to,
+                                const float* fadeOut, const float* fadeIn, size_t frames) {
+        for (size_t f = 0; f < frames; f++) {
+            out[2 * f] = from[2 * f] * fadeOut[f] + to[2 * f] * fadeIn[f];
+            out[2 * f + 1] = from[2 * f + 1] * fadeOut[f] + to[2 * f + 1] * fadeIn[f];
+        }
+    }
+
+    static size_t resampleScalar(const float* in, size_t inFrames, float* out, size_t maxOut,
+                                 uint64_t& position, uint64_t step) {
+        size_t produced = 0;
+        while (produced < maxOut && (position >> 32) + 2 < inFrames) {
+            const float* p = in + 2 * (position >> 32);
+            float f = fraction(position);
+            out[2 * produced] = catmullRom(p[-2], p[0], p[2], p[4], f);
+            out[2 * produced + 1] = catmullRom(p[-1], p[1], p[3], p[5], f);
+            produced++;
+            position += step;
+        }
+        return produced;
+    }
+
+#ifdef DSP_X86
+    __attribute__((target("sse2")))
+    static __m128 catmullRomSse(__m128 xm1, __m128 x0, __m128 x1, __m128 x2, __m128 f) {
+        __m128 c1 = _mm_mul_ps(_mm_set1_ps(0.5f), _mm_sub_ps(x1, xm1));
+        __m128 c2 = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(xm1, _mm_mul_ps(_mm_set1_ps(2.5f), x0)),
+                                          _mm_mul_ps(_mm_set1_ps(2.0f), x1)),
+                               _mm_mul_ps(_mm_set1_ps(0.5f), x2));
+        __m128 c3 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.5f), _mm_sub_ps(x2, xm1)),
+                               _mm_mul_ps(_mm_set1_ps(1.5f), _mm_sub_ps(x0, x1)));
+        return _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(c3, f), c2), f), c1), f), x0);
+    }
+
+    // Two frames (four samples) per step
+    __attribute__((target("sse2")))
+    static void applyGainSse(float* samples, size_t frames, float from, float step) {
+        size_t f = 0;
+        for (; f + 2 <= frames; f += 2) {
+            __m128 index = _mm_cvtepi32_ps(_mm_setr_epi32((int)f, (int)f, (int)f + 1, (int)f + 1));
+            __m128 gain = _mm_add_ps(_mm_set1_ps(from), _mm_mul_ps(_mm_set1_ps(step), index));
+            _mm_storeu_ps(samples + 2 * f, _mm_mul_ps(_mm_loadu_ps(samples + 2 * f), gain));
+        }
+        for (; f < frames; f++) {
+            float gain = from + step * (float)(int)f;
+            samples[2 * f] *= gain;
+            samples[2 * f + 1] *= gain;
+        }
+    }
+
+    __attribute__((target("sse2")))
+    static void crossfadeSse(float* out, const float* from, const float* to,
+                             const float* fadeOut, const float* fadeIn, size_t frames) {
+        size_t f = 0;
+        for (; f + 2 <= frames; f += 2) {
+            __m128 gainOut = _mm_setr_ps(fadeOut[f], fadeOut[f], fadeOut[f + 1], fadeOut[f + 1]);
+            __m128 gainIn = _mm_setr_ps(fadeIn[f], fadeIn[f], fadeIn[f + 1], fadeIn[f + 1]);
+            __m128 mixed = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(from + 2 * f), gainOut),
+                                      _mm_mul_ps(_mm_loadu_ps(to + 2 * f), gainIn));
+            _mm_storeu_ps(out + 2 * f, mixed);
+        }
+        crossfadeScalar(out + 2 * f, from + 2 * f, to + 2 * f, fadeOut + f, fadeIn + f, frames - f);
+    }
+
+    __attribute__((target("sse2")))
+    static __m128 loadFramePair(const float* first, const float* second) {
+        return _mm_castpd_ps(_mm_loadh_pd(_mm_load_sd((const double*)first), (const double*)second));
+    }
+
+    __attribute__((target("sse2")))
+    static size_t resampleSse(const float* in, size_t inFrames, float* out, size_t maxOut,
+                              uint64_t& position, uint64_t step) {
+        size_t produced = 0;
+        while (produced + 2 <= maxOut && ((position + step) >> 32) + 2 < inFrames) {
+            const float* p0 = in + 2 * (position >> 32);
+            const float* p1 = in + 2 * ((position + step) >> 32);
+            float f0 = fraction(position), f1 = fraction(position + step);
+            __m128 y = catmullRomSse(loadFramePair(p0 - 2, p1 - 2), loadFramePair(p0, p1),
+                                     loadFramePair(p0 + 2, p1 + 2), loadFramePair(p0 + 4, p1 + 4),
+                                     _mm_setr_ps(f0, f0, f1, f1));
+            _mm_storeu_ps(out + 2 * produced, y);
+            produced += 2;
+            position += 2 * step;
+        }
+        return produced + resampleScalar(in, inFrames, out + 2 * produced, maxOut - produced, position, step);
+    }
+
+    __attribute__((target("avx2")))
+    static __m256 catmullRomAvx2(__m256 xm1, __m256 x0, __m256 x1, __m256 x2, __m256 f) {
+        __m256 c1 = _mm256_mul_ps(_mm256_set1_ps(0.5f), _mm256_sub_ps(x1, xm1));
+        __m256 c2 = _mm256_sub_ps(_mm256_add_ps(_mm256_sub_ps(xm1, _mm256_mul_ps(_mm256_set1_ps(2.5f), x0)),
+                                                _mm256_mul_ps(_mm256_set1_ps(2.0f), x1)),
+                                  _mm256_mul_ps(_mm256_set1_ps(0.5f), x2));
+        __m256 c3 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), _mm256_sub_ps(x2, xm1)),
+                                  _mm256_mul_ps(_mm256_set1_ps(1.5f), _mm256_sub_ps(x0, x1)));
+        return _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(
+                   _mm256_mul_ps(c3, f), c2), f), c1), f), x0);
+    }
+
+    // Four frames (eight samples) per step
+    __attribute__((target("avx2")))
+    static void applyGainAvx2(float* samples, size_t frames, float from, float step) {
+        const __m256i pairs = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+        size_t f = 0;
+        for (; f + 4 <= frames; f += 4) {
+            __m256 index = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32((int)f), pairs));
+            __m256 gain = _mm256_add_ps(_mm256_set1_ps(from), _mm256_mul_ps(_mm256_set1_ps(step), index));
+            _mm256_storeu_ps(samples + 2 * f, _mm256_mul_ps(_mm256_loadu_ps(samples + 2 * f), gain));
+        }
+        for (; f < frames; f++) {
+            float gain = from + step * (float)(int)f;
+            samples[2 * f] *= gain;
+            samples[2 * f + 1] *= gain;
+        }
+    }
+
+    __attribute__((target("avx2")))
+    static void crossfadeAvx2(float* out, const float* from, const float* to,
+                              const float* fadeOut, const float* fadeIn, size_t frames) {
+        const __m256i pairs = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+        size_t f = 0;
+        for (; f + 4 <= frames; f += 4) {
+            __m256 gainOut = _mm256_permutevar8x32_ps(_mm256_castps128_ps256(_mm_loadu_ps(fadeOut + f)), pairs);
+            __m256 gainIn = _mm256_permutevar8x32_ps(_mm256_castps128_ps256(_mm_loadu_ps(fadeIn + f)), pairs);
+            __m256 mixed = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(from + 2 * f), gainOut),
+                                         _mm256_mul_ps(_mm256_loadu_ps(to + 2 * f), gainIn));
+            _mm256_storeu_ps(out + 2 * f, mixed);
+        }
+        crossfadeScalar(out + 2 * f, from + 2 * f, to + 2 * f, fadeOut + f, fadeIn + f, frames - f);
+    }
+
+    // Positions of four frames are computed in 64-bit lanes, split into
+    // sample indices and 24-bit fractions, and the four taps are gathered.
+    __attribute__((target("avx2")))
+    static size_t resampleAvx2(const float* in, size_t inFrames, float* out, size_t maxOut,
+                               uint64_t& position, uint64_t step) {
+        const __m256i laneOffsets = _mm256_setr_epi64x(0, step, 2 * step, 3 * step);
+        const __m256i lowHalves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+        const __m256i pairs = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+        const __m256i channels = _mm256_setr_epi32(0, 1, 0, 1, 0, 1, 0, 1);
+        const __m256 fractionScale = _mm256_set1_ps(1.0f / 16777216.0f);
+        size_t produced = 0;
+        while (produced + 4 <= maxOut && ((position + 3 * step) >> 32) + 2 < inFrames) {
+            __m256i positions = _mm256_add_epi64(_mm256_set1_epi64x(position), laneOffsets);
+            __m256i frames = _mm256_permutevar8x32_epi32(_mm256_srli_epi64(positions, 32), lowHalves);
+            __m256i fractions = _mm256_permutevar8x32_epi32(_mm256_srli_epi64(_mm256_slli_epi64(positions, 32), 40), lowHalves);
+            __m256i index = _mm256_add_epi32(_mm256_slli_epi32(_mm256_permutevar8x32_epi32(frames, pairs), 1), channels);
+            __m256 f = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_permutevar8x32_epi32(fractions, pairs)), fractionScale);
+            __m256 y = catmullRomAvx2(_mm256_i32gather_ps(in - 2, index, 4), _mm256_i32gather_ps(in, index, 4),
+                                      _mm256_i32gather_ps(in + 2, index, 4), _mm256_i32gather_ps(in + 4, index, 4), f);
+            _mm256_storeu_ps(out + 2 * produced, y);
+            produced += 4;
+            position += 4 * step;
+        }
+        return produced + resampleScalar(in, inFrames, out + 2 * produced, maxOut - produced, position, step);
+    }
+#endif
+
+public:
+    static bool supported(DspIsa isa) {
+#ifdef DSP_X86
+        if (isa == DspIsa::AVX2) {
+            return __builtin_cpu_supports("avx2");
+        }
+        return isa == DspIsa::SCALAR || __builtin_cpu_supports("sse2");
+#else
+        return isa == DspIsa::SCALAR;
+#endif
+    }
+
+    static DspKernelSet get(DspIsa isa) {
+#ifdef DSP_X86
+        if (isa == DspIsa::AVX2) {
+            return {DspIsa::AVX2, "AVX2", applyGainAvx2, crossfadeAvx2, resampleAvx2};
+        }
+        if (isa == DspIsa::SSE) {
+            return {DspIsa::SSE, "SSE", applyGainSse, crossfadeSse, resampleSse};
+        }
+#endif
+        return {DspIsa::SCALAR, "scalar", applyGainScalar, crossfadeScalar, resampleScalar};
+    }
+
+    // Best set this CPU supports, chosen once
+    static const DspKernelSet& active() {
+        static const DspKernelSet best = get(supported(DspIsa::AVX2) ? DspIsa::AVX2
+                                             : supported(DspIsa::SSE) ? DspIsa::SSE : DspIsa::SCALAR);
+        return best;
+    }
+};
\ No newline at end of file
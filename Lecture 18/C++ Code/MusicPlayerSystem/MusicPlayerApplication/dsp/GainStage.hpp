@@ -0,0 +1,38 @@
+#pragma once
+#include<atomic>
+#include "DspKernels.hpp"
+
+using namespace std;
+
+// Per-device volume. A new setting is reached with a ramp across the next
+// buffer rather than a jump, which would click.
+class GainStage {
+private:
+    const DspKernelSet& kernels;
+    atomic<float> target;
+    float current;
+
+public:
+    GainStage(float gain = 1.0f, const DspKernelSet& kernels = DspKernels::active()) : kernels(kernels) {
+        target = gain;
+        current = gain;
+    }
+
+    // Safe to call from any thread
+    void setGain(float gain) {
+        target = gain;
+    }
+
+    float getGain() {
+        return target;
+    }
+
+    void process(float* samples, size_t frames) {
+        float next = target;
+        if (next == current && current == 1.0f) {
+            return;
+        }
+        kernels.applyGain(samples, frames, current, frames ? (next - current) / frames : 0.0f);
+        current = next;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+#include<vector>
+#include<cstdint>
+#include<cstring>
+#include<cassert>
+#include "DspKernels.hpp"
+
+using namespace std;
+
+// Streaming sample-rate converter for one track. Decoded frames are pushed
+// in whatever chunk sizes the decoder produces and converted frames are
+// drained out; the last few input frames are kept between calls because
+// each output interpolates between four neighbours.
+class Resampler {
+private:
+    const DspKernelSet& kernels;
+    uint64_t step;          // input frames per output frame, 32.32
+    uint64_t position;      // within input, 32.32
+    vector<float> input;    // interleaved stereo
+    bool started;
+
+    void appendFrame(const float* frame, int copies) {
+        for (int i = 0; i < copies; i++) {
+            input.push_back(frame[0]);
+            input.push_back(frame[1]);
+        }
+    }
+
+public:
+    Resampler(int fromRate, int toRate, const DspKernelSet& kernels = DspKernels::active()) : kernels(kernels) {
+        // A zero step would emit the first frame forever
+        assert(fromRate > 0 && toRate > 0);
+        step = ((uint64_t)fromRate << 32) / toRate;
+        position = 1ull << 32;   // frame 0 is a copy of the first real frame
+        started = false;
+    }
+
+    void push(const float* frames, size_t count) {
+        if (count == 0) {
+            return;
+        }
+        if (!started) {
+            appendFrame(frames, 1);
+            started = true;
+        }
+        input.insert(input.end(), frames, frames + 2 * count);
+    }
+
+    // No more input: repeat the last frame so the tail can be interpolated
+    void finish() {
+        if (started) {
+            float last[2] = {input[input.size() - 2], input[input.size() - 1]};
+            appendFrame(last, 2);
+        }
+    }
+
+    size_t drain(float* out, size_t maxFrames) {
+        size_t inFrames = input.size() / 2;
+        size_t produced = kernels.resample(input.data(), inFrames, out, maxFrames, position, step);
+        // Keep one frame before the current position for the next call
+        size_t consumed = (position >> 32) - 1;
+        if (consumed > 0) {
+            input.erase(input.begin(), input.begin() + 2 * min(consumed, inFrames));
+            position -= (uint64_t)consumed << 32;
+        }
+        return produced;
+    }
+
+    // Output frames the next drain can produce from what is buffered; each
+    // output needs two input frames after its position
+    size_t bufferedOutputFrames() {
+        size_t inFrames = input.size() / 2;
+        if (inFrames < 3) {
+            return 0;
+        }
+        uint64_t limit = (uint64_t)(inFrames - 2) << 32;
+        return limit > position ? (size_t)((limit - position + step - 1) / step) : 0;
+    }
+
+    // Output frames per input frame
+    double getRatio() {
+        return 4294967296.0 / step;
+    }
+
+    // Fine adjustment used for drift compensation: input frames consumed
+    // per output frame, e.g. 1.0005 to drain 500 ppm faster
+    void setStep(double inputPerOutput) {
+        step = (uint64_t)(inputPerOutput * 4294967296.0);
+    }
+};
\ No newline at end of file
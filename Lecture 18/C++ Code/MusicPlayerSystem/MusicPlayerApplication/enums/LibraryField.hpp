@@ -0,0 +1,6 @@
+#pragma once
+
+enum class LibraryField { 
+    TITLE, 
+    ARTIST 
+};
\ No newline at end of file
@@ -3,5 +3,8 @@
 enum class PlayStrategyType { 
     SEQUENTIAL, 
     RANDOM, 
-    CUSTOM_QUEUE 
+    CUSTOM_QUEUE,
+    WEIGHTED_BY_PLAY_COUNT,
+    WEIGHTED_BY_RATING,
+    ARTIST_SPREAD
 };
\ No newline at end of file
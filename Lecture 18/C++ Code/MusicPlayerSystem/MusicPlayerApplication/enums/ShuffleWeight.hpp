@@ -0,0 +1,6 @@
+#pragma once
+
+enum class ShuffleWeight { 
+    PLAY_COUNT, 
+    RATING 
+};
\ No newline at end of file
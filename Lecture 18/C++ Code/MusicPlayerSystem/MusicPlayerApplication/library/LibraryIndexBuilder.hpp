@@ -0,0 +1,384 @@
+#pragma once
+#include<string>
+#include<vector>
+#include<algorithm>
+#include<fstream>
+#include<stdexcept>
+#include<cstdio>
+#include<cctype>
+#include<cstring>
+#include<dirent.h>
+#include<sys/stat.h>
+#include "StringPool.hpp"
+#include "SearchText.hpp"
+#include "LibraryIndexFormat.hpp"
+
+using namespace std;
+
+// Collects songs (one by one, from a CSV file or from a directory of audio
+// files) and writes them out as a library index for SongLibrary to mmap.
+// Song ids are dense and follow the order songs were added in.
+class LibraryIndexBuilder {
+private:
+    struct Field {
+        StringPool pool;
+        vector<uint64_t> wordPostings;       // word id << 32 | string id
+        vector<uint64_t> boundaryPostings;   // boundary or fragment key << 32 | string id
+    };
+
+    struct FieldArrays {
+        vector<uint32_t> songOffsets, songs, prefixOrder, wordOffsets, wordPostings;
+        vector<uint32_t> boundaryKeys, boundaryOffsets, boundaryPostings;
+    };
+
+    Field titles, artists;
+    StringPool paths, vocabulary;
+    vector<uint32_t> songTitles, songArtists, songPaths;
+    string scratch;
+
+    void addWords(Field& field, uint32_t id) {
+        SearchText::normalize(field.pool.get(id), field.pool.length(id), scratch);
+        size_t firstWord = field.wordPostings.size();
+        size_t firstBoundary = field.boundaryPostings.size();
+        size_t start = 0, previous = 0;
+        while (start < scratch.size()) {
+            size_t end = scratch.find(' ', start);
+            if (end == string::npos) {
+                end = scratch.size();
+            }
+            uint64_t word = vocabulary.intern(scratch.data() + start, end - start);
+            field.wordPostings.push_back(word << 32 | id);
+            if (start > 0) {
+                const char* left = scratch.data() + previous;
+                size_t leftLength = start - 1 - previous;
+                uint64_t narrow = LibraryIndexFormat::boundaryKey(left, leftLength, scratch.data() + start, end - start, false);
+                field.boundaryPostings.push_back(narrow << 32 | id);
+                if (leftLength >= 2 && end - start >= 2) {
+                    uint64_t wide = LibraryIndexFormat::boundaryKey(left, leftLength, scratch.data() + start, end - start, true);
+                    field.boundaryPostings.push_back(wide << 32 | id);
+                }
+                size_t fragmentLeft = min(leftLength, LibraryIndexFormat::FRAGMENT_LEFT);
+                const char* fragment = scratch.data() + start - 1 - fragmentLeft;
+                for (size_t right = 1; right <= min(end - start, LibraryIndexFormat::FRAGMENT_RIGHT); right++) {
+                    uint64_t key = LibraryIndexFormat::fragmentKey(fragment, fragmentLeft + 1 + right);
+                    field.boundaryPostings.push_back(key << 32 | id);
+                }
+            }
+            previous = start;
+            start = end + 1;
+        }
+        // A word or boundary that appears twice in one string is posted once
+        sortUnique(field.wordPostings, firstWord);
+        sortUnique(field.boundaryPostings, firstBoundary);
+    }
+
+    static void sortUnique(vector<uint64_t>& items, size_t first) {
+        sort(items.begin() + first, items.end());
+        items.erase(unique(items.begin() + first, items.end()), items.end());
+    }
+
+    // Counting sort into offsets/values; items with the same key keep their order
+    template <typename Key, typename Value>
+    static void group(size_t keyCount, size_t itemCount, Key key, Value value,
+                      vector<uint32_t>& offsets, vector<uint32_t>& values) {
+        offsets.assign(keyCount + 1, 0);
+        for (size_t i = 0; i < itemCount; i++) {
+            offsets[key(i) + 1]++;
+        }
+        for (size_t k = 0; k < keyCount; k++) {
+            offsets[k + 1] += offsets[k];
+        }
+        vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+        values.resize(itemCount);
+        for (size_t i = 0; i < itemCount; i++) {
+            values[next[key(i)]++] = value(i);
+        }
+    }
+
+    static uint64_t prefixKey(const char* text) {
+        uint64_t key = 0;
+        for (int i = 0; i < 8 && text[i]; i++) {
+            key |= (uint64_t)(unsigned char)text[i] << (56 - 8 * i);
+        }
+        return key;
+    }
+
+    // Orders items by the NUL-terminated string at text + position(item).
+    // The first eight bytes are compared as one integer, so only items
+    // sharing them touch the strings themselves.
+    template <typename Position>
+    static void sortByText(const char* text, vector<uint32_t>& items, Position position) {
+        vector<pair<uint64_t, uint32_t>> keyed(items.size());
+        for (size_t i = 0; i < items.size(); i++) {
+            keyed[i] = {prefixKey(text + position(items[i])), items[i]};
+        }
+        sort(keyed.begin(), keyed.end(), [&](const pair<uint64_t, uint32_t>& a, const pair<uint64_t, uint32_t>& b) {
+            if (a.first != b.first) {
+                return a.first < b.first;
+            }
+            if ((a.first & 0xff) != 0) {
+                int order = strcmp(text + position(a.second) + 8, text + position(b.second) + 8);
+                if (order != 0) {
+                    return order < 0;
+                }
+            }
+            return a.second < b.second;
+        });
+        for (size_t i = 0; i < items.size(); i++) {
+            items[i] = keyed[i].second;
+        }
+    }
+
+    FieldArrays buildField(const Field& field, const vector<uint32_t>& songField) {
+        FieldArrays arrays;
+        size_t count = field.pool.size();
+        group(count, songField.size(), [&](size_t i) { return songField[i]; },
+              [](size_t i) { return (uint32_t)i; }, arrays.songOffsets, arrays.songs);
+        group(vocabulary.size(), field.wordPostings.size(),
+              [&](size_t i) { return (uint32_t)(field.wordPostings[i] >> 32); },
+              [&](size_t i) { return (uint32_t)field.wordPostings[i]; }, arrays.wordOffsets, arrays.wordPostings);
+
+        // Boundary keys are sparse, so they are sorted rather than counted
+        vector<uint64_t> boundaries = field.boundaryPostings;
+        sort(boundaries.begin(), boundaries.end());
+        arrays.boundaryPostings.resize(boundaries.size());
+        for (size_t i = 0; i < boundaries.size(); i++) {
+            uint32_t key = (uint32_t)(boundaries[i] >> 32);
+            if (arrays.boundaryKeys.empty() || arrays.boundaryKeys.back() != key) {
+                arrays.boundaryKeys.push_back(key);
+                arrays.boundaryOffsets.push_back((uint32_t)i);
+            }
+            arrays.boundaryPostings[i] = (uint32_t)boundaries[i];
+        }
+        arrays.boundaryOffsets.push_back((uint32_t)boundaries.size());
+
+        vector<char> searchText;
+        vector<uint32_t> starts(count);
+        for (uint32_t id = 0; id < count; id++) {
+            SearchText::normalize(field.pool.get(id), field.pool.length(id), scratch);
+            starts[id] = (uint32_t)searchText.size();
+            searchText.insert(searchText.end(), scratch.begin(), scratch.end());
+            searchText.push_back('\0');
+        }
+        arrays.prefixOrder.resize(count);
+        for (uint32_t id = 0; id < count; id++) {
+            arrays.prefixOrder[id] = id;
+        }
+        sortByText(searchText.data(), arrays.prefixOrder, [&](uint32_t id) { return starts[id]; });
+        return arrays;
+    }
+
+    template <typename T>
+    static void setSection(vector<pair<const void*, size_t>>& sections, int section, const vector<T>& items) {
+        sections[section] = {items.data(), items.size() * sizeof(T)};
+    }
+
+    static void setFieldSections(vector<pair<const void*, size_t>>& sections, int base, const Field& field,
+                                 const FieldArrays& arrays) {
+        using namespace LibraryIndexFormat;
+        setSection(sections, base + BYTES, field.pool.getBytes());
+        setSection(sections, base + OFFSETS, field.pool.getOffsets());
+        setSection(sections, base + HASH_TABLE, field.pool.getTable());
+        setSection(sections, base + SONG_OFFSETS, arrays.songOffsets);
+        setSection(sections, base + SONGS, arrays.songs);
+        setSection(sections, base + PREFIX_ORDER, arrays.prefixOrder);
+        setSection(sections, base + WORD_POSTING_OFFSETS, arrays.wordOffsets);
+        setSection(sections, base + WORD_POSTINGS, arrays.wordPostings);
+        setSection(sections, base + BOUNDARY_KEYS, arrays.boundaryKeys);
+        setSection(sections, base + BOUNDARY_OFFSETS, arrays.boundaryOffsets);
+        setSection(sections, base + BOUNDARY_POSTINGS, arrays.boundaryPostings);
+    }
+
+    // "Artist - Title.ext" names both; otherwise the folder is the artist
+    void addFile(const string& path, const string& folder, const string& fileName) {
+        string stem = fileName.substr(0, fileName.rfind('.'));
+        size_t dash = stem.find(" - ");
+        if (dash != string::npos) {
+            addSong(stem.substr(dash + 3), stem.substr(0, dash), path);
+        } else {
+            addSong(stem, folder, path);
+        }
+    }
+
+    static bool isAudioFile(const string& fileName) {
+        size_t dot = fileName.rfind('.');
+        if (dot == string::npos) {
+            return false;
+        }
+        string extension = fileName.substr(dot + 1);
+        for (char& c : extension) {
+            c = (char)tolower((unsigned char)c);
+        }
+        return extension == "wav" || extension == "mp3" || extension == "flac" || extension == "ogg";
+    }
+
+    static vector<string> parseCsvLine(const string& line) {
+        vector<string> fields(1);
+        bool quoted = false;
+        for (size_t i = 0; i < line.size(); i++) {
+            char c = line[i];
+            if (quoted) {
+                if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                    fields.back().push_back('"');
+                    i++;
+                } else if (c == '"') {
+                    quoted = false;
+                } else {
+                    fields.back().push_back(c);
+                }
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == ',') {
+                fields.emplace_back();
+            } else if (c != '\r') {
+                fields.back().push_back(c);
+            }
+        }
+        return fields;
+    }
+
+public:
+    uint32_t addSong(const string& title, const string& artist, const string& path) {
+        bool added;
+        uint32_t titleId = titles.pool.intern(title.data(), title.size(), &added);
+        if (added) {
+            addWords(titles, titleId);
+        }
+        uint32_t artistId = artists.pool.intern(artist.data(), artist.size(), &added);
+        if (added) {
+            addWords(artists, artistId);
+        }
+        songTitles.push_back(titleId);
+        songArtists.push_back(artistId);
+        songPaths.push_back(paths.intern(path.data(), path.size()));
+        return (uint32_t)(songTitles.size() - 1);
+    }
+
+    // Lines of title,artist,path; fields may be double-quoted. A first
+    // line starting with "title" is taken as a header.
+    size_t addFromCsv(const string& csvPath) {
+        ifstream in(csvPath);
+        if (!in) {
+            throw runtime_error("Cannot open \"" + csvPath + "\".");
+        }
+        size_t added = 0;
+        string line;
+        for (size_t lineNumber = 1; getline(in, line); lineNumber++) {
+            if (line.empty() || line == "\r") {
+                continue;
+            }
+            vector<string> fields = parseCsvLine(line);
+            if (lineNumber == 1 && SearchText::normalize(fields[0]) == "title") {
+                continue;
+            }
+            if (fields.size() < 3) {
+                throw runtime_error("\"" + csvPath + "\" line " + to_string(lineNumber) + ": expected title,artist,path.");
+            }
+            addSong(fields[0], fields[1], fields[2]);
+            added++;
+        }
+        return added;
+    }
+
+    // Every audio file under directory, in name order
+    size_t addFromDirectory(const string& directory) {
+        DIR* dir = opendir(directory.c_str());
+        if (!dir) {
+            throw runtime_error("Cannot open directory \"" + directory + "\".");
+        }
+        vector<string> names;
+        while (dirent* entry = readdir(dir)) {
+            string name = entry->d_name;
+            if (name != "." && name != "..") {
+                names.push_back(name);
+            }
+        }
+        closedir(dir);
+        sort(names.begin(), names.end());
+
+        string base = directory;
+        while (base.size() > 1 && base.back() == '/') {
+            base.pop_back();
+        }
+        string folder = base.substr(base.find_last_of('/') + 1);
+        size_t added = 0;
+        for (const string& name : names) {
+            string path = base + "/" + name;
+            struct stat info;
+            if (stat(path.c_str(), &info) != 0) {
+                continue;
+            }
+            if (S_ISDIR(info.st_mode)) {
+                added += addFromDirectory(path);
+            } else if (isAudioFile(name)) {
+                addFile(path, folder, name);
+                added++;
+            }
+        }
+        return added;
+    }
+
+    size_t getSongCount() {
+        return songTitles.size();
+    }
+
+    // Writes next to indexPath and renames over it, so a reader that has
+    // the old index mapped keeps a consistent view
+    void write(const string& indexPath) {
+        using namespace LibraryIndexFormat;
+        FieldArrays titleArrays = buildField(titles, songTitles);
+        FieldArrays artistArrays = buildField(artists, songArtists);
+
+        const vector<char>& words = vocabulary.getBytes();
+        vector<uint32_t> suffixes;
+        for (size_t position = 0; position < words.size(); position++) {
+            if (words[position] != '\0') {
+                suffixes.push_back((uint32_t)position);
+            }
+        }
+        sortByText(words.data(), suffixes, [](uint32_t position) { return position; });
+
+        vector<pair<const void*, size_t>> sections(SECTION_COUNT);
+        setSection(sections, SONG_TITLES, songTitles);
+        setSection(sections, SONG_ARTISTS, songArtists);
+        setSection(sections, SONG_PATHS, songPaths);
+        setSection(sections, PATH_BYTES, paths.getBytes());
+        setSection(sections, PATH_OFFSETS, paths.getOffsets());
+        setSection(sections, VOCABULARY_BYTES, words);
+        setSection(sections, VOCABULARY_OFFSETS, vocabulary.getOffsets());
+        setSection(sections, VOCABULARY_SUFFIXES, suffixes);
+        setSection(sections, VOCABULARY_HASH_TABLE, vocabulary.getTable());
+        setFieldSections(sections, TITLE_SECTIONS, titles, titleArrays);
+        setFieldSections(sections, ARTIST_SECTIONS, artists, artistArrays);
+
+        Header header = {};
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.sectionCount = SECTION_COUNT;
+        header.songCount = songTitles.size();
+        uint64_t offset = (sizeof(Header) + 7) & ~7ull;
+        for (int s = 0; s < SECTION_COUNT; s++) {
+            header.sectionOffset[s] = offset;
+            header.sectionBytes[s] = sections[s].second;
+            offset = (offset + sections[s].second + 7) & ~7ull;
+        }
+
+        string temporaryPath = indexPath + ".tmp";
+        ofstream out(temporaryPath, ios::binary | ios::trunc);
+        if (!out) {
+            throw runtime_error("Cannot write \"" + temporaryPath + "\".");
+        }
+        const char padding[8] = {};
+        out.write((const char*)&header, sizeof(Header));
+        out.write(padding, header.sectionOffset[0] - sizeof(Header));
+        for (int s = 0; s < SECTION_COUNT; s++) {
+            out.write((const char*)sections[s].first, sections[s].second);
+            out.write(padding, (8 - sections[s].second % 8) % 8);
+        }
+        out.close();
+        if (!out || rename(temporaryPath.c_str(), indexPath.c_str()) != 0) {
+            remove(temporaryPath.c_str());
+            throw runtime_error("Cannot write \"" + indexPath + "\".");
+        }
+    }
+};
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+#include<cstdint>
+#include<cassert>
+
+// Layout of a library index file: this header, then each section as a flat
+// array starting on an 8-byte boundary. Every section is used straight out
+// of the mapping, so opening an index costs the same for 10 songs or 10M.
+//
+// Per field (title, artist) there is a string pool, its hash table, the
+// songs of each string, the strings sorted by their search text (prefix
+// search), for every vocabulary word the strings containing it, and for
+// every word boundary key the strings containing that boundary. The
+// vocabulary is every distinct word of every title and artist, NUL
+// separated, with a suffix array over all of its characters (substring
+// search).
+//
+// A boundary key is the last two characters of a word and the first two
+// of the next one ("lo ya" in "Halo Yaar"), or one and one when either
+// word is shorter; a query spanning words looks its boundaries up there.
+// The same sections also hold fragment keys, a hash of the last four
+// characters of a word (all of it when shorter), the space and the first
+// one, two and three of the next ("halo y", "halo ya", "halo yaa"), so a
+// query typed from a word start into the next word has a short list.
+// Keys of either kind may collide; candidates are always confirmed.
+namespace LibraryIndexFormat {
+    const char MAGIC[8] = {'S', 'O', 'N', 'G', 'L', 'I', 'B', '1'};
+    const uint32_t VERSION = 2;
+    const size_t FRAGMENT_LEFT = 4;
+    const size_t FRAGMENT_RIGHT = 3;
+
+    inline uint32_t boundaryKey(const char* left, size_t leftLength, const char* right, size_t rightLength,
+                                bool wide) {
+        assert(leftLength >= (wide ? 2u : 1u) && rightLength >= (wide ? 2u : 1u));
+        if (wide) {
+            return (uint32_t)(unsigned char)left[leftLength - 2] << 24 | (uint32_t)(unsigned char)left[leftLength - 1] << 16
+                   | (uint32_t)(unsigned char)right[0] << 8 | (unsigned char)right[1];
+        }
+        return (uint32_t)(unsigned char)left[leftLength - 1] << 16 | (uint32_t)(unsigned char)right[0] << 8;
+    }
+
+    // fragment is the search text around one space, e.g. "halo ya"
+    inline uint32_t fragmentKey(const char* fragment, size_t length) {
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < length; i++) {
+            h = (h ^ (unsigned char)fragment[i]) * 16777619u;
+        }
+        return h;
+    }
+
+    enum FieldSection {
+        BYTES,                  // char: NUL-terminated strings
+        OFFSETS,                // uint32[count + 1]
+        HASH_TABLE,             // uint32: StringPool slots
+        SONG_OFFSETS,           // uint32[count + 1] into SONGS
+        SONGS,                  // uint32 song ids grouped by string
+        PREFIX_ORDER,           // uint32[count] string ids by search text
+        WORD_POSTING_OFFSETS,   // uint32[words + 1] into WORD_POSTINGS
+        WORD_POSTINGS,          // uint32 string ids grouped by word
+        BOUNDARY_KEYS,          // uint32 sorted distinct boundary and fragment keys
+        BOUNDARY_OFFSETS,       // uint32[keys + 1] into BOUNDARY_POSTINGS
+        BOUNDARY_POSTINGS,      // uint32 string ids grouped by key
+        FIELD_SECTIONS
+    };
+
+    enum Section {
+        SONG_TITLES = 0,        // uint32[songs] title id per song
+        SONG_ARTISTS,           // uint32[songs] artist id per song
+        SONG_PATHS,             // uint32[songs] path id per song
+        PATH_BYTES,
+        PATH_OFFSETS,
+        VOCABULARY_BYTES,
+        VOCABULARY_OFFSETS,
+        VOCABULARY_SUFFIXES,    // uint32 positions into VOCABULARY_BYTES, sorted
+        VOCABULARY_HASH_TABLE,  // uint32: StringPool slots
+        TITLE_SECTIONS,
+        ARTIST_SECTIONS = TITLE_SECTIONS + FIELD_SECTIONS,
+        SECTION_COUNT = ARTIST_SECTIONS + FIELD_SECTIONS
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t sectionCount;
+        uint64_t songCount;
+        uint64_t sectionOffset[SECTION_COUNT];
+        uint64_t sectionBytes[SECTION_COUNT];
+    };
+}
\ No newline at end of file
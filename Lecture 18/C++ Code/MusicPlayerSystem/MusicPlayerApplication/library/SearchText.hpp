@@ -0,0 +1,52 @@
+#pragma once
+#include<string>
+#include<vector>
+
+using namespace std;
+
+// The form titles and artists are searched in: ASCII letters lowercased,
+// every run of spaces and punctuation turned into one space, no leading or
+// trailing space. Non-ASCII bytes are kept as they are, so UTF-8 titles
+// stay searchable byte for byte.
+class SearchText {
+public:
+    static void normalize(const char* text, size_t length, string& out) {
+        out.clear();
+        bool pendingSpace = false;
+        for (size_t i = 0; i < length; i++) {
+            unsigned char c = (unsigned char)text[i];
+            if (c >= 'A' && c <= 'Z') {
+                c = c - 'A' + 'a';
+            } else if (c < 0x80 && !(c >= 'a' && c <= 'z') && !(c >= '0' && c <= '9')) {
+                pendingSpace = !out.empty();
+                continue;
+            }
+            if (pendingSpace) {
+                out.push_back(' ');
+                pendingSpace = false;
+            }
+            out.push_back((char)c);
+        }
+    }
+
+    static string normalize(const string& text) {
+        string out;
+        normalize(text.data(), text.size(), out);
+        return out;
+    }
+
+    // Words of an already normalized string
+    static vector<string> split(const string& normalized) {
+        vector<string> words;
+        size_t start = 0;
+        while (start < normalized.size()) {
+            size_t end = normalized.find(' ', start);
+            if (end == string::npos) {
+                end = normalized.size();
+            }
+            words.push_back(normalized.substr(start, end - start));
+            start = end + 1;
+        }
+        return words;
+    }
+};
\ No newline at end of file
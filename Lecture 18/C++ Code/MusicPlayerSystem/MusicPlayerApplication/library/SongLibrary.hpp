@@ -0,0 +1,395 @@
+#pragma once
+#include<string>
+#include<vector>
+#include<algorithm>
+#include<unordered_set>
+#include<cstring>
+#include<stdexcept>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include "StringPool.hpp"
+#include "SearchText.hpp"
+#include "LibraryIndexFormat.hpp"
+#include "../models/Song.hpp"
+#include "../enums/LibraryField.hpp"
+
+using namespace std;
+
+// Read-only song catalog served straight out of an mmap'd index written by
+// LibraryIndexBuilder. Songs have dense ids; titles and artists are
+// interned, so a title shared by many songs is stored once.
+//
+// Searches work on the normalized text (see SearchText):
+//  - findExact hashes the text and probes the stored table.
+//  - searchPrefix binary-searches the strings sorted by search text.
+//  - searchSubstring takes its candidates from the most selective part
+//    of the query: a word looked up in the vocabulary suffix array when
+//    the query is one word, otherwise the rarest of its middle words and
+//    word boundaries, with the characters either side of a boundary
+//    keyed so that a query typed from a word start into the next word
+//    has a short list. Candidates whose search text does not contain the
+//    whole query are skipped. A query starting with a word shorter than
+//    four characters cut off at a boundary has only the two-and-two key,
+//    which may be long for a common word.
+// Each stops as soon as it has `limit` songs.
+class SongLibrary {
+private:
+    struct FieldIndex {
+        const char* bytes;
+        const uint32_t* offsets;
+        const uint32_t* hashTable;
+        size_t hashTableSize;
+        size_t count;
+        const uint32_t* songOffsets;
+        const uint32_t* songs;
+        const uint32_t* prefixOrder;
+        const uint32_t* wordPostingOffsets;
+        const uint32_t* wordPostings;
+        const uint32_t* boundaryKeys;
+        size_t boundaryKeyCount;
+        const uint32_t* boundaryOffsets;
+        const uint32_t* boundaryPostings;
+    };
+
+    int fd;
+    const char* mapped;
+    size_t mappedBytes;
+    size_t songCount;
+    const uint32_t* songTitles;
+    const uint32_t* songArtists;
+    const uint32_t* songPaths;
+    const char* pathBytes;
+    const uint32_t* pathOffsets;
+    const char* vocabulary;
+    const uint32_t* vocabularyOffsets;
+    size_t vocabularyWords;
+    const uint32_t* vocabularySuffixes;
+    size_t vocabularySuffixCount;
+    const uint32_t* vocabularyHashTable;
+    size_t vocabularyHashTableSize;
+    FieldIndex fields[2];
+
+    template <typename T>
+    const T* section(const LibraryIndexFormat::Header& header, int s, size_t* count = nullptr) {
+        if (header.sectionOffset[s] + header.sectionBytes[s] > mappedBytes) {
+            throw runtime_error("Library index is truncated.");
+        }
+        if (count) {
+            *count = header.sectionBytes[s] / sizeof(T);
+        }
+        return (const T*)(mapped + header.sectionOffset[s]);
+    }
+
+    void loadField(const LibraryIndexFormat::Header& header, int base, FieldIndex& field) {
+        using namespace LibraryIndexFormat;
+        field.bytes = section<char>(header, base + BYTES);
+        field.offsets = section<uint32_t>(header, base + OFFSETS, &field.count);
+        field.count--;
+        field.hashTable = section<uint32_t>(header, base + HASH_TABLE, &field.hashTableSize);
+        field.songOffsets = section<uint32_t>(header, base + SONG_OFFSETS);
+        field.songs = section<uint32_t>(header, base + SONGS);
+        field.prefixOrder = section<uint32_t>(header, base + PREFIX_ORDER);
+        field.wordPostingOffsets = section<uint32_t>(header, base + WORD_POSTING_OFFSETS);
+        field.wordPostings = section<uint32_t>(header, base + WORD_POSTINGS);
+        field.boundaryKeys = section<uint32_t>(header, base + BOUNDARY_KEYS, &field.boundaryKeyCount);
+        field.boundaryOffsets = section<uint32_t>(header, base + BOUNDARY_OFFSETS);
+        field.boundaryPostings = section<uint32_t>(header, base + BOUNDARY_POSTINGS);
+    }
+
+    const FieldIndex& getField(LibraryField field) {
+        return fields[field == LibraryField::TITLE ? 0 : 1];
+    }
+
+    // Appends the songs of one string; false once the limit is reached
+    static bool addSongs(const FieldIndex& field, uint32_t id, size_t limit, vector<uint32_t>& results) {
+        for (uint32_t i = field.songOffsets[id]; i < field.songOffsets[id + 1]; i++) {
+            if (results.size() >= limit) {
+                return false;
+            }
+            results.push_back(field.songs[i]);
+        }
+        return results.size() < limit;
+    }
+
+    // Range of vocabulary suffixes starting with text
+    pair<const uint32_t*, const uint32_t*> suffixRange(const string& text) {
+        const uint32_t* first = vocabularySuffixes;
+        const uint32_t* last = vocabularySuffixes + vocabularySuffixCount;
+        const uint32_t* lower = lower_bound(first, last, text, [&](uint32_t position, const string& key) {
+            return strncmp(vocabulary + position, key.c_str(), key.size()) < 0;
+        });
+        const uint32_t* upper = upper_bound(lower, last, text, [&](const string& key, uint32_t position) {
+            return strncmp(vocabulary + position, key.c_str(), key.size()) > 0;
+        });
+        return {lower, upper};
+    }
+
+    uint32_t wordAt(uint32_t position) {
+        return (uint32_t)(upper_bound(vocabularyOffsets, vocabularyOffsets + vocabularyWords + 1, position)
+                          - vocabularyOffsets - 1);
+    }
+
+    // Calls visit(word id) for every vocabulary word containing text, once
+    // per occurrence; stops when visit returns false
+    template <typename Visit>
+    void visitWordsContaining(const string& text, Visit visit) {
+        pair<const uint32_t*, const uint32_t*> range = suffixRange(text);
+        for (const uint32_t* p = range.first; p != range.second; p++) {
+            if (!visit(wordAt(*p))) {
+                return;
+            }
+        }
+    }
+
+public:
+    SongLibrary(const string& indexPath) {
+        using namespace LibraryIndexFormat;
+        fd = open(indexPath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw runtime_error("Cannot open library index \"" + indexPath + "\".");
+        }
+        struct stat info;
+        fstat(fd, &info);
+        mappedBytes = info.st_size;
+        if (mappedBytes < sizeof(Header)) {
+            close(fd);
+            throw runtime_error("\"" + indexPath + "\" is not a library index.");
+        }
+        mapped = (const char*)mmap(nullptr, mappedBytes, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw runtime_error("Cannot map library index \"" + indexPath + "\".");
+        }
+        const Header& header = *(const Header*)mapped;
+        if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION
+            || header.sectionCount != SECTION_COUNT) {
+            munmap((void*)mapped, mappedBytes);
+            close(fd);
+            throw runtime_error("\"" + indexPath + "\" is not a library index.");
+        }
+        songCount = header.songCount;
+        songTitles = section<uint32_t>(header, SONG_TITLES);
+        songArtists = section<uint32_t>(header, SONG_ARTISTS);
+        songPaths = section<uint32_t>(header, SONG_PATHS);
+        pathBytes = section<char>(header, PATH_BYTES);
+        pathOffsets = section<uint32_t>(header, PATH_OFFSETS);
+        vocabulary = section<char>(header, VOCABULARY_BYTES);
+        vocabularyOffsets = section<uint32_t>(header, VOCABULARY_OFFSETS, &vocabularyWords);
+        vocabularyWords--;
+        vocabularySuffixes = section<uint32_t>(header, VOCABULARY_SUFFIXES, &vocabularySuffixCount);
+        vocabularyHashTable = section<uint32_t>(header, VOCABULARY_HASH_TABLE, &vocabularyHashTableSize);
+        loadField(header, TITLE_SECTIONS, fields[0]);
+        loadField(header, ARTIST_SECTIONS, fields[1]);
+    }
+
+    ~SongLibrary() {
+        munmap((void*)mapped, mappedBytes);
+        close(fd);
+    }
+
+    size_t getSongCount() {
+        return songCount;
+    }
+
+    string getTitle(uint32_t songId) {
+        return fields[0].bytes + fields[0].offsets[songTitles[songId]];
+    }
+
+    string getArtist(uint32_t songId) {
+        return fields[1].bytes + fields[1].offsets[songArtists[songId]];
+    }
+
+    string getFilePath(uint32_t songId) {
+        return pathBytes + pathOffsets[songPaths[songId]];
+    }
+
+    // The caller owns the returned song
+    Song* createSong(uint32_t songId) {
+        return new Song(getTitle(songId), getArtist(songId), getFilePath(songId));
+    }
+
+    // Songs whose title (or artist) is exactly text, case and all
+    vector<uint32_t> findExact(LibraryField fieldType, const string& text, size_t limit = SIZE_MAX) {
+        const FieldIndex& field = getField(fieldType);
+        vector<uint32_t> results;
+        int64_t id = StringPool::find(field.bytes, field.offsets, field.hashTable, field.hashTableSize,
+                                      text.data(), text.size());
+        if (id >= 0) {
+            addSongs(field, (uint32_t)id, limit, results);
+        }
+        return results;
+    }
+
+    // Songs whose title (or artist) starts with query, in search-text order
+    vector<uint32_t> searchPrefix(LibraryField fieldType, const string& query, size_t limit) {
+        const FieldIndex& field = getField(fieldType);
+        string prefix = SearchText::normalize(query);
+        string text;
+        auto searchTextOf = [&](uint32_t id) -> const string& {
+            SearchText::normalize(field.bytes + field.offsets[id], field.offsets[id + 1] - field.offsets[id] - 1, text);
+            return text;
+        };
+        const uint32_t* first = lower_bound(field.prefixOrder, field.prefixOrder + field.count, prefix,
+                                            [&](uint32_t id, const string& key) { return searchTextOf(id) < key; });
+        vector<uint32_t> results;
+        for (const uint32_t* p = first; p != field.prefixOrder + field.count; p++) {
+            if (searchTextOf(*p).compare(0, prefix.size(), prefix) != 0 || !addSongs(field, *p, limit, results)) {
+                break;
+            }
+        }
+        return results;
+    }
+
+    // Songs whose title (or artist) contains query anywhere
+    vector<uint32_t> searchSubstring(LibraryField fieldType, const string& query, size_t limit) {
+        const FieldIndex& field = getField(fieldType);
+        string needle = SearchText::normalize(query);
+        vector<uint32_t> results;
+        if (needle.empty() || limit == 0) {
+            return results;
+        }
+
+        vector<string> words = SearchText::split(needle);
+        // A one-word query reaches a string once per vocabulary word (and
+        // occurrence) it contains; the merged lists of a longer one never
+        // repeat a string
+        unordered_set<uint32_t> matched;
+        string text;
+        // Returns false once the limit is reached
+        auto visitStrings = [&](const uint32_t* ids, size_t count, const pair<const uint32_t*, size_t>* filter) {
+            size_t next = 0;
+            for (size_t i = 0; i < count; i++) {
+                uint32_t id = ids[i];
+                if (filter) {
+                    // Both lists ascend: gallop forward to id
+                    const uint32_t* others = filter->first;
+                    size_t step = 1;
+                    while (next + step < filter->second && others[next + step] < id) {
+                        step *= 2;
+                    }
+                    next = lower_bound(others + next, others + min(next + step + 1, filter->second), id) - others;
+                    if (next == filter->second) {
+                        return true;
+                    }
+                    if (others[next] != id) {
+                        continue;
+                    }
+                }
+                if (words.size() == 1 && !matched.insert(id).second) {
+                    continue;
+                }
+                if (words.size() > 1) {
+                    SearchText::normalize(field.bytes + field.offsets[id], field.offsets[id + 1] - field.offsets[id] - 1,
+                                          text);
+                    if (text.find(needle) == string::npos) {
+                        continue;
+                    }
+                }
+                if (!addSongs(field, id, limit, results)) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        // A one-word query can only be looked up in the vocabulary, and
+        // then every string found contains it
+        if (words.size() == 1) {
+            visitWordsContaining(needle, [&](uint32_t word) {
+                return visitStrings(field.wordPostings + field.wordPostingOffsets[word],
+                                    field.wordPostingOffsets[word + 1] - field.wordPostingOffsets[word], nullptr);
+            });
+            return results;
+        }
+
+        // A longer one must contain its middle words exactly and each of
+        // its word boundaries, and the fragment around each boundary where
+        // the word before it is known to end there: from its last four
+        // characters, or all of it when it is a middle word. The first
+        // query word must also end a word and the last start one, which is
+        // worth using when that leaves only a few vocabulary words. All of
+        // these give ascending lists of strings; the shortest is walked,
+        // the next shortest filters it, and what is left is confirmed
+        // against the text.
+        vector<pair<const uint32_t*, size_t>> lists;
+        auto shorter = [](const pair<const uint32_t*, size_t>& a, const pair<const uint32_t*, size_t>& b) {
+            return a.second < b.second;
+        };
+        // Returns false when no string has the key
+        auto addKeyList = [&](uint32_t key) {
+            const uint32_t* found = lower_bound(field.boundaryKeys, field.boundaryKeys + field.boundaryKeyCount, key);
+            if (found == field.boundaryKeys + field.boundaryKeyCount || *found != key) {
+                return false;
+            }
+            size_t index = found - field.boundaryKeys;
+            lists.push_back({field.boundaryPostings + field.boundaryOffsets[index],
+                             field.boundaryOffsets[index + 1] - field.boundaryOffsets[index]});
+            return true;
+        };
+        for (size_t w = 1; w + 1 < words.size(); w++) {
+            int64_t id = StringPool::find(vocabulary, vocabularyOffsets, vocabularyHashTable, vocabularyHashTableSize,
+                                          words[w].data(), words[w].size());
+            if (id < 0) {
+                return results;
+            }
+            lists.push_back({field.wordPostings + field.wordPostingOffsets[id],
+                             field.wordPostingOffsets[id + 1] - field.wordPostingOffsets[id]});
+        }
+        size_t space = 0;
+        for (size_t w = 0; w + 1 < words.size(); w++) {
+            const string& left = words[w];
+            const string& right = words[w + 1];
+            space += left.size() + (w > 0);
+            if (!addKeyList(LibraryIndexFormat::boundaryKey(left.data(), left.size(), right.data(), right.size(),
+                                                            left.size() >= 2 && right.size() >= 2))) {
+                return results;
+            }
+            if (left.size() >= LibraryIndexFormat::FRAGMENT_LEFT || w > 0) {
+                size_t fragmentLeft = min(left.size(), LibraryIndexFormat::FRAGMENT_LEFT);
+                size_t fragmentRight = min(right.size(), LibraryIndexFormat::FRAGMENT_RIGHT);
+                if (!addKeyList(LibraryIndexFormat::fragmentKey(needle.data() + space - fragmentLeft,
+                                                                fragmentLeft + 1 + fragmentRight))) {
+                    return results;
+                }
+            }
+        }
+        sort(lists.begin(), lists.end(), shorter);
+
+        const size_t fewSuffixes = 64;
+        vector<uint32_t> endWordStrings[2];
+        for (int side = 0; side < 2; side++) {
+            const string& word = side == 0 ? words.front() : words.back();
+            pair<const uint32_t*, const uint32_t*> range = suffixRange(word);
+            if ((size_t)(range.second - range.first) > fewSuffixes) {
+                continue;
+            }
+            vector<uint32_t> endWords;
+            size_t count = 0;
+            for (const uint32_t* p = range.first; p != range.second; p++) {
+                uint32_t id = wordAt(*p);
+                if (side == 0 ? *p + word.size() + 1 == vocabularyOffsets[id + 1] : *p == vocabularyOffsets[id]) {
+                    endWords.push_back(id);
+                    count += field.wordPostingOffsets[id + 1] - field.wordPostingOffsets[id];
+                }
+            }
+            // Merging costs about as much as walking the shortest list, so
+            // it is only worth it when the result would be walked instead
+            if (!lists.empty() && count >= lists[0].second) {
+                continue;
+            }
+            vector<uint32_t>& ids = endWordStrings[side];
+            for (uint32_t id : endWords) {
+                ids.insert(ids.end(), field.wordPostings + field.wordPostingOffsets[id],
+                           field.wordPostings + field.wordPostingOffsets[id + 1]);
+            }
+            sort(ids.begin(), ids.end());
+            ids.erase(unique(ids.begin(), ids.end()), ids.end());
+            lists.push_back({ids.data(), ids.size()});
+            sort(lists.begin(), lists.end(), shorter);
+        }
+        visitStrings(lists[0].first, lists[0].second, lists.size() > 1 ? &lists[1] : nullptr);
+        return results;
+    }
+};
\ No newline at end of file
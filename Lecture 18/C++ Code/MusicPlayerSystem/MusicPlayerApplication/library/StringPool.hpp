@@ -0,0 +1,112 @@
+#pragma once
+#include<vector>
+#include<string>
+#include<cstdint>
+#include<cstring>
+#include<stdexcept>
+
+using namespace std;
+
+// Interns strings: each distinct string is stored once, NUL-terminated, in
+// one contiguous buffer and gets a dense id in insertion order. Lookups go
+// through an open-addressing table of ids; the table is written into the
+// library index as is, so the mmap'd reader finds strings with the same
+// probe sequence without rebuilding anything.
+class StringPool {
+private:
+    vector<char> bytes;
+    vector<uint32_t> offsets;   // start of each string, plus one past the last
+    vector<uint32_t> table;     // id + 1 per slot, 0 when empty
+
+    void grow() {
+        vector<uint32_t> larger(table.size() * 2, 0);
+        size_t mask = larger.size() - 1;
+        for (uint32_t id = 0; id < size(); id++) {
+            size_t slot = hash(get(id), length(id)) & mask;
+            while (larger[slot]) {
+                slot = (slot + 1) & mask;
+            }
+            larger[slot] = id + 1;
+        }
+        table.swap(larger);
+    }
+
+public:
+    StringPool() {
+        offsets.push_back(0);
+        table.assign(1024, 0);
+    }
+
+    static uint64_t hash(const char* text, size_t length) {
+        uint64_t h = 1469598103934665603ull;
+        for (size_t i = 0; i < length; i++) {
+            h = (h ^ (unsigned char)text[i]) * 1099511628211ull;
+        }
+        return h ^ (h >> 29);
+    }
+
+    // Shared by the builder and the mmap'd reader; -1 when absent
+    static int64_t find(const char* bytes, const uint32_t* offsets, const uint32_t* table, size_t tableSize,
+                        const char* text, size_t length) {
+        size_t mask = tableSize - 1;
+        for (size_t slot = hash(text, length) & mask; table[slot]; slot = (slot + 1) & mask) {
+            uint32_t id = table[slot] - 1;
+            if (offsets[id + 1] - offsets[id] - 1 == length && memcmp(bytes + offsets[id], text, length) == 0) {
+                return id;
+            }
+        }
+        return -1;
+    }
+
+    uint32_t intern(const char* text, size_t length, bool* added = nullptr) {
+        int64_t existing = find(bytes.data(), offsets.data(), table.data(), table.size(), text, length);
+        if (added) {
+            *added = existing < 0;
+        }
+        if (existing >= 0) {
+            return (uint32_t)existing;
+        }
+        if (bytes.size() + length + 1 > UINT32_MAX) {
+            throw runtime_error("String pool is full.");
+        }
+        uint32_t id = (uint32_t)size();
+        bytes.insert(bytes.end(), text, text + length);
+        bytes.push_back('\0');
+        offsets.push_back((uint32_t)bytes.size());
+        if (2 * size() > table.size()) {
+            grow();
+        } else {
+            size_t mask = table.size() - 1;
+            size_t slot = hash(text, length) & mask;
+            while (table[slot]) {
+                slot = (slot + 1) & mask;
+            }
+            table[slot] = id + 1;
+        }
+        return id;
+    }
+
+    size_t size() const {
+        return offsets.size() - 1;
+    }
+
+    const char* get(uint32_t id) const {
+        return bytes.data() + offsets[id];
+    }
+
+    size_t length(uint32_t id) const {
+        return offsets[id + 1] - offsets[id] - 1;
+    }
+
+    const vector<char>& getBytes() const {
+        return bytes;
+    }
+
+    const vector<uint32_t>& getOffsets() const {
+        return offsets;
+    }
+
+    const vector<uint32_t>& getTable() const {
+        return table;
+    }
+};
\ No newline at end of file
@@ -1,8 +1,24 @@
 #include "MusicPlayerApplication.hpp"
+#include "benchmarks/PlaylistBenchmark.hpp"
+#include "benchmarks/PipelineBenchmark.hpp"
+#include "benchmarks/DspBenchmark.hpp"
+#include "benchmarks/FanOutBenchmark.hpp"
+#include "benchmarks/LibraryBenchmark.hpp"
+#include "benchmarks/ShuffleBenchmark.hpp"
 
 using namespace std;
 
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--benchmark") {
+        PlaylistBenchmark::run();
+        PipelineBenchmark::run();
+        DspBenchmark::run();
+        FanOutBenchmark::run();
+        LibraryBenchmark::run(10000000);
+        ShuffleBenchmark::run();
+        return 0;
+    }
+
     try {
         auto application = MusicPlayerApplication::getInstance();
 
@@ -38,6 +54,11 @@ int main() {
         application->loadPlaylist("Bollywood Vibes");
         application->playAllTracksInPlaylist();
 
+        cout << "\n-- Artist Spread Playback --\n";
+        application->selectPlayStrategy(PlayStrategyType::ARTIST_SPREAD);
+        application->loadPlaylist("Bollywood Vibes");
+        application->playAllTracksInPlaylist();
+
         cout << "\n-- Custom Queue Playback --\n";
         application->selectPlayStrategy(PlayStrategyType::CUSTOM_QUEUE);
         application->loadPlaylist("Bollywood Vibes");
@@ -1,6 +1,8 @@
 #pragma once
 #include<iostream>
+#include<vector>
 #include "../device/IAudioOutputDevice.hpp"
+#include "../device/FanOutOutputDevice.hpp"
 #include "../enums/DeviceType.hpp"
 #include "../factories/DeviceFactory.hpp"
 
@@ -10,8 +12,17 @@ class DeviceManager {
 private:
     static DeviceManager* instance;
     IAudioOutputDevice* currentOutputDevice;
+    vector<IAudioOutputDevice*> additionalDevices;
+    FanOutOutputDevice* fanOut;   // built on demand over all devices
+
     DeviceManager() {
         currentOutputDevice = nullptr;
+        fanOut = nullptr;
+    }
+
+    void resetFanOut() {
+        delete fanOut;
+        fanOut = nullptr;
     }
 public:
     static DeviceManager* getInstance() {
@@ -20,10 +31,16 @@ public:
         }
         return instance;
     }
+    // Replaces every connected device with this one
     void connect(DeviceType deviceType) {
+        resetFanOut();
         if (currentOutputDevice) {
             delete currentOutputDevice;
         }
+        for (IAudioOutputDevice* device : additionalDevices) {
+            delete device;
+        }
+        additionalDevices.clear();
 
         currentOutputDevice = DeviceFactory::createDevice(deviceType);
 
@@ -39,6 +56,42 @@ public:
         }
     }
 
+    // Keeps the current device(s) and plays on this one as well. The
+    // manager takes ownership of the device.
+    void connectAdditional(IAudioOutputDevice* device) {
+        if (!currentOutputDevice) {
+            currentOutputDevice = device;
+            return;
+        }
+        resetFanOut();
+        additionalDevices.push_back(device);
+    }
+
+    void connectAdditional(DeviceType deviceType) {
+        connectAdditional(DeviceFactory::createDevice(deviceType));
+        cout << "Additional output device connected \n";
+    }
+
+    int getDeviceCount() {
+        return (currentOutputDevice ? 1 : 0) + (int)additionalDevices.size();
+    }
+
+    // Where a decoded stream should go: the device itself, or a fan-out
+    // that feeds every connected device from the one stream
+    IAudioOutputDevice* getStreamOutput() {
+        if (additionalDevices.empty()) {
+            return getOutputDevice();
+        }
+        if (!fanOut) {
+            fanOut = new FanOutOutputDevice();
+            fanOut->addDevice(currentOutputDevice);
+            for (IAudioOutputDevice* device : additionalDevices) {
+                fanOut->addDevice(device);
+            }
+        }
+        return fanOut;
+    }
+
     IAudioOutputDevice* getOutputDevice() {
         if (!currentOutputDevice) {
             throw runtime_error("No output device is connected.");
@@ -3,6 +3,8 @@
 #include "../strategies/SequentialPlayStrategy.hpp"
 #include "../strategies/CustomQueueStrategy.hpp"
 #include "../strategies/RandomPlayStrategy.hpp"
+#include "../strategies/WeightedShuffleStrategy.hpp"
+#include "../strategies/ArtistSpreadShuffleStrategy.hpp"
 #include "../enums/PlayStrategyType.hpp"
 
 using namespace std;
@@ -13,11 +15,17 @@ private:
     SequentialPlayStrategy* sequentialStrategy;
     RandomPlayStrategy* randomStrategy;
     CustomQueueStrategy* customQueueStrategy;
+    WeightedShuffleStrategy* playCountStrategy;
+    WeightedShuffleStrategy* ratingStrategy;
+    ArtistSpreadShuffleStrategy* artistSpreadStrategy;
 
     StrategyManager() {
         sequentialStrategy = new SequentialPlayStrategy();
         randomStrategy = new RandomPlayStrategy();
         customQueueStrategy = new CustomQueueStrategy();
+        playCountStrategy = new WeightedShuffleStrategy(ShuffleWeight::PLAY_COUNT);
+        ratingStrategy = new WeightedShuffleStrategy(ShuffleWeight::RATING);
+        artistSpreadStrategy = new ArtistSpreadShuffleStrategy();
     }
 public:
     static StrategyManager* getInstance() {
@@ -31,6 +39,12 @@ public:
             return sequentialStrategy;
         } else if (type == PlayStrategyType::RANDOM) {
             return randomStrategy;
+        } else if (type == PlayStrategyType::WEIGHTED_BY_PLAY_COUNT) {
+            return playCountStrategy;
+        } else if (type == PlayStrategyType::WEIGHTED_BY_RATING) {
+            return ratingStrategy;
+        } else if (type == PlayStrategyType::ARTIST_SPREAD) {
+            return artistSpreadStrategy;
         } else {
             return customQueueStrategy;
         }
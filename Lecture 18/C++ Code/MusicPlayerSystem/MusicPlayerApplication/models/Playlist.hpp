@@ -2,6 +2,7 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <unordered_map>
 #include "Song.hpp"
 
 using namespace std;
@@ -10,6 +11,7 @@ class Playlist {
 private:
     string playlistName;
     vector<Song*> songList;
+    unordered_map<Song*, int> songPositions;   // first position of each song
 public:
     Playlist(string name) {
         playlistName = name;
@@ -17,16 +19,26 @@ public:
     string getPlaylistName() {
         return playlistName;
     }
-    const vector<Song*> getSongs() {
+    // Read-only view; strategies walk it in place instead of copying
+    const vector<Song*>& getSongs() const {
         return songList;
     }
-    int getSize() {
+    Song* getSongAt(int index) const {
+        return songList[index];
+    }
+    // Position of the song's first occurrence, -1 if it is not in the playlist
+    int indexOf(Song* song) const {
+        auto found = songPositions.find(song);
+        return found == songPositions.end() ? -1 : found->second;
+    }
+    int getSize() const {
         return (int)songList.size();
     }
     void addSongToPlaylist(Song* song) {
         if (song == nullptr) {
             throw runtime_error("Cannot add null song to playlist.");
         }
+        songPositions.emplace(song, (int)songList.size());
         songList.push_back(song);
     }
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <iostream>
+#include <stdexcept>
 
 using namespace std;
 
@@ -9,11 +10,15 @@ private:
     string title;
     string artist;
     string filePath;
+    int playCount;
+    int rating;     // 1-5 stars, 0 while unrated
 public:
     Song(string t, string a, string f) {
         title = t;
         artist = a;
         filePath = f;
+        playCount = 0;
+        rating = 0;
     }
     string getTitle() { 
         return title; 
@@ -24,4 +29,19 @@ public:
     string getFilePath() { 
         return filePath;  
     }
+    int getPlayCount() {
+        return playCount;
+    }
+    void incrementPlayCount() {
+        playCount++;
+    }
+    int getRating() {
+        return rating;
+    }
+    void setRating(int stars) {
+        if (stars < 0 || stars > 5) {
+            throw runtime_error("Rating must be between 0 and 5 stars.");
+        }
+        rating = stars;
+    }
 };
\ No newline at end of file
@@ -0,0 +1,147 @@
+#pragma once
+#include<iostream>
+#include<stack>
+#include<vector>
+#include<string>
+#include<unordered_map>
+#include<algorithm>
+#include "../models/Playlist.hpp"
+#include "PlayStrategy.hpp"
+#include "FenwickTree.hpp"
+#include "FastRandom.hpp"
+
+using namespace std;
+
+// Uniform shuffle that never plays the same artist twice in a row unless
+// nothing else is left. Playlist positions are grouped by artist, so the
+// previous artist's unplayed songs form one contiguous range of the tree
+// and are skipped by drawing from the rest. When a single artist holds
+// more than half of what is left, it has to go now or it will end up back
+// to back later. O(n) to load, O(log n) per song.
+class ArtistSpreadShuffleStrategy : public PlayStrategy {
+private:
+    Playlist* currentPlaylist;
+    vector<uint32_t> order;             // playlist positions grouped by artist
+    vector<uint32_t> artistStart;       // artist a owns order[artistStart[a], artistStart[a + 1])
+    vector<uint32_t> artistAt;          // artist of each entry of order
+    vector<uint32_t> remainingByArtist;
+    vector<uint32_t> artistsWithCount;  // how many artists have exactly c songs left
+    uint32_t largestCount;
+    FenwickTree unplayed;               // 1 per unplayed entry of order
+    int remainingSongs;
+    int previousArtist;
+    stack<Song*> history;
+    FastRandom random;
+
+    size_t pick() {
+        uint64_t remaining = (uint64_t)remainingSongs;
+        if (previousArtist >= 0) {
+            uint32_t previousCount = remainingByArtist[previousArtist];
+            bool previousDominates = 2 * (uint64_t)previousCount > remaining;
+            if (2 * (uint64_t)largestCount > remaining && !previousDominates) {
+                // Another artist holds the majority: draw until it comes up (under two tries expected)
+                while (true) {
+                    size_t candidate = unplayed.find(random.below(remaining));
+                    if (remainingByArtist[artistAt[candidate]] == largestCount) {
+                        return candidate;
+                    }
+                }
+            }
+            if (previousCount < remaining) {
+                uint64_t skipFrom = unplayed.prefix(artistStart[previousArtist]);
+                uint64_t point = random.below(remaining - previousCount);
+                return unplayed.find(point < skipFrom ? point : point + previousCount);
+            }
+        }
+        return unplayed.find(random.below(remaining));
+    }
+
+public:
+    ArtistSpreadShuffleStrategy(uint64_t seed = FastRandom::clockSeed()) : random(seed) {
+        currentPlaylist = nullptr;
+        largestCount = 0;
+        remainingSongs = 0;
+        previousArtist = -1;
+    }
+
+    void setPlaylist(Playlist* playlist) override {
+        currentPlaylist = playlist;
+        remainingSongs = currentPlaylist ? currentPlaylist->getSize() : 0;
+        previousArtist = -1;
+        history = stack<Song*>();
+
+        // Counting sort of positions by artist id
+        unordered_map<string, uint32_t> artistIds;
+        vector<uint32_t> artistOf(remainingSongs);
+        remainingByArtist.clear();
+        for (int i = 0; i < remainingSongs; i++) {
+            auto inserted = artistIds.emplace(currentPlaylist->getSongAt(i)->getArtist(), (uint32_t)artistIds.size());
+            if (inserted.second) {
+                remainingByArtist.push_back(0);
+            }
+            artistOf[i] = inserted.first->second;
+            remainingByArtist[artistOf[i]]++;
+        }
+        artistStart.assign(remainingByArtist.size() + 1, 0);
+        largestCount = 0;
+        for (size_t a = 0; a < remainingByArtist.size(); a++) {
+            artistStart[a + 1] = artistStart[a] + remainingByArtist[a];
+            largestCount = max(largestCount, remainingByArtist[a]);
+        }
+        order.resize(remainingSongs);
+        artistAt.resize(remainingSongs);
+        vector<uint32_t> cursor(artistStart.begin(), artistStart.end() - 1);
+        for (int i = 0; i < remainingSongs; i++) {
+            artistAt[cursor[artistOf[i]]] = artistOf[i];
+            order[cursor[artistOf[i]]++] = (uint32_t)i;
+        }
+        artistsWithCount.assign(largestCount + 1, 0);
+        for (uint32_t count : remainingByArtist) {
+            artistsWithCount[count]++;
+        }
+        unplayed.build(remainingSongs, [](size_t) { return (uint64_t)1; });
+    }
+
+    bool hasNext() override {
+        return currentPlaylist && remainingSongs > 0;
+    }
+
+    Song* next() override {
+        if (!currentPlaylist || currentPlaylist->getSize() == 0) {
+            throw runtime_error("No playlist loaded or playlist is empty.");
+        }
+        if (remainingSongs == 0) {
+            throw runtime_error("No songs left to play");
+        }
+
+        size_t chosen = pick();
+        int artist = (int)artistAt[chosen];
+        unplayed.add(chosen, -1);
+        remainingSongs--;
+        uint32_t count = remainingByArtist[artist]--;
+        artistsWithCount[count]--;
+        artistsWithCount[count - 1]++;
+        if (count == largestCount && artistsWithCount[count] == 0) {
+            largestCount--;
+        }
+        previousArtist = artist;
+
+        Song* selectedSong = currentPlaylist->getSongAt((int)order[chosen]);
+        history.push(selectedSong);
+        return selectedSong;
+    }
+
+    bool hasPrevious() override {
+        return history.size() > 0;
+    }
+
+    Song* previous() override {
+        if (history.empty()) {
+            throw std::runtime_error("No previous song available.");
+        }
+
+        Song* song = history.top();
+        history.pop();
+        return song;
+    }
+};
\ No newline at end of file
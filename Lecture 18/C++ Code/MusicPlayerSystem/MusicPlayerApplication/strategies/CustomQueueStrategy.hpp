@@ -1,5 +1,7 @@
 #pragma once
 #include<iostream>
+#include<queue>
+#include<stack>
 #include "../models/Playlist.hpp"
 #include "PlayStrategy.hpp"
 
@@ -15,7 +17,7 @@ private:
             throw runtime_error("Playlist is empty.");
         }
         currentIndex = currentIndex + 1;
-        return currentPlaylist->getSongs()[currentIndex];
+        return currentPlaylist->getSongAt(currentIndex);
     }
 
     Song* previousSequential() {
@@ -23,7 +25,7 @@ private:
             throw runtime_error("Playlist is empty.");
         }
         currentIndex = currentIndex - 1;
-        return currentPlaylist->getSongs()[currentIndex];
+        return currentPlaylist->getSongAt(currentIndex);
     }
 
 public:
@@ -58,12 +60,9 @@ public:
             prevStack.push(s);
 
             // update index to match queued song
-            auto& list = currentPlaylist->getSongs();
-            for (int i = 0; i < (int)list.size(); ++i) {
-                if (list[i] == s) {
-                    currentIndex = i;
-                    break;
-                }
+            int position = currentPlaylist->indexOf(s);
+            if (position >= 0) {
+                currentIndex = position;
             }
             return s;
         }
@@ -86,12 +85,9 @@ public:
             prevStack.pop();
 
             // update index to match stacked song
-            auto& list = currentPlaylist->getSongs();
-            for (int i = 0; i < (int)list.size(); ++i) {
-                if (list[i] == s) {
-                    currentIndex = i;
-                    break;
-                }
+            int position = currentPlaylist->indexOf(s);
+            if (position >= 0) {
+                currentIndex = position;
             }
             return s;
         }
@@ -0,0 +1,62 @@
+#pragma once
+#include<cstdint>
+#include<chrono>
+
+using namespace std;
+
+// xoshiro256** generator: a handful of instructions per number, a period
+// of 2^256 - 1, and the same sequence for the same seed, so a shuffle can
+// be replayed. rand() offers none of that and is limited to RAND_MAX.
+class FastRandom {
+private:
+    uint64_t state[4];
+
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    FastRandom(uint64_t seed = clockSeed()) {
+        setSeed(seed);
+    }
+
+    static uint64_t clockSeed() {
+        return (uint64_t)chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    // Expands the seed with splitmix64 so that nearby seeds give unrelated streams
+    void setSeed(uint64_t seed) {
+        for (uint64_t& word : state) {
+            uint64_t z = (seed += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    uint64_t next() {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, bound) without modulo bias (Lemire's multiply-shift)
+    uint64_t below(uint64_t bound) {
+        __uint128_t product = (__uint128_t)next() * bound;
+        uint64_t low = (uint64_t)product;
+        if (low < bound) {
+            uint64_t threshold = (0 - bound) % bound;
+            while (low < threshold) {
+                product = (__uint128_t)next() * bound;
+                low = (uint64_t)product;
+            }
+        }
+        return (uint64_t)(product >> 64);
+    }
+};
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+#include<vector>
+#include<cstdint>
+
+using namespace std;
+
+// Binary indexed tree over non-negative integer weights. Changing a weight,
+// summing a prefix and finding the item that a point of the cumulative
+// range falls into are all O(log n); building from n weights is O(n).
+// Shuffles use it to draw items with probability proportional to weight
+// and then zero them out, which is sampling without replacement.
+class FenwickTree {
+private:
+    vector<uint64_t> tree;      // 1-based
+    vector<uint64_t> weights;   // current weight of each item, for O(1) get
+    uint64_t sum;
+
+public:
+    FenwickTree() {
+        sum = 0;
+    }
+
+    template <typename Weight>
+    void build(size_t count, Weight weightOf) {
+        tree.assign(count + 1, 0);
+        weights.resize(count);
+        sum = 0;
+        for (size_t i = 1; i <= count; i++) {
+            uint64_t weight = weightOf(i - 1);
+            weights[i - 1] = weight;
+            tree[i] += weight;
+            sum += weight;
+            size_t parent = i + (i & (0 - i));
+            if (parent <= count) {
+                tree[parent] += tree[i];
+            }
+        }
+    }
+
+    void add(size_t index, int64_t delta) {
+        sum += delta;
+        weights[index] += delta;
+        for (size_t i = index + 1; i < tree.size(); i += i & (0 - i)) {
+            tree[i] += delta;
+        }
+    }
+
+    // Sum of the first count weights
+    uint64_t prefix(size_t count) const {
+        uint64_t total = 0;
+        for (size_t i = count; i > 0; i -= i & (0 - i)) {
+            total += tree[i];
+        }
+        return total;
+    }
+
+    uint64_t get(size_t index) const {
+        return weights[index];
+    }
+
+    uint64_t total() const {
+        return sum;
+    }
+
+    // The item whose slice of [0, total) contains point
+    size_t find(uint64_t point) const {
+        size_t position = 0;
+        size_t step = 1;
+        while (step * 2 < tree.size()) {
+            step *= 2;
+        }
+        for (; step > 0; step /= 2) {
+            if (position + step < tree.size() && tree[position + step] <= point) {
+                position += step;
+                point -= tree[position];
+            }
+        }
+        return position;
+    }
+};
\ No newline at end of file
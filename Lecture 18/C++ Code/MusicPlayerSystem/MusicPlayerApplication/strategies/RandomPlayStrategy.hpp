@@ -1,32 +1,54 @@
 #pragma once
 #include<iostream>
+#include<stack>
+#include<vector>
+#include<algorithm>
 #include "../models/Playlist.hpp"
 #include "PlayStrategy.hpp"
+#include "FastRandom.hpp"
 
 using namespace std;
 
 class RandomPlayStrategy : public PlayStrategy {
 private:
     Playlist* currentPlaylist;
-    vector<Song*> remainingSongs; 
+    // Fisher-Yates over playlist positions, done lazily: slot i holds
+    // position slots[i] once it has been swapped this round (stamps[i] ==
+    // round) and position i otherwise, so loading a playlist copies nothing
+    vector<uint32_t> slots;
+    vector<uint32_t> stamps;
+    uint32_t round;
+    int remainingSongs;
     stack<Song*> history; 
+    FastRandom random;
+
+    uint32_t positionAt(int slot) {
+        return stamps[slot] == round ? slots[slot] : (uint32_t)slot;
+    }
 
 public:
-    RandomPlayStrategy() {
+    RandomPlayStrategy(uint64_t seed = FastRandom::clockSeed()) : random(seed) {
         currentPlaylist = nullptr;
-        srand((unsigned)time(nullptr));
+        round = 0;
+        remainingSongs = 0;
     }
 
     void setPlaylist(Playlist* playlist) override {
         currentPlaylist = playlist;
-        if (!currentPlaylist || currentPlaylist->getSize() == 0) return;
-
-        remainingSongs = currentPlaylist->getSongs();
+        remainingSongs = currentPlaylist ? currentPlaylist->getSize() : 0;
         history = stack<Song*>(); 
+        if (stamps.size() < (size_t)remainingSongs) {
+            slots.resize(remainingSongs);
+            stamps.resize(remainingSongs, round);
+        }
+        if (++round == 0) {
+            fill(stamps.begin(), stamps.end(), 0);
+            round = 1;
+        }
     }
 
     bool hasNext() override {
-        return currentPlaylist && !remainingSongs.empty();
+        return currentPlaylist && remainingSongs > 0;
     }
 
     // Next in Loop
@@ -34,16 +56,17 @@ public:
         if (!currentPlaylist || currentPlaylist->getSize() == 0) {
             throw runtime_error("No playlist loaded or playlist is empty.");
         }
-        if (remainingSongs.empty()) {
+        if (remainingSongs == 0) {
             throw runtime_error("No songs left to play");
         }
 
-        int idx = rand() % remainingSongs.size();
-        Song* selectedSong = remainingSongs[idx];
+        int idx = (int)random.below(remainingSongs);
+        Song* selectedSong = currentPlaylist->getSongAt(positionAt(idx));
 
-        // Remove the selectedSong from the list. (Swap and pop to remove in O(1))
-        swap(remainingSongs[idx], remainingSongs.back());
-        remainingSongs.pop_back();
+        // Move the last unplayed position into the chosen slot (swap and pop)
+        remainingSongs--;
+        slots[idx] = positionAt(remainingSongs);
+        stamps[idx] = round;
 
         history.push(selectedSong);
         return selectedSong;
@@ -62,5 +85,4 @@ public:
         history.pop();
         return song;
     }
-};
-    
\ No newline at end of file
+};
\ No newline at end of file
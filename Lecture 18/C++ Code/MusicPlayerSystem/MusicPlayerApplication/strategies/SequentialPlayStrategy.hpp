@@ -30,7 +30,7 @@ public:
             throw runtime_error("No playlist loaded or playlist is empty.");
         }
         currentIndex = currentIndex + 1;
-        return currentPlaylist->getSongs()[currentIndex];
+        return currentPlaylist->getSongAt(currentIndex);
     }
 
     bool hasPrevious() override {
@@ -43,6 +43,6 @@ public:
             throw runtime_error("No playlist loaded or playlist is empty.");
         }
         currentIndex = currentIndex - 1;
-        return currentPlaylist->getSongs()[currentIndex];
+        return currentPlaylist->getSongAt(currentIndex);
     }
 };
\ No newline at end of file
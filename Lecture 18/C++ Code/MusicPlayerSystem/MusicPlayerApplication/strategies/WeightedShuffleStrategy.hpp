@@ -0,0 +1,83 @@
+#pragma once
+#include<iostream>
+#include<stack>
+#include "../models/Playlist.hpp"
+#include "../enums/ShuffleWeight.hpp"
+#include "PlayStrategy.hpp"
+#include "FenwickTree.hpp"
+#include "FastRandom.hpp"
+
+using namespace std;
+
+// Shuffle where each unplayed song comes next with probability
+// proportional to its weight: play count + 1, or star rating (unrated
+// songs count as 3 stars). A played song's weight drops to zero, so every
+// song is still played exactly once per pass. O(n) to load, O(log n) per song.
+class WeightedShuffleStrategy : public PlayStrategy {
+private:
+    Playlist* currentPlaylist;
+    ShuffleWeight weighting;
+    FenwickTree weights;      // by playlist position
+    int remainingSongs;
+    stack<Song*> history;
+    FastRandom random;
+
+    uint64_t weightOf(Song* song) {
+        if (weighting == ShuffleWeight::PLAY_COUNT) {
+            return (uint64_t)song->getPlayCount() + 1;
+        }
+        return song->getRating() == 0 ? 3 : (uint64_t)song->getRating();
+    }
+
+public:
+    WeightedShuffleStrategy(ShuffleWeight weighting, uint64_t seed = FastRandom::clockSeed()) : random(seed) {
+        currentPlaylist = nullptr;
+        this->weighting = weighting;
+        remainingSongs = 0;
+    }
+
+    void setPlaylist(Playlist* playlist) override {
+        currentPlaylist = playlist;
+        remainingSongs = currentPlaylist ? currentPlaylist->getSize() : 0;
+        history = stack<Song*>();
+        // Weights are captured now; plays during this pass do not change the odds
+        weights.build(remainingSongs, [&](size_t i) {
+            return weightOf(currentPlaylist->getSongAt((int)i));
+        });
+    }
+
+    bool hasNext() override {
+        return currentPlaylist && remainingSongs > 0;
+    }
+
+    Song* next() override {
+        if (!currentPlaylist || currentPlaylist->getSize() == 0) {
+            throw runtime_error("No playlist loaded or playlist is empty.");
+        }
+        if (remainingSongs == 0) {
+            throw runtime_error("No songs left to play");
+        }
+
+        size_t position = weights.find(random.below(weights.total()));
+        weights.add(position, -(int64_t)weights.get(position));
+        remainingSongs--;
+
+        Song* selectedSong = currentPlaylist->getSongAt((int)position);
+        history.push(selectedSong);
+        return selectedSong;
+    }
+
+    bool hasPrevious() override {
+        return history.size() > 0;
+    }
+
+    Song* previous() override {
+        if (history.empty()) {
+            throw std::runtime_error("No previous song available.");
+        }
+
+        Song* song = history.top();
+        history.pop();
+        return song;
+    }
+};
\ No newline at end of file
@@ -2,10 +2,51 @@
 #include <string>
 #include <cstdlib>
 #include <ctime>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <cstdint>
+#include <unordered_map>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <iterator>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
 
 
 using namespace std;
 
+// ----------------------------
+// Step logging used by the gateways. Benchmarks switch it off; each thread
+// gets its own muted stream so concurrent writes don't share stream state.
+// ----------------------------
+class PaymentLog {
+private:
+    static atomic<bool> enabled;
+public:
+    static void setEnabled(bool on) {
+        enabled = on;
+    }
+    static ostream& out() {
+        static thread_local ostream muted(nullptr);
+        return enabled ? cout : muted;
+    }
+};
+
+atomic<bool> PaymentLog::enabled(true);
+
 // ----------------------------
 // Data structure for payment details
 // ----------------------------
@@ -14,21 +55,55 @@ struct PaymentRequest {
     string reciever;
     double amount;
     string currency;
+    // Same key = same payment; resubmitting it never charges twice
+    string idempotencyKey;
 
-    PaymentRequest(const string& sender, const string& reciever, double amt, const string& curr) {
+    PaymentRequest(const string& sender, const string& reciever, double amt, const string& curr, const string& key = "") {
         this->sender = sender;
         this->reciever = reciever;
         this->amount = amt;
         this->currency = curr;
+        this->idempotencyKey = key.empty() ? newKey() : key;
+    }
+
+    // Unique across restarts: start time of the process plus a counter
+    static string newKey() {
+        static const long long epoch = chrono::duration_cast<chrono::microseconds>(
+            chrono::system_clock::now().time_since_epoch()).count();
+        static atomic<long long> counter(0);
+        return "pay-" + to_string(epoch) + "-" + to_string(counter++);
     }
 };
 
 // ----------------------------
 // Banking System interface and implementations (Strategy for actual payment logic)
 // ----------------------------
+// What a bank knows about the charge made under an idempotency key
+enum class ChargeStatus {
+    CHARGED,
+    NOT_CHARGED,
+    UNKNOWN     // the bank keeps no ledger it can be asked
+};
+
 class BankingSystem {
 public:
     virtual bool processPayment(double amount) = 0;
+    // Charge tagged with the payment's idempotency key, so a bank that keeps
+    // a ledger can find the charge again. Banks without one ignore the key.
+    virtual bool processPayment(double amount, const string&) {
+        return processPayment(amount);
+    }
+    // Cancel the charge made under this key before it settles. Only banks
+    // that report supportsVoid() can; the rest always return false.
+    virtual bool supportsVoid() {
+        return false;
+    }
+    virtual bool voidPayment(const string&) {
+        return false;
+    }
+    virtual ChargeStatus lookupPayment(const string&) {
+        return ChargeStatus::UNKNOWN;
+    }
     virtual ~BankingSystem() {}
 };
 
@@ -42,26 +117,355 @@ public:
     }
 };
 
+// Local bank simulator for tests and benchmarks: configurable latency
+// (base + uniform jitter) and failure rate. With a ledger it remembers every
+// keyed charge, so charges can be voided and looked up.
+class SimulatedBankingSystem : public BankingSystem {
+protected:
+    int latencyMicros;
+    int jitterMicros;
+    double failureRate;
+    bool keepLedger;
+    mutex ledgerMtx;
+    unordered_map<string, double> ledger;   // key -> amount charged
+    atomic<long long> voids;
+
+    static mt19937& rng() {
+        static thread_local mt19937 gen(random_device{}());
+        return gen;
+    }
+public:
+    SimulatedBankingSystem(int latencyMicros, int jitterMicros, double failureRate, bool keepLedger = false) {
+        this->latencyMicros = latencyMicros;
+        this->jitterMicros = jitterMicros;
+        this->failureRate = failureRate;
+        this->keepLedger = keepLedger;
+        voids = 0;
+    }
+    long long getVoids() {
+        return voids;
+    }
+    bool processPayment(double amount, const string& idempotencyKey) override {
+        bool ok = processPayment(amount);
+        if (ok && keepLedger) {
+            lock_guard<mutex> lock(ledgerMtx);
+            ledger[idempotencyKey] = amount;
+        }
+        return ok;
+    }
+    bool supportsVoid() override {
+        return keepLedger;
+    }
+    bool voidPayment(const string& idempotencyKey) override {
+        lock_guard<mutex> lock(ledgerMtx);
+        if (ledger.erase(idempotencyKey) == 0) {
+            return false;
+        }
+        voids++;
+        return true;
+    }
+    ChargeStatus lookupPayment(const string& idempotencyKey) override {
+        if (!keepLedger) {
+            return ChargeStatus::UNKNOWN;
+        }
+        lock_guard<mutex> lock(ledgerMtx);
+        return ledger.count(idempotencyKey) ? ChargeStatus::CHARGED : ChargeStatus::NOT_CHARGED;
+    }
+    bool processPayment(double) override {
+        int delay = latencyMicros;
+        if (jitterMicros > 0) {
+            delay += uniform_int_distribution<int>(0, jitterMicros)(rng());
+        }
+        if (delay > 0) {
+            this_thread::sleep_for(chrono::microseconds(delay));
+        }
+        return uniform_real_distribution<double>(0.0, 1.0)(rng()) >= failureRate;
+    }
+};
+
+// Simulated bank with injectable faults: a fraction of slow calls (tail
+// latency) and a switchable outage in which every call times out and fails.
+class FaultInjectingBankingSystem : public SimulatedBankingSystem {
+private:
+    double slowRate;
+    int slowLatencyMicros;
+    atomic<bool> outage;
+    atomic<long long> calls;
+public:
+    FaultInjectingBankingSystem(int latencyMicros, int jitterMicros, double failureRate,
+                                double slowRate, int slowLatencyMicros, bool keepLedger = false)
+        : SimulatedBankingSystem(latencyMicros, jitterMicros, failureRate, keepLedger) {
+        this->slowRate = slowRate;
+        this->slowLatencyMicros = slowLatencyMicros;
+        outage = false;
+        calls = 0;
+    }
+    void setOutage(bool down) {
+        outage = down;
+    }
+    long long getCalls() {
+        return calls;
+    }
+    using SimulatedBankingSystem::processPayment;
+    bool processPayment(double amount) override {
+        calls++;
+        if (outage) {
+            this_thread::sleep_for(chrono::microseconds(latencyMicros));
+            return false;
+        }
+        if (uniform_real_distribution<double>(0.0, 1.0)(rng()) < slowRate) {
+            this_thread::sleep_for(chrono::microseconds(slowLatencyMicros));
+        }
+        return SimulatedBankingSystem::processPayment(amount);
+    }
+};
+
 class RazorpayBankingSystem : public BankingSystem {
 public:
     RazorpayBankingSystem() {}
     bool processPayment(double amount) override {
-        cout << "[BankingSystem-Razorpay] Processing payment of " << amount << "...\n";
+        PaymentLog::out() << "[BankingSystem-Razorpay] Processing payment of " << amount << "...\n";
         // Simulate 90% success
         int r = rand() % 100;
         return r < 90;
     }
 };
 
+// ----------------------------
+// Lock-free latency histogram (HDR style): 16 linear sub-buckets per power
+// of two, so any recorded value is reported within ~6%. Values are in
+// whatever unit the caller records (microseconds unless noted).
+// ----------------------------
+class LatencyHistogram {
+private:
+    static const int SUB_BITS = 4;
+    static const int SUB_BUCKETS = 1 << SUB_BITS;
+    static const int BUCKETS = 64 * SUB_BUCKETS;
+
+    atomic<uint64_t> buckets[BUCKETS];
+    atomic<uint64_t> total;
+    atomic<uint64_t> sum;
+    atomic<uint64_t> maxValue;
+
+    static int indexFor(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return (int)value;
+        }
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - SUB_BITS;
+        return (shift + 1) * SUB_BUCKETS + (int)((value >> shift) & (SUB_BUCKETS - 1));
+    }
+
+    static uint64_t valueFor(int index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        int shift = index / SUB_BUCKETS - 1;
+        return (uint64_t)(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    }
+
+public:
+    LatencyHistogram() {
+        reset();
+    }
+
+    void reset() {
+        for (int i = 0; i < BUCKETS; i++) {
+            buckets[i].store(0, memory_order_relaxed);
+        }
+        total = 0;
+        sum = 0;
+        maxValue = 0;
+    }
+
+    void record(uint64_t value) {
+        buckets[indexFor(value)].fetch_add(1, memory_order_relaxed);
+        total.fetch_add(1, memory_order_relaxed);
+        sum.fetch_add(value, memory_order_relaxed);
+        uint64_t seen = maxValue.load(memory_order_relaxed);
+        while (value > seen && !maxValue.compare_exchange_weak(seen, value, memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t count() const {
+        return total.load(memory_order_relaxed);
+    }
+
+    double mean() const {
+        uint64_t n = count();
+        return n ? (double)sum.load(memory_order_relaxed) / n : 0.0;
+    }
+
+    uint64_t max() const {
+        return maxValue.load(memory_order_relaxed);
+    }
+
+    // Lower bound of the bucket holding the p-th quantile (p in [0, 1])
+    uint64_t percentile(double p) const {
+        uint64_t n = count();
+        if (n == 0) {
+            return 0;
+        }
+        uint64_t target = (uint64_t)(p * n);
+        if (target < 1) target = 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += buckets[i].load(memory_order_relaxed);
+            if (seen >= target) {
+                return std::min(valueFor(i), max());
+            }
+        }
+        return max();
+    }
+
+    // One line per power-of-two range that has samples
+    void print(ostream& out, const char* unit = "us") const {
+        for (int power = 0; power < 64; power++) {
+            uint64_t inRange = 0;
+            for (int i = 0; i < BUCKETS; i++) {
+                uint64_t low = valueFor(i);
+                if (low >= (1ULL << power) && (power == 63 || low < (1ULL << (power + 1)))) {
+                    inRange += buckets[i].load(memory_order_relaxed);
+                }
+            }
+            if (inRange > 0) {
+                out << "    [" << (1ULL << power) << ", " << (1ULL << (power + 1)) << ") " << unit << ": " << inRange << "\n";
+            }
+        }
+    }
+};
+
+// ----------------------------
+// Per-gateway instrumentation: one latency histogram (nanoseconds) per step
+// of the payment template, plus outcome counters.
+// ----------------------------
+struct GatewayMetrics {
+    string name;
+    LatencyHistogram validate;
+    LatencyHistogram initiate;
+    LatencyHistogram confirm;
+    atomic<long long> requests;
+    atomic<long long> successes;
+    atomic<long long> validationFailures;
+    atomic<long long> initiationFailures;
+    atomic<long long> confirmationFailures;
+
+    GatewayMetrics(const string& name) {
+        this->name = name;
+        reset();
+    }
+
+    void reset() {
+        validate.reset();
+        initiate.reset();
+        confirm.reset();
+        requests = successes = validationFailures = initiationFailures = confirmationFailures = 0;
+    }
+
+    static void printStage(ostream& out, const char* stage, const LatencyHistogram& h) {
+        out << "    " << stage << " ns: p50=" << h.percentile(0.50) << " p99=" << h.percentile(0.99)
+            << " p999=" << h.percentile(0.999) << " max=" << h.max() << " mean=" << (long long)h.mean() << "\n";
+    }
+
+    void print(ostream& out) const {
+        out << "  [" << name << "] requests=" << requests << " successes=" << successes
+            << " failed-validation=" << validationFailures << " failed-initiation=" << initiationFailures
+            << " failed-confirmation=" << confirmationFailures << "\n";
+        printStage(out, "validate", validate);
+        printStage(out, "initiate", initiate);
+        printStage(out, "confirm ", confirm);
+    }
+};
+
+// ----------------------------
+// Lock-free registry of gateway metrics (Singleton). Open addressing over a
+// fixed table of atomic slots; a new name is published with one CAS and
+// entries are never removed, so lookups need no lock.
+// ----------------------------
+class MetricsRegistry {
+private:
+    static MetricsRegistry instance;
+    static const int CAPACITY = 64;
+    atomic<GatewayMetrics*> slots[CAPACITY];
+
+    MetricsRegistry() {
+        for (int i = 0; i < CAPACITY; i++) {
+            slots[i] = nullptr;
+        }
+    }
+    ~MetricsRegistry() {
+        for (int i = 0; i < CAPACITY; i++) {
+            delete slots[i].load();
+        }
+    }
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+public:
+    static MetricsRegistry& getInstance() {
+        return instance;
+    }
+
+    GatewayMetrics* get(const string& name) {
+        size_t start = hash<string>()(name) % CAPACITY;
+        for (int i = 0; i < CAPACITY; i++) {
+            atomic<GatewayMetrics*>& slot = slots[(start + i) % CAPACITY];
+            GatewayMetrics* metrics = slot.load(memory_order_acquire);
+            if (!metrics) {
+                GatewayMetrics* created = new GatewayMetrics(name);
+                if (slot.compare_exchange_strong(metrics, created, memory_order_acq_rel)) {
+                    return created;
+                }
+                delete created;
+            }
+            if (metrics->name == name) {
+                return metrics;
+            }
+        }
+        throw runtime_error("metrics registry is full");
+    }
+
+    void reset() {
+        for (int i = 0; i < CAPACITY; i++) {
+            GatewayMetrics* metrics = slots[i].load(memory_order_acquire);
+            if (metrics) {
+                metrics->reset();
+            }
+        }
+    }
+
+    // Gateways that have handled at least one request
+    void print(ostream& out) {
+        for (int i = 0; i < CAPACITY; i++) {
+            GatewayMetrics* metrics = slots[i].load(memory_order_acquire);
+            if (metrics && metrics->requests > 0) {
+                metrics->print(out);
+            }
+        }
+    }
+};
+
+MetricsRegistry MetricsRegistry::instance;
+
 // ----------------------------
 // Abstract base class for Payment Gateway (Template Method Pattern)
 // ----------------------------
 class PaymentGateway {
 protected:
     BankingSystem* bankingSystem;
+    GatewayMetrics* metrics;
+
+    // Records the time since 'since' for one step and moves 'since' on
+    static bool endStage(LatencyHistogram& stage, chrono::steady_clock::time_point& since, bool ok) {
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        stage.record(chrono::duration_cast<chrono::nanoseconds>(now - since).count());
+        since = now;
+        return ok;
+    }
 public:
     PaymentGateway() { 
         bankingSystem = nullptr;
+        metrics = MetricsRegistry::getInstance().get("Other");
     }
     virtual ~PaymentGateway() { 
         delete bankingSystem; 
@@ -69,21 +473,39 @@ public:
 
     // Template method defining the standard payment flow
     virtual bool processPayment(PaymentRequest* request) {
-        if (!validatePayment(request)) {
-            cout << "[PaymentGateway] Validation failed for " << request->sender << ".\n";
+        metrics->requests.fetch_add(1, memory_order_relaxed);
+        chrono::steady_clock::time_point since = chrono::steady_clock::now();
+        if (!endStage(metrics->validate, since, validatePayment(request))) {
+            metrics->validationFailures.fetch_add(1, memory_order_relaxed);
+            PaymentLog::out() << "[PaymentGateway] Validation failed for " << request->sender << ".\n";
             return false;
         }
-        if (!initiatePayment(request)) {
-            cout << "[PaymentGateway] Initiation failed for " << request->sender << ".\n";
+        if (!endStage(metrics->initiate, since, initiatePayment(request))) {
+            metrics->initiationFailures.fetch_add(1, memory_order_relaxed);
+            PaymentLog::out() << "[PaymentGateway] Initiation failed for " << request->sender << ".\n";
             return false;
         }
-        if (!confirmPayment(request)) {
-            cout << "[PaymentGateway] Confirmation failed for " << request->sender << ".\n";
+        if (!endStage(metrics->confirm, since, confirmPayment(request))) {
+            metrics->confirmationFailures.fetch_add(1, memory_order_relaxed);
+            PaymentLog::out() << "[PaymentGateway] Confirmation failed for " << request->sender << ".\n";
             return false;
         }
+        metrics->successes.fetch_add(1, memory_order_relaxed);
         return true;
     }
 
+    // Cancel this request's charge at the bank, if the bank can
+    virtual bool supportsVoid() {
+        return bankingSystem && bankingSystem->supportsVoid();
+    }
+    virtual bool voidPayment(PaymentRequest* request) {
+        return bankingSystem && bankingSystem->voidPayment(request->idempotencyKey);
+    }
+    // Ask the bank whether this request was charged (crash recovery)
+    virtual ChargeStatus lookupPayment(PaymentRequest* request) {
+        return bankingSystem ? bankingSystem->lookupPayment(request->idempotencyKey) : ChargeStatus::UNKNOWN;
+    }
+
     // Steps to be implemented by concrete gateways
     virtual bool validatePayment(PaymentRequest* request) = 0;
     virtual bool initiatePayment(PaymentRequest* request) = 0;
@@ -95,11 +517,12 @@ public:
 // ----------------------------
 class PaytmGateway : public PaymentGateway {
 public:
-    PaytmGateway() {
-        bankingSystem = new PaytmBankingSystem();
+    PaytmGateway(BankingSystem* bank = nullptr) {
+        bankingSystem = bank ? bank : new PaytmBankingSystem();
+        metrics = MetricsRegistry::getInstance().get("Paytm");
     }
     bool validatePayment(PaymentRequest* request) override {
-        cout << "[Paytm] Validating payment for " << request->sender << ".\n";
+        PaymentLog::out() << "[Paytm] Validating payment for " << request->sender << ".\n";
 
         if (request->amount <= 0 || request->currency != "INR") {
             return false;
@@ -107,13 +530,13 @@ public:
         return true;
     }
     bool initiatePayment(PaymentRequest* request) override {
-        cout << "[Paytm] Initiating payment of " << request->amount 
+        PaymentLog::out() << "[Paytm] Initiating payment of " << request->amount 
                   << " " << request->currency << " for " << request->sender << ".\n";
 
-        return bankingSystem->processPayment(request->amount);
+        return bankingSystem->processPayment(request->amount, request->idempotencyKey);
     }
     bool confirmPayment(PaymentRequest* request) override {
-        cout << "[Paytm] Confirming payment for " << request->sender << ".\n";
+        PaymentLog::out() << "[Paytm] Confirming payment for " << request->sender << ".\n";
 
         // Confirmation always succeeds in this simulation
         return true;
@@ -125,11 +548,12 @@ public:
 // ----------------------------
 class RazorpayGateway : public PaymentGateway {
 public:
-    RazorpayGateway() {
-        bankingSystem = new RazorpayBankingSystem();
+    RazorpayGateway(BankingSystem* bank = nullptr) {
+        bankingSystem = bank ? bank : new RazorpayBankingSystem();
+        metrics = MetricsRegistry::getInstance().get("Razorpay");
     }
     bool validatePayment(PaymentRequest* request) override {
-        cout << "[Razorpay] Validating payment for " << request->sender << ".\n";
+        PaymentLog::out() << "[Razorpay] Validating payment for " << request->sender << ".\n";
 
         if (request->amount <= 0) {
             return false;
@@ -137,14 +561,14 @@ public:
         return true;
     }
     bool initiatePayment(PaymentRequest* request) override {
-        cout << "[Razorpay] Initiating payment of " << request->amount 
+        PaymentLog::out() << "[Razorpay] Initiating payment of " << request->amount 
                   << " " << request->currency << " for " << request->sender << ".\n";
 
-        return bankingSystem->processPayment(request->amount);
+        return bankingSystem->processPayment(request->amount, request->idempotencyKey);
        
     }
     bool confirmPayment(PaymentRequest* request) override {
-        cout << "[Razorpay] Confirming payment for " << request->sender << ".\n";
+        PaymentLog::out() << "[Razorpay] Confirming payment for " << request->sender << ".\n";
 
         // Confirmation always succeeds in this simulation
         return true;
@@ -152,35 +576,456 @@ public:
 };
 
 // ----------------------------
-// Proxy class that wraps a PaymentGateway to add retries (Proxy Pattern)
+// Jittered exponential backoff ("full jitter"): the delay before retry n is
+// uniform in [0, min(maxDelay, baseDelay * 2^n)].
+// ----------------------------
+struct RetryPolicy {
+    int baseDelayMicros;
+    int maxDelayMicros;
+
+    chrono::microseconds delayFor(int attempt) const {
+        static thread_local mt19937 rng(random_device{}());
+        long long cap = (long long)baseDelayMicros << std::min(attempt, 20);
+        cap = std::min(cap, (long long)maxDelayMicros);
+        return chrono::microseconds(uniform_int_distribution<long long>(0, cap)(rng));
+    }
+};
+
+// ----------------------------
+// Circuit breaker: opens after failureThreshold consecutive failures,
+// rejects calls for openDuration, then lets a limited number of probe calls
+// through (half-open). A successful probe closes it, a failed one reopens it.
+// ----------------------------
+class CircuitBreaker {
+public:
+    enum State { CLOSED, OPEN, HALF_OPEN };
+private:
+    mutex mtx;
+    State state;
+    int consecutiveFailures;
+    int failureThreshold;
+    int maxProbes;
+    int probesInFlight;
+    chrono::milliseconds openDuration;
+    chrono::steady_clock::time_point openedAt;
+    long long timesOpened;
+
+    void open() {
+        state = OPEN;
+        openedAt = chrono::steady_clock::now();
+        timesOpened++;
+    }
+
+public:
+    CircuitBreaker(int failureThreshold = 5, int openMillis = 1000, int maxProbes = 1) {
+        state = CLOSED;
+        consecutiveFailures = 0;
+        this->failureThreshold = failureThreshold;
+        this->maxProbes = maxProbes;
+        probesInFlight = 0;
+        openDuration = chrono::milliseconds(openMillis);
+        timesOpened = 0;
+    }
+
+    bool allowRequest() {
+        lock_guard<mutex> lock(mtx);
+        if (state == CLOSED) {
+            return true;
+        }
+        if (state == OPEN) {
+            if (chrono::steady_clock::now() - openedAt < openDuration) {
+                return false;
+            }
+            state = HALF_OPEN;
+            probesInFlight = 0;
+        }
+        if (probesInFlight < maxProbes) {
+            probesInFlight++;
+            return true;
+        }
+        return false;
+    }
+
+    void recordSuccess() {
+        lock_guard<mutex> lock(mtx);
+        consecutiveFailures = 0;
+        if (state == HALF_OPEN) {
+            state = CLOSED;
+        }
+    }
+
+    void recordFailure() {
+        lock_guard<mutex> lock(mtx);
+        consecutiveFailures++;
+        if (state == HALF_OPEN || (state == CLOSED && consecutiveFailures >= failureThreshold)) {
+            open();
+        }
+    }
+
+    string getStateName() {
+        lock_guard<mutex> lock(mtx);
+        return state == CLOSED ? "CLOSED" : (state == OPEN ? "OPEN" : "HALF_OPEN");
+    }
+
+    long long getTimesOpened() {
+        lock_guard<mutex> lock(mtx);
+        return timesOpened;
+    }
+};
+
+// ----------------------------
+// Asynchronous executor for one gateway. Callers pipeline requests through
+// submit() and get a future (and optionally a completion callback). At most
+// maxInFlight payments are in progress at once; submit() blocks when the
+// window is full, which is the backpressure for a slow bank. The executor
+// deletes its gateway unless told it is only borrowing it.
+// ----------------------------
+typedef function<void(PaymentRequest*, bool)> PaymentCallback;
+// Told how long each payment took (microseconds) and whether it succeeded
+typedef function<void(long long, bool)> PaymentObserver;
+
+class AsyncPaymentExecutor {
+private:
+    struct Job {
+        PaymentRequest* request;
+        promise<bool> result;
+        PaymentCallback callback;
+    };
+
+    PaymentGateway* gateway;
+    bool ownsGateway;
+    PaymentObserver observer;
+    int maxInFlight;
+    int inFlight;
+    bool stopping;
+    deque<Job> queue;
+    mutex mtx;
+    condition_variable workAvailable;
+    condition_variable slotFree;
+    vector<thread> workers;
+
+    void workerLoop() {
+        while (true) {
+            Job job;
+            {
+                unique_lock<mutex> lock(mtx);
+                workAvailable.wait(lock, [this]() { return stopping || !queue.empty(); });
+                if (queue.empty()) {
+                    return;
+                }
+                job = move(queue.front());
+                queue.pop_front();
+            }
+
+            bool ok = false;
+            exception_ptr error;
+            try {
+                auto start = chrono::steady_clock::now();
+                ok = gateway->processPayment(job.request);
+                if (observer) {
+                    observer(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count(), ok);
+                }
+            } catch (...) {
+                error = current_exception();
+                ok = false;
+            }
+            // Runs even if the payment threw (as a failure), so whoever
+            // waits on the callback is never left hanging
+            try {
+                if (job.callback) {
+                    job.callback(job.request, ok);
+                }
+            } catch (...) {
+                if (!error) {
+                    error = current_exception();
+                }
+            }
+            if (error) {
+                job.result.set_exception(error);
+            } else {
+                job.result.set_value(ok);
+            }
+
+            {
+                lock_guard<mutex> lock(mtx);
+                inFlight--;
+            }
+            slotFree.notify_one();
+        }
+    }
+
+public:
+    AsyncPaymentExecutor(PaymentGateway* gateway, int maxInFlight, PaymentObserver observer = nullptr,
+                         bool ownsGateway = true) {
+        this->gateway = gateway;
+        this->ownsGateway = ownsGateway;
+        this->observer = observer;
+        this->maxInFlight = maxInFlight;
+        inFlight = 0;
+        stopping = false;
+        for (int i = 0; i < maxInFlight; i++) {
+            workers.emplace_back(&AsyncPaymentExecutor::workerLoop, this);
+        }
+    }
+
+    // Finishes everything already submitted, then stops the workers
+    ~AsyncPaymentExecutor() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        workAvailable.notify_all();
+        for (thread& worker : workers) {
+            worker.join();
+        }
+        if (ownsGateway) {
+            delete gateway;
+        }
+    }
+
+    future<bool> submit(PaymentRequest* request, PaymentCallback callback = nullptr) {
+        Job job;
+        job.request = request;
+        job.callback = callback;
+        future<bool> result = job.result.get_future();
+        {
+            unique_lock<mutex> lock(mtx);
+            slotFree.wait(lock, [this]() { return inFlight < maxInFlight; });
+            inFlight++;
+            queue.push_back(move(job));
+        }
+        workAvailable.notify_one();
+        return result;
+    }
+
+    int getMaxInFlight() {
+        return maxInFlight;
+    }
+};
+
+// ----------------------------
+// Proxy class that wraps a PaymentGateway to add resilience (Proxy Pattern):
+//  - retries with jittered exponential backoff,
+//  - a circuit breaker for the wrapped gateway (fails over to the hedge
+//    gateway, if any, while open),
+//  - optional hedging: if the primary has not answered within its own p95
+//    latency, the same request is also sent to a second gateway and the
+//    first success wins.
+// A charge is not idempotent across two gateways, so a hedge can charge
+// twice. Hedging is therefore only switched on when both gateways can void
+// a charge: whichever leg succeeds second voids its own charge. Otherwise
+// the second gateway is used for failover only. Both legs run on two small
+// worker pools owned by the proxy, not on a thread per call.
 // ----------------------------
 class PaymentGatewayProxy : public PaymentGateway {
+    // Shared by the primary and hedge calls of one attempt; owns a copy of
+    // the request because the loser may finish after the caller returned.
+    struct HedgeRace {
+        mutex mtx;
+        condition_variable cv;
+        PaymentRequest request;
+        bool primaryDone;
+        bool primaryOk;
+        bool hedgeDone;
+        bool hedgeOk;
+        HedgeRace(const PaymentRequest& req) : request(req) {
+            primaryDone = primaryOk = hedgeDone = hedgeOk = false;
+        }
+    };
+
     PaymentGateway* realGateway;
     int retries;
+    RetryPolicy retryPolicy;
+    CircuitBreaker breaker;
+    PaymentGateway* hedgeGateway;
+    double hedgePercentile;
+    // Set only while hedging is on; they borrow the two gateways
+    AsyncPaymentExecutor* primaryPool;
+    AsyncPaymentExecutor* hedgePool;
+    LatencyHistogram latency;
+    atomic<long long> calls, successes, rejected, hedgesLaunched, hedgeWins, hedgeDuplicates, hedgeVoids;
+
+    void recordPrimary(long long micros, bool ok) {
+        latency.record(micros);
+        if (ok) breaker.recordSuccess();
+        else breaker.recordFailure();
+    }
+
+    bool callPrimary(PaymentRequest* request) {
+        auto start = chrono::steady_clock::now();
+        bool ok = realGateway->processPayment(request);
+        recordPrimary(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count(), ok);
+        return ok;
+    }
+
+    // Runs on a pool thread when one leg answers. If the other leg has
+    // already charged, this charge is the duplicate and is voided.
+    void finishLeg(HedgeRace& race, bool primary, bool ok) {
+        bool duplicate;
+        {
+            lock_guard<mutex> lock(race.mtx);
+            if (primary) {
+                race.primaryDone = true;
+                race.primaryOk = ok;
+                duplicate = ok && race.hedgeOk;
+            } else {
+                race.hedgeDone = true;
+                race.hedgeOk = ok;
+                duplicate = ok && race.primaryOk;
+            }
+        }
+        if (duplicate) {
+            hedgeDuplicates++;
+            if ((primary ? realGateway : hedgeGateway)->voidPayment(&race.request)) {
+                hedgeVoids++;
+            }
+        }
+        race.cv.notify_all();
+    }
+
+    bool callWithHedge(PaymentRequest* request) {
+        shared_ptr<HedgeRace> race = make_shared<HedgeRace>(*request);
+        chrono::microseconds hedgeDelay(latency.percentile(hedgePercentile));
+
+        primaryPool->submit(&race->request, [this, race](PaymentRequest*, bool ok) {
+            finishLeg(*race, true, ok);
+        });
+
+        unique_lock<mutex> lock(race->mtx);
+        if (race->cv.wait_for(lock, hedgeDelay, [&]() { return race->primaryDone; })) {
+            return race->primaryOk;
+        }
+        lock.unlock();
+
+        hedgesLaunched++;
+        PaymentLog::out() << "[Proxy] Hedging payment for " << request->sender << ".\n";
+        hedgePool->submit(&race->request, [this, race](PaymentRequest*, bool ok) {
+            finishLeg(*race, false, ok);
+        });
+
+        lock.lock();
+        race->cv.wait(lock, [&]() {
+            return race->primaryOk || race->hedgeOk || (race->primaryDone && race->hedgeDone);
+        });
+        if (!race->primaryOk && race->hedgeOk) {
+            hedgeWins++;
+        }
+        return race->primaryOk || race->hedgeOk;
+    }
+
+    void stopHedging() {
+        // Lets hedge losers still in the pools finish before the gateways go
+        delete primaryPool;
+        delete hedgePool;
+        primaryPool = hedgePool = nullptr;
+    }
+
 public:
     PaymentGatewayProxy(PaymentGateway* gateway, int maxRetries) {
         realGateway = gateway;
         retries = maxRetries;
+        retryPolicy = {20000, 500000};
+        hedgeGateway = nullptr;
+        hedgePercentile = 0.95;
+        primaryPool = hedgePool = nullptr;
+        calls = successes = rejected = hedgesLaunched = hedgeWins = hedgeDuplicates = hedgeVoids = 0;
     }
     ~PaymentGatewayProxy() {
+        stopHedging();
         delete realGateway;
+        delete hedgeGateway;
+    }
+
+    void setRetryPolicy(const RetryPolicy& policy) {
+        retryPolicy = policy;
+    }
+
+    // Takes ownership of the second gateway. Not safe to call while
+    // payments are in progress. Returns whether hedging is on; without void
+    // support on both sides the gateway only serves as the failover.
+    bool setHedgeGateway(PaymentGateway* gateway, double percentile = 0.95, int poolSize = 16) {
+        stopHedging();
+        delete hedgeGateway;
+        hedgeGateway = gateway;
+        hedgePercentile = percentile;
+        if (gateway && realGateway->supportsVoid() && gateway->supportsVoid()) {
+            primaryPool = new AsyncPaymentExecutor(realGateway, poolSize, [this](long long micros, bool ok) {
+                recordPrimary(micros, ok);
+            }, false);
+            hedgePool = new AsyncPaymentExecutor(gateway, poolSize, nullptr, false);
+        }
+        return primaryPool != nullptr;
     }
+
     bool processPayment(PaymentRequest* request) override {
         bool result = false;
         for (int attempt = 0; attempt < retries; ++attempt) {
             if (attempt > 0) {
-                cout << "[Proxy] Retrying payment (attempt " << (attempt+1)
-                          << ") for " << request->sender << ".\n";
+                chrono::microseconds delay = retryPolicy.delayFor(attempt);
+                PaymentLog::out() << "[Proxy] Retrying payment (attempt " << (attempt+1)
+                          << ") for " << request->sender << " after " << delay.count() << "us.\n";
+                this_thread::sleep_for(delay);
+            }
+            calls++;
+            if (!breaker.allowRequest()) {
+                rejected++;
+                if (hedgeGateway) {
+                    PaymentLog::out() << "[Proxy] Circuit open, failing over for " << request->sender << ".\n";
+                    result = hedgeGateway->processPayment(request);
+                } else {
+                    // Counts as a failed attempt; the backoff gives the breaker time to half-open
+                    PaymentLog::out() << "[Proxy] Circuit open, rejecting attempt for " << request->sender << ".\n";
+                }
+            } else if (primaryPool && latency.count() >= 20) {
+                result = callWithHedge(request);
+            } else {
+                result = callPrimary(request);
             }
-            result = realGateway->processPayment(request);
             if (result) break;
         }
-        if (!result) {
-            cout << "[Proxy] Payment failed after " << (retries)
+        if (result) {
+            successes++;
+        } else {
+            PaymentLog::out() << "[Proxy] Payment failed after " << (retries)
                       << " attempts for " << request->sender << ".\n";
         }
         return result;
     }
+
+    void exportMetrics(ostream& out, const string& label) {
+        long long n = calls.load();
+        out << "  [" << label << "] calls=" << n << " successes=" << successes
+            << " rejected-by-breaker=" << rejected << " breaker=" << breaker.getStateName()
+            << " (opened " << breaker.getTimesOpened() << "x)"
+            << " hedging=" << (primaryPool ? "on" : "off") << " hedges=" << hedgesLaunched
+            << " hedge-wins=" << hedgeWins << " hedge-duplicates=" << hedgeDuplicates
+            << " (voided " << hedgeVoids << ")\n";
+        out << "  [" << label << "] primary latency us: p50=" << latency.percentile(0.50)
+            << " p95=" << latency.percentile(0.95) << " p99=" << latency.percentile(0.99)
+            << " max=" << latency.max() << " mean=" << (long long)latency.mean() << "\n";
+        latency.print(out);
+    }
+
+    bool supportsVoid() override {
+        return realGateway->supportsVoid();
+    }
+    // The charge may have gone through the failover gateway instead
+    bool voidPayment(PaymentRequest* request) override {
+        return realGateway->voidPayment(request) || (hedgeGateway && hedgeGateway->voidPayment(request));
+    }
+    ChargeStatus lookupPayment(PaymentRequest* request) override {
+        ChargeStatus status = realGateway->lookupPayment(request);
+        if (!hedgeGateway || status == ChargeStatus::CHARGED) {
+            return status;
+        }
+        // Not charged only if neither gateway charged it
+        ChargeStatus hedged = hedgeGateway->lookupPayment(request);
+        if (hedged == status || hedged == ChargeStatus::CHARGED) {
+            return hedged;
+        }
+        return ChargeStatus::UNKNOWN;
+    }
+
     bool validatePayment(PaymentRequest* request) override {
         return realGateway->validatePayment(request);
     }
@@ -200,6 +1045,12 @@ enum class GatewayType {
     RAZORPAY
 };
 
+const int GATEWAY_TYPE_COUNT = 2;
+
+const char* getGatewayName(GatewayType type) {
+    return type == GatewayType::PAYTM ? "Paytm" : "Razorpay";
+}
+
 class GatewayFactory {
 private:
     static GatewayFactory instance;
@@ -212,12 +1063,13 @@ public:
     static GatewayFactory& getInstance() {
         return instance;
     }
-    PaymentGateway* getGateway(GatewayType type) {
+    // bank overrides the gateway's default banking system (e.g. a simulator)
+    PaymentGateway* getGateway(GatewayType type, BankingSystem* bank = nullptr) {
         if (type == GatewayType::PAYTM) {
-            PaymentGateway* paymentGateway = new PaytmGateway();
+            PaymentGateway* paymentGateway = new PaytmGateway(bank);
             return new PaymentGatewayProxy(paymentGateway, 3);
         } else {
-            PaymentGateway* paymentGateway = new RazorpayGateway();
+            PaymentGateway* paymentGateway = new RazorpayGateway(bank);
             return new PaymentGatewayProxy(paymentGateway, 1);
         }
     }
@@ -227,38 +1079,806 @@ public:
 GatewayFactory GatewayFactory::instance;
 
 // ----------------------------
-// Unified API service (Singleton)
+// Live routing between gateways. Every payment the service makes feeds an
+// EWMA of latency and success rate for its gateway type. A request goes to
+// one of the gateways allowed for its currency, picked at random with weight
+// 1/cost^2 where cost = latency / success rate (expected time to a success),
+// so the best gateway takes most traffic without starving the others of
+// samples. The remaining gateways, cheapest first, are the fallback order.
+// Reads never lock: the stats are atomics and the currency rules are an
+// immutable table swapped in by pointer (old tables live until the router
+// is destroyed, so readers never see a freed one).
 // ----------------------------
-class PaymentService {
+struct RoutingRules {
+    unordered_map<string, vector<GatewayType>> byCurrency;
+    vector<GatewayType> otherCurrencies;
+};
+
+struct RouteRanking {
+    GatewayType order[GATEWAY_TYPE_COUNT];
+    int count;
+};
+
+class GatewayRouter {
 private:
-    static PaymentService instance;
-    PaymentGateway* gateway;
+    struct alignas(64) GatewayStats {
+        atomic<double> latencyMicros;
+        atomic<double> successRate;
+        atomic<long long> samples;
+    };
 
-    PaymentService() { 
-        gateway = nullptr; 
+    GatewayStats stats[GATEWAY_TYPE_COUNT];
+    atomic<const RoutingRules*> rules;
+    vector<const RoutingRules*> retired;
+    mutex writeMtx;
+    double latencyAlpha;
+    double successAlpha;
+    double minSuccessRate;
+
+    static void blend(atomic<double>& value, double sample, double alpha) {
+        double old = value.load(memory_order_relaxed);
+        while (!value.compare_exchange_weak(old, old + alpha * (sample - old), memory_order_relaxed)) {
+        }
     }
-    ~PaymentService() { 
-        delete gateway; 
+
+    static mt19937_64& rng() {
+        static thread_local mt19937_64 generator(random_device{}());
+        return generator;
     }
 
-    // Private constructor and delete copy/assignment to ensure no one can clone or reassign your singleton.
+    // Caller holds writeMtx
+    void publish(RoutingRules* next) {
+        retired.push_back(rules.exchange(next, memory_order_acq_rel));
+    }
+
+public:
+    GatewayRouter(double latencyAlpha = 0.1, double successAlpha = 0.05, double minSuccessRate = 0.2) {
+        this->latencyAlpha = latencyAlpha;
+        this->successAlpha = successAlpha;
+        this->minSuccessRate = minSuccessRate;
+        // No samples yet: optimistic, so a new gateway gets tried straight away
+        for (int i = 0; i < GATEWAY_TYPE_COUNT; i++) {
+            stats[i].latencyMicros = 0.0;
+            stats[i].successRate = 1.0;
+            stats[i].samples = 0;
+        }
+        RoutingRules* initial = new RoutingRules();
+        for (int i = 0; i < GATEWAY_TYPE_COUNT; i++) {
+            initial->otherCurrencies.push_back((GatewayType)i);
+        }
+        rules = initial;
+    }
+
+    ~GatewayRouter() {
+        delete rules.load();
+        for (const RoutingRules* old : retired) {
+            delete old;
+        }
+    }
+
+    // Gateways allowed for a currency
+    void setCurrencyRule(const string& currency, const vector<GatewayType>& allowed) {
+        lock_guard<mutex> lock(writeMtx);
+        RoutingRules* next = new RoutingRules(*rules.load());
+        next->byCurrency[currency] = allowed;
+        publish(next);
+    }
+
+    // Gateways allowed for currencies without a rule of their own
+    void setDefaultRule(const vector<GatewayType>& allowed) {
+        lock_guard<mutex> lock(writeMtx);
+        RoutingRules* next = new RoutingRules(*rules.load());
+        next->otherCurrencies = allowed;
+        publish(next);
+    }
+
+    void recordResult(GatewayType type, long long micros, bool ok) {
+        GatewayStats& s = stats[(int)type];
+        if (s.samples.fetch_add(1, memory_order_relaxed) == 0) {
+            s.latencyMicros.store((double)micros, memory_order_relaxed);
+        } else {
+            blend(s.latencyMicros, (double)micros, latencyAlpha);
+        }
+        blend(s.successRate, ok ? 1.0 : 0.0, successAlpha);
+    }
+
+    // Gateways to try for this request, in order. Healthy gateways come
+    // first: one of them is picked at random, weighted towards low cost, and
+    // the rest follow by cost. Gateways below minSuccessRate come after every
+    // healthy one, also by cost, however fast they are.
+    RouteRanking route(const PaymentRequest& request) {
+        const RoutingRules* current = rules.load(memory_order_acquire);
+        auto it = current->byCurrency.find(request.currency);
+        const vector<GatewayType>& allowed = it != current->byCurrency.end() ? it->second : current->otherCurrencies;
+
+        RouteRanking ranking;
+        ranking.count = 0;
+        double cost[GATEWAY_TYPE_COUNT];
+        double weight[GATEWAY_TYPE_COUNT];
+        bool healthy[GATEWAY_TYPE_COUNT];
+        double totalWeight = 0;
+        int healthyCount = 0;
+        for (GatewayType type : allowed) {
+            const GatewayStats& s = stats[(int)type];
+            double success = s.successRate.load(memory_order_relaxed);
+            double c = (s.latencyMicros.load(memory_order_relaxed) + 1.0) / max(success, 0.01);
+            bool h = success >= minSuccessRate;
+            double w = h ? 1.0 / (c * c) : 0.0;
+            // Insertion sort, healthy before unhealthy, then by cost; there
+            // are only a handful of gateways
+            int pos = ranking.count++;
+            while (pos > 0 && (healthy[pos - 1] == h ? cost[pos - 1] > c : h)) {
+                ranking.order[pos] = ranking.order[pos - 1];
+                cost[pos] = cost[pos - 1];
+                weight[pos] = weight[pos - 1];
+                healthy[pos] = healthy[pos - 1];
+                pos--;
+            }
+            ranking.order[pos] = type;
+            cost[pos] = c;
+            weight[pos] = w;
+            healthy[pos] = h;
+            totalWeight += w;
+            healthyCount += h;
+        }
+
+        // The pick stays within the healthy prefix
+        if (healthyCount > 1 && totalWeight > 0) {
+            double pick = uniform_real_distribution<double>(0.0, totalWeight)(rng());
+            int chosen = 0;
+            while (chosen < healthyCount - 1 && pick >= weight[chosen]) {
+                pick -= weight[chosen];
+                chosen++;
+            }
+            GatewayType first = ranking.order[chosen];
+            for (int i = chosen; i > 0; i--) {
+                ranking.order[i] = ranking.order[i - 1];
+            }
+            ranking.order[0] = first;
+        }
+        return ranking;
+    }
+
+    double getLatencyMicros(GatewayType type) {
+        return stats[(int)type].latencyMicros.load(memory_order_relaxed);
+    }
+
+    double getSuccessRate(GatewayType type) {
+        return stats[(int)type].successRate.load(memory_order_relaxed);
+    }
+
+    long long getSamples(GatewayType type) {
+        return stats[(int)type].samples.load(memory_order_relaxed);
+    }
+
+    void print(ostream& os) {
+        for (int i = 0; i < GATEWAY_TYPE_COUNT; i++) {
+            GatewayType type = (GatewayType)i;
+            os << "[Router] " << getGatewayName(type) << ": " << getSamples(type) << " payments, ewma latency "
+               << (long long)getLatencyMicros(type) << "us, success rate " << getSuccessRate(type) << "\n";
+        }
+    }
+};
+
+// ----------------------------
+// Durable write-ahead log of payment attempts. A "B" record (the full
+// request) is on disk before the gateway is called and an "E" record
+// (the outcome) before the caller hears the result, so after a crash every
+// begun-but-unfinished payment can be found again. Appends from all threads
+// are batched by a flusher thread into one write + fdatasync (group commit);
+// each appender waits only until its own record is durable. If a write or
+// sync fails the journal is poisoned: the waiting appenders and every later
+// one get the error as a runtime_error, and nothing is reported as durable.
+// Record format, one per line: B<TAB>key<TAB>sender<TAB>receiver<TAB>amount<TAB>currency
+//                              E<TAB>key<TAB>1|0
+// ----------------------------
+struct JournalRecovery {
+    vector<PaymentRequest> pending;         // begun, no outcome logged
+    vector<pair<string, bool>> completed;   // key, succeeded
+    long long records;
+    long long tornBytes;                    // partial last record dropped
+};
+
+// What recoverPendingPayments() did with each unfinished payment
+struct RecoveryReport {
+    int alreadyCharged;     // the bank had charged it; recorded as succeeded
+    int resumed;            // the bank had not; charged again under its key
+    int resumedOk;
+    int unresolved;         // no bank could say; held for reconciliation
+};
+
+class PaymentJournal {
+private:
+    int fd;
+    bool groupCommit;
+    string buffer;
+    uint64_t appendedSeq;
+    uint64_t durableSeq;
+    bool stopping;
+    long long syncs;
+    string failure;     // first write/sync error; set once, never cleared
+    mutex mtx;
+    condition_variable pending;
+    condition_variable durable;
+    thread flusher;
+
+    // Writes data and syncs it, retrying interrupted calls. Returns an
+    // error description, or an empty string once data is on disk.
+    string writeDurably(const string& data) {
+        size_t done = 0;
+        while (done < data.size()) {
+            ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return string("payment journal write failed: ") + strerror(errno);
+            }
+            done += n;
+        }
+        int synced;
+        do {
+            synced = ::fdatasync(fd);
+        } while (synced != 0 && errno == EINTR);
+        if (synced != 0) {
+            return string("payment journal sync failed: ") + strerror(errno);
+        }
+        return "";
+    }
+
+    // A failed write or sync leaves the file's tail unknown, so the journal
+    // stops accepting records: every waiting and later append() throws.
+    void flushLoop() {
+        unique_lock<mutex> lock(mtx);
+        while (true) {
+            pending.wait(lock, [this]() { return stopping || !buffer.empty(); });
+            if (buffer.empty()) {
+                return;
+            }
+            string batch;
+            batch.swap(buffer);
+            uint64_t batchSeq = appendedSeq;
+            lock.unlock();
+            string error = writeDurably(batch);
+            lock.lock();
+            syncs++;
+            if (!error.empty()) {
+                failure = error;
+                durable.notify_all();
+                return;
+            }
+            durableSeq = batchSeq;
+            durable.notify_all();
+        }
+    }
+
+    // Blocks until the record is on disk; throws if it cannot get there
+    void append(const string& record) {
+        unique_lock<mutex> lock(mtx);
+        if (!failure.empty()) {
+            throw runtime_error(failure);
+        }
+        if (!groupCommit) {
+            string error = writeDurably(record);
+            syncs++;
+            if (!error.empty()) {
+                failure = error;
+                throw runtime_error(failure);
+            }
+            return;
+        }
+        buffer += record;
+        uint64_t seq = ++appendedSeq;
+        pending.notify_one();
+        durable.wait(lock, [this, seq]() { return durableSeq >= seq || !failure.empty(); });
+        if (durableSeq < seq) {
+            throw runtime_error(failure);
+        }
+    }
+
+    static string formatAmount(double amount) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.17g", amount);
+        return text;
+    }
+
+public:
+    // Opens (or creates) the journal at path, dropping a torn last record.
+    // Call recover() first to read what is already there.
+    PaymentJournal(const string& path, bool groupCommit = true) {
+        this->groupCommit = groupCommit;
+        appendedSeq = durableSeq = 0;
+        stopping = false;
+        syncs = 0;
+        // Read access too: the torn-tail scan below reads the file
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) {
+            throw runtime_error("cannot open payment journal " + path);
+        }
+        off_t size = ::lseek(fd, 0, SEEK_END);
+        off_t complete = size;
+        while (complete > 0) {
+            char last;
+            ssize_t n = ::pread(fd, &last, 1, complete - 1);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n != 1) {
+                ::close(fd);
+                throw runtime_error("cannot read payment journal " + path);
+            }
+            if (last == '\n') {
+                break;
+            }
+            complete--;
+        }
+        if (complete != size && (::ftruncate(fd, complete) != 0 || ::fdatasync(fd) != 0)) {
+            ::close(fd);
+            throw runtime_error("cannot repair payment journal " + path);
+        }
+        if (groupCommit) {
+            flusher = thread(&PaymentJournal::flushLoop, this);
+        }
+    }
+
+    ~PaymentJournal() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        pending.notify_one();
+        if (flusher.joinable()) {
+            flusher.join();
+        }
+        ::close(fd);
+    }
+
+    static JournalRecovery recover(const string& path) {
+        JournalRecovery result;
+        result.records = 0;
+        result.tornBytes = 0;
+        ifstream in(path, ios::binary);
+        unordered_map<string, size_t> open;
+        vector<PaymentRequest> begun;
+        string line;
+        while (getline(in, line)) {
+            if (in.eof()) {
+                result.tornBytes = line.size();
+                break;
+            }
+            vector<string> fields;
+            stringstream parts(line);
+            string field;
+            while (getline(parts, field, '\t')) {
+                fields.push_back(field);
+            }
+            result.records++;
+            if (fields.size() == 6 && fields[0] == "B") {
+                open[fields[1]] = begun.size();
+                begun.emplace_back(fields[2], fields[3], atof(fields[4].c_str()), fields[5], fields[1]);
+            } else if (fields.size() == 3 && fields[0] == "E") {
+                open.erase(fields[1]);
+                result.completed.push_back({fields[1], fields[2] == "1"});
+            }
+        }
+        for (auto& entry : open) {
+            result.pending.push_back(begun[entry.second]);
+        }
+        return result;
+    }
+
+    void logBegin(const PaymentRequest& request) {
+        append("B\t" + request.idempotencyKey + "\t" + request.sender + "\t" + request.reciever + "\t"
+               + formatAmount(request.amount) + "\t" + request.currency + "\n");
+    }
+
+    void logEnd(const PaymentRequest& request, bool ok) {
+        append("E\t" + request.idempotencyKey + "\t" + (ok ? "1\n" : "0\n"));
+    }
+
+    long long getSyncs() {
+        lock_guard<mutex> lock(mtx);
+        return syncs;
+    }
+};
+
+// ----------------------------
+// In-memory "already processed?" index keyed by idempotency key. Sharded
+// hash maps, so a lookup is O(1) and contends only with its own shard.
+// A key that succeeded stays done; one that failed may be attempted again
+// (the bank declined, nothing was charged). A duplicate that arrives while
+// the first attempt is still running waits for its outcome. A key held for
+// reconciliation (outcome unknown after a crash) is refused until the
+// outcome is known. Settled keys are never evicted: a forgotten key that
+// already succeeded would be charged again when resubmitted. Memory grows
+// by roughly 100 bytes per key, so one index covers millions of payments.
+// ----------------------------
+class PaymentDedupIndex {
+public:
+    enum Claim { CLAIMED, ALREADY_SUCCEEDED, DUPLICATE_FAILED, UNRESOLVED };
+
+private:
+    enum State { IN_PROGRESS, SUCCEEDED, FAILED, HELD };
+
+    static const int SHARDS = 64;
+    struct alignas(64) Shard {
+        mutex mtx;
+        condition_variable settled;
+        unordered_map<string, State> states;
+    };
+    Shard shards[SHARDS];
+
+    Shard& shardFor(const string& key) {
+        return shards[hash<string>()(key) % SHARDS];
+    }
+
+public:
+
+    // CLAIMED: the caller must charge and then call finish()
+    Claim claim(const string& key) {
+        Shard& shard = shardFor(key);
+        unique_lock<mutex> lock(shard.mtx);
+        while (true) {
+            auto it = shard.states.find(key);
+            if (it == shard.states.end()) {
+                shard.states.emplace(key, IN_PROGRESS);
+                return CLAIMED;
+            }
+            if (it->second == SUCCEEDED) {
+                return ALREADY_SUCCEEDED;
+            }
+            if (it->second == HELD) {
+                return UNRESOLVED;
+            }
+            if (it->second == FAILED) {
+                it->second = IN_PROGRESS;
+                return CLAIMED;
+            }
+            // Someone else is charging this key; take their outcome
+            shard.settled.wait(lock);
+            it = shard.states.find(key);
+            if (it != shard.states.end() && it->second == HELD) {
+                return UNRESOLVED;
+            }
+            if (it != shard.states.end() && it->second != IN_PROGRESS) {
+                return it->second == SUCCEEDED ? ALREADY_SUCCEEDED : DUPLICATE_FAILED;
+            }
+        }
+    }
+
+    void finish(const string& key, bool ok) {
+        Shard& shard = shardFor(key);
+        {
+            lock_guard<mutex> lock(shard.mtx);
+            shard.states[key] = ok ? SUCCEEDED : FAILED;
+        }
+        shard.settled.notify_all();
+    }
+
+    // Refuse the key until finish() is called with its real outcome
+    void hold(const string& key) {
+        Shard& shard = shardFor(key);
+        lock_guard<mutex> lock(shard.mtx);
+        shard.states[key] = HELD;
+    }
+
+    // Outcome read back from the journal
+    void restore(const string& key, bool ok) {
+        Shard& shard = shardFor(key);
+        lock_guard<mutex> lock(shard.mtx);
+        shard.states[key] = ok ? SUCCEEDED : FAILED;
+    }
+
+    size_t size() {
+        size_t total = 0;
+        for (Shard& shard : shards) {
+            lock_guard<mutex> lock(shard.mtx);
+            total += shard.states.size();
+        }
+        return total;
+    }
+};
+
+// ----------------------------
+// Unified API service (Singleton)
+// ----------------------------
+class PaymentService {
+private:
+    static PaymentService instance;
+    // One gateway per type, created on first use and shared by all callers
+    atomic<PaymentGateway*> gateways[GATEWAY_TYPE_COUNT];
+    atomic<AsyncPaymentExecutor*> executors[GATEWAY_TYPE_COUNT];
+    mutex configMtx;
+    GatewayRouter router;
+    PaymentDedupIndex* dedup;
+    PaymentJournal* journal;
+    vector<PaymentRequest> recovered;
+    vector<PaymentRequest> unresolved;
+
+    PaymentService() { 
+        for (int i = 0; i < GATEWAY_TYPE_COUNT; i++) {
+            gateways[i] = nullptr;
+            executors[i] = nullptr;
+        }
+        journal = nullptr;
+        dedup = new PaymentDedupIndex();
+        // Paytm only accepts INR
+        router.setCurrencyRule("INR", {GatewayType::PAYTM, GatewayType::RAZORPAY});
+        router.setDefaultRule({GatewayType::RAZORPAY});
+    }
+    ~PaymentService() { 
+        for (int i = 0; i < GATEWAY_TYPE_COUNT; i++) {
+            delete executors[i].load();
+            delete gateways[i].load();
+        }
+        delete journal;
+        delete dedup;
+    }
+    // Private constructor and delete copy/assignment to ensure no one can clone or reassign your singleton.
     PaymentService(const PaymentService&) = delete;
     PaymentService& operator=(const PaymentService&) = delete;
 
+    PaymentGateway* getGateway(GatewayType type) {
+        PaymentGateway* gateway = gateways[(int)type].load(memory_order_acquire);
+        if (!gateway) {
+            lock_guard<mutex> lock(configMtx);
+            gateway = gateways[(int)type].load();
+            if (!gateway) {
+                gateway = GatewayFactory::getInstance().getGateway(type);
+                gateways[(int)type].store(gateway, memory_order_release);
+            }
+        }
+        return gateway;
+    }
+
+    PaymentObserver observerFor(GatewayType type) {
+        return [this, type](long long micros, bool ok) {
+            router.recordResult(type, micros, ok);
+        };
+    }
+
+    // false: the key was already settled and result holds its outcome
+    bool beginPayment(PaymentRequest* request, bool& result) {
+        PaymentDedupIndex::Claim claim = dedup->claim(request->idempotencyKey);
+        if (claim == PaymentDedupIndex::UNRESOLVED) {
+            PaymentLog::out() << "[PaymentService] Payment " << request->idempotencyKey << " is awaiting reconciliation.\n";
+            result = false;
+            return false;
+        }
+        if (claim != PaymentDedupIndex::CLAIMED) {
+            PaymentLog::out() << "[PaymentService] Payment " << request->idempotencyKey << " already processed.\n";
+            result = claim == PaymentDedupIndex::ALREADY_SUCCEEDED;
+            return false;
+        }
+        if (journal) {
+            try {
+                journal->logBegin(*request);
+            } catch (...) {
+                // Not journaled, so not attempted; the key may be retried
+                dedup->finish(request->idempotencyKey, false);
+                throw;
+            }
+        }
+        return true;
+    }
+
+    // Settles the key even if the outcome cannot be journaled; the begin
+    // record is durable, so recovery will ask the bank about it after a crash.
+    void finishPayment(PaymentRequest* request, bool ok) {
+        if (journal) {
+            try {
+                journal->logEnd(*request, ok);
+            } catch (...) {
+                dedup->finish(request->idempotencyKey, ok);
+                throw;
+            }
+        }
+        dedup->finish(request->idempotencyKey, ok);
+    }
+
+    bool processWith(GatewayType type, PaymentRequest* request) {
+        auto start = chrono::steady_clock::now();
+        bool ok = getGateway(type)->processPayment(request);
+        router.recordResult(type, chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count(), ok);
+        return ok;
+    }
+
 public:
     static PaymentService& getInstance() {
         return instance;
     }
-    void setGateway(PaymentGateway* g) {
-        if (gateway) delete gateway;
-        gateway = g;
+
+    GatewayRouter& getRouter() {
+        return router;
+    }
+
+    // Replace the gateway for a type. Not safe to call while payments of
+    // that type are in progress; the old gateway is deleted.
+    void setGateway(GatewayType type, PaymentGateway* g) {
+        lock_guard<mutex> lock(configMtx);
+        PaymentGateway* old = gateways[(int)type].exchange(g);
+        delete old;
+    }
+
+    // Make payments durable: attempts are journaled at path, and whatever
+    // the journal already holds is loaded. Settled keys go into the dedup
+    // index; payments that were begun but never finished are kept for
+    // recoverPendingPayments(). Call before any payment is made.
+    size_t openJournal(const string& path, bool groupCommit = true) {
+        JournalRecovery state = PaymentJournal::recover(path);
+        for (auto& done : state.completed) {
+            dedup->restore(done.first, done.second);
+        }
+        recovered = state.pending;
+        delete journal;
+        journal = new PaymentJournal(path, groupCommit);
+        return recovered.size();
+    }
+
+    // Settle payments a crash left unfinished without charging anyone
+    // twice. The bank may have charged before the outcome reached the
+    // journal, so every gateway is asked about the key first: charged ones
+    // are recorded as succeeded, uncharged ones are re-driven under their
+    // original key, and ones no bank can vouch for are held (resubmissions
+    // are refused) until reconcilePayment() is given the outcome.
+    RecoveryReport recoverPendingPayments() {
+        RecoveryReport report = {0, 0, 0, 0};
+        for (PaymentRequest& request : recovered) {
+            ChargeStatus status = ChargeStatus::NOT_CHARGED;
+            for (int i = 0; i < GATEWAY_TYPE_COUNT && status != ChargeStatus::CHARGED; i++) {
+                ChargeStatus atGateway = getGateway((GatewayType)i)->lookupPayment(&request);
+                if (atGateway != ChargeStatus::NOT_CHARGED) {
+                    status = atGateway;
+                }
+            }
+            if (status == ChargeStatus::CHARGED) {
+                PaymentLog::out() << "[PaymentService] Payment " << request.idempotencyKey << " was charged before the crash.\n";
+                dedup->claim(request.idempotencyKey);
+                finishPayment(&request, true);
+                report.alreadyCharged++;
+            } else if (status == ChargeStatus::NOT_CHARGED) {
+                PaymentLog::out() << "[PaymentService] Resuming payment " << request.idempotencyKey << ".\n";
+                report.resumed++;
+                if (processPayment(&request)) {
+                    report.resumedOk++;
+                }
+            } else {
+                PaymentLog::out() << "[PaymentService] Payment " << request.idempotencyKey << " needs reconciliation.\n";
+                dedup->hold(request.idempotencyKey);
+                unresolved.push_back(request);
+                report.unresolved++;
+            }
+        }
+        recovered.clear();
+        return report;
+    }
+
+    // Held payments whose outcome is still unknown
+    const vector<PaymentRequest>& getUnresolvedPayments() {
+        return unresolved;
+    }
+
+    // Outcome of a held payment, found out of band (bank statement, support)
+    bool reconcilePayment(const string& idempotencyKey, bool charged) {
+        for (size_t i = 0; i < unresolved.size(); i++) {
+            if (unresolved[i].idempotencyKey == idempotencyKey) {
+                finishPayment(&unresolved[i], charged);
+                unresolved.erase(unresolved.begin() + i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Install another dedup index and hand back the old one (the caller
+    // owns it). Benchmarks use this to run against a fresh index. Not safe
+    // while payments are in progress.
+    PaymentDedupIndex* swapDedupIndex(PaymentDedupIndex* index) {
+        PaymentDedupIndex* old = dedup;
+        dedup = index;
+        return old;
+    }
+
+    PaymentJournal* getJournal() {
+        return journal;
+    }
+
+    // Stop journaling. Not safe while payments are in progress.
+    void closeJournal() {
+        delete journal;
+        journal = nullptr;
+    }
+
+    bool processPayment(GatewayType type, PaymentRequest* request) {
+        bool ok = false;
+        if (!beginPayment(request, ok)) {
+            return ok;
+        }
+        try {
+            ok = processWith(type, request);
+        } catch (...) {
+            // Never leave the key in progress; duplicates would wait forever
+            finishPayment(request, false);
+            throw;
+        }
+        finishPayment(request, ok);
+        return ok;
     }
+
+    // Let the router pick the gateway, falling back down its ranking
     bool processPayment(PaymentRequest* request) {
-        if (!gateway) {
-            cout << "[PaymentService] No payment gateway selected.\n";
-            return false;
+        bool ok = false;
+        if (!beginPayment(request, ok)) {
+            return ok;
         }
-        return gateway->processPayment(request);
+        RouteRanking ranking = router.route(*request);
+        if (ranking.count == 0) {
+            PaymentLog::out() << "[PaymentService] No payment gateway accepts " << request->currency << ".\n";
+        }
+        try {
+            for (int i = 0; i < ranking.count && !ok; i++) {
+                if (i > 0) {
+                    PaymentLog::out() << "[PaymentService] Falling back to " << getGatewayName(ranking.order[i]) << ".\n";
+                }
+                ok = processWith(ranking.order[i], request);
+            }
+        } catch (...) {
+            finishPayment(request, false);
+            throw;
+        }
+        finishPayment(request, ok);
+        return ok;
+    }
+
+    // Configure the async path for a gateway type. Not safe to call while
+    // payments of that type are being submitted.
+    void setAsyncGateway(GatewayType type, PaymentGateway* g, int maxInFlight) {
+        lock_guard<mutex> lock(configMtx);
+        AsyncPaymentExecutor* old = executors[(int)type].exchange(new AsyncPaymentExecutor(g, maxInFlight, observerFor(type)));
+        delete old;
+    }
+
+    future<bool> processPaymentAsync(GatewayType type, PaymentRequest* request, PaymentCallback callback = nullptr) {
+        bool settled;
+        if (!beginPayment(request, settled)) {
+            if (callback) {
+                callback(request, settled);
+            }
+            promise<bool> done;
+            done.set_value(settled);
+            return done.get_future();
+        }
+        AsyncPaymentExecutor* executor = executors[(int)type].load();
+        if (!executor) {
+            lock_guard<mutex> lock(configMtx);
+            executor = executors[(int)type].load();
+            if (!executor) {
+                executor = new AsyncPaymentExecutor(GatewayFactory::getInstance().getGateway(type), 8, observerFor(type));
+                executors[(int)type] = executor;
+            }
+        }
+        return executor->submit(request, [this, callback](PaymentRequest* req, bool ok) {
+            finishPayment(req, ok);
+            if (callback) {
+                callback(req, ok);
+            }
+        });
+    }
+
+    // Routed async payment. Goes to the router's first choice only; there
+    // is no fallback once the request is queued.
+    future<bool> processPaymentAsync(PaymentRequest* request, PaymentCallback callback = nullptr) {
+        RouteRanking ranking = router.route(*request);
+        if (ranking.count == 0) {
+            PaymentLog::out() << "[PaymentService] No payment gateway accepts " << request->currency << ".\n";
+            if (callback) {
+                callback(request, false);
+            }
+            promise<bool> rejected;
+            rejected.set_value(false);
+            return rejected.get_future();
+        }
+        return processPaymentAsync(ranking.order[0], request, callback);
     }
 };
 
@@ -278,18 +1898,414 @@ public:
         return instance;
     }
     bool handlePayment(GatewayType type, PaymentRequest* req) {
-        PaymentGateway* paymentGateway = GatewayFactory::getInstance().getGateway(type);
-        PaymentService::getInstance().setGateway(paymentGateway);
+        return PaymentService::getInstance().processPayment(type, req);
+    }
+    // Smart routing: the service picks the gateway
+    bool handlePayment(PaymentRequest* req) {
         return PaymentService::getInstance().processPayment(req);
     }
+    future<bool> handlePaymentAsync(GatewayType type, PaymentRequest* req, PaymentCallback onComplete = nullptr) {
+        return PaymentService::getInstance().processPaymentAsync(type, req, onComplete);
+    }
+    future<bool> handlePaymentAsync(PaymentRequest* req, PaymentCallback onComplete = nullptr) {
+        return PaymentService::getInstance().processPaymentAsync(req, onComplete);
+    }
 };
 
 PaymentController PaymentController::instance;
 
+// ----------------------------
+// Benchmark: async throughput against a slow simulated bank as the
+// in-flight window grows
+// ----------------------------
+void runAsyncBenchmark() {
+    const int requests = 400;
+    const int latencyMicros = 2000;
+    const double failureRate = 0.1;
+    cout << "=== ASYNC PAYMENT BENCHMARK: " << requests << " requests, bank latency "
+         << latencyMicros << "us, failure rate " << failureRate << " ===\n";
+    cout << "Window | payments/sec | succeeded\n";
+
+    PaymentLog::setEnabled(false);
+    int windows[] = {1, 4, 16, 64};
+    for (int window : windows) {
+        // Fresh requests each round; reused ones would be deduplicated
+        vector<PaymentRequest*> reqs;
+        for (int i = 0; i < requests; i++) {
+            reqs.push_back(new PaymentRequest("User" + to_string(i), "Merchant", 100.0 + i, "INR"));
+        }
+        BankingSystem* bank = new SimulatedBankingSystem(latencyMicros, latencyMicros / 4, failureRate);
+        PaymentService::getInstance().setAsyncGateway(GatewayType::PAYTM,
+            GatewayFactory::getInstance().getGateway(GatewayType::PAYTM, bank), window);
+
+        atomic<int> succeeded(0);
+        vector<future<bool>> results;
+        auto start = chrono::steady_clock::now();
+        for (PaymentRequest* req : reqs) {
+            results.push_back(PaymentController::getInstance().handlePaymentAsync(GatewayType::PAYTM, req,
+                [&succeeded](PaymentRequest*, bool ok) {
+                    if (ok) succeeded++;
+                }));
+        }
+        for (future<bool>& result : results) {
+            result.get();
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "  " << window << "\t| " << (long long)(requests / seconds) << "\t\t| " << succeeded << "\n";
+        for (PaymentRequest* req : reqs) {
+            delete req;
+        }
+    }
+    PaymentLog::setEnabled(true);
+}
+
+// ----------------------------
+// Resilience validation against the fault-injecting bank stub
+// ----------------------------
+void driveLoad(PaymentGateway* gateway, int clients, int perClient, LatencyHistogram& endToEnd, atomic<int>& succeeded) {
+    vector<thread> threads;
+    for (int c = 0; c < clients; c++) {
+        threads.emplace_back([&, c]() {
+            for (int i = 0; i < perClient; i++) {
+                PaymentRequest req("Client" + to_string(c), "Merchant", 100.0 + i, "INR");
+                auto start = chrono::steady_clock::now();
+                if (gateway->processPayment(&req)) {
+                    succeeded++;
+                }
+                endToEnd.record(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count());
+            }
+        });
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+}
+
+void runResilienceBenchmark() {
+    PaymentLog::setEnabled(false);
+
+    cout << "=== RESILIENCE: 5% slow (30ms) bank calls, with and without hedging ===\n";
+    // Banks that cannot void a charge must not be hedged; the proxy refuses
+    PaymentGatewayProxy unsafe(new PaytmGateway(new SimulatedBankingSystem(0, 0, 0.0)), 1);
+    bool unsafeHedging = unsafe.setHedgeGateway(new RazorpayGateway(new SimulatedBankingSystem(0, 0, 0.0)));
+    cout << "Banks without void: hedging " << (unsafeHedging ? "on" : "off") << "\n";
+    for (int hedge = 0; hedge < 2; hedge++) {
+        FaultInjectingBankingSystem* bank = new FaultInjectingBankingSystem(1000, 200, 0.0, 0.05, 30000, true);
+        PaymentGatewayProxy* proxy = new PaymentGatewayProxy(new PaytmGateway(bank), 3);
+        if (hedge) {
+            proxy->setHedgeGateway(GatewayFactory::getInstance().getGateway(GatewayType::RAZORPAY,
+                new SimulatedBankingSystem(1500, 300, 0.0, true)));
+        }
+        LatencyHistogram endToEnd;
+        atomic<int> succeeded(0);
+        driveLoad(proxy, 8, 50, endToEnd, succeeded);
+        cout << (hedge ? "With hedging:    " : "Without hedging: ") << succeeded << "/400 ok, end-to-end us p50="
+             << endToEnd.percentile(0.50) << " p95=" << endToEnd.percentile(0.95)
+             << " p99=" << endToEnd.percentile(0.99) << " max=" << endToEnd.max() << "\n";
+        proxy->exportMetrics(cout, hedge ? "paytm+razorpay hedge" : "paytm");
+        delete proxy;
+    }
+
+    cout << "=== RESILIENCE: bank outage, circuit breaker ===\n";
+    FaultInjectingBankingSystem* bank = new FaultInjectingBankingSystem(500, 100, 0.0, 0.0, 0);
+    PaymentGatewayProxy* proxy = new PaymentGatewayProxy(new PaytmGateway(bank), 3);
+    proxy->setRetryPolicy({1000, 20000});
+
+    bank->setOutage(true);
+    LatencyHistogram outageLatency;
+    atomic<int> outageOk(0);
+    driveLoad(proxy, 4, 50, outageLatency, outageOk);
+    long long outageCalls = bank->getCalls();
+    cout << "During outage:  " << outageOk << "/200 ok, " << outageCalls
+         << " bank calls (600 without the breaker), p99 " << outageLatency.percentile(0.99) << "us\n";
+
+    bank->setOutage(false);
+    this_thread::sleep_for(chrono::milliseconds(1100));
+    LatencyHistogram recoveredLatency;
+    atomic<int> recoveredOk(0);
+    driveLoad(proxy, 4, 50, recoveredLatency, recoveredOk);
+    cout << "After recovery: " << recoveredOk << "/200 ok, " << (bank->getCalls() - outageCalls) << " bank calls\n";
+    proxy->exportMetrics(cout, "paytm outage");
+    delete proxy;
+
+    PaymentLog::setEnabled(true);
+}
+
+// ----------------------------
+// Benchmark: routing cost, and how traffic shifts when a gateway degrades
+// ----------------------------
+void runRoutingBenchmark() {
+    PaymentLog::setEnabled(false);
+    PaymentService& service = PaymentService::getInstance();
+    GatewayRouter& router = service.getRouter();
+
+    const int routes = 1000000;
+    PaymentRequest probe("User", "Merchant", 100.0, "INR");
+    for (int threads = 1; threads <= 4; threads *= 4) {
+        vector<thread> workers;
+        atomic<long long> checksum(0);
+        auto start = chrono::steady_clock::now();
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&]() {
+                long long local = 0;
+                for (int i = 0; i < routes; i++) {
+                    local += (int)router.route(probe).order[0];
+                }
+                checksum += local;
+            });
+        }
+        for (thread& worker : workers) {
+            worker.join();
+        }
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        cout << "=== ROUTING: " << threads << " thread(s), " << (long long)(ns / routes) << " ns per route ("
+             << checksum % 2 << ") ===\n";
+    }
+
+    FaultInjectingBankingSystem* razorpayBank = new FaultInjectingBankingSystem(1000, 200, 0.02, 0.0, 0);
+    PaymentGatewayProxy* razorpay = new PaymentGatewayProxy(new RazorpayGateway(razorpayBank), 1);
+    razorpay->setRetryPolicy({500, 2000});
+    service.setGateway(GatewayType::RAZORPAY, razorpay);
+    PaymentGatewayProxy* paytm = new PaymentGatewayProxy(new PaytmGateway(new SimulatedBankingSystem(3000, 500, 0.02)), 1);
+    paytm->setRetryPolicy({500, 2000});
+    service.setGateway(GatewayType::PAYTM, paytm);
+
+    cout << "=== ROUTING: Paytm bank 3ms, Razorpay bank 1ms; Razorpay outage in phase 2 ===\n";
+    cout << "Phase           | ok      | Paytm | Razorpay\n";
+    const char* phases[] = {"healthy", "razorpay outage", "recovered"};
+    for (int phase = 0; phase < 3; phase++) {
+        razorpayBank->setOutage(phase == 1);
+        if (phase == 2) {
+            // Let the proxy's circuit breaker close again
+            this_thread::sleep_for(chrono::milliseconds(1100));
+        }
+        long long paytmBefore = router.getSamples(GatewayType::PAYTM);
+        long long razorpayBefore = router.getSamples(GatewayType::RAZORPAY);
+        atomic<int> succeeded(0);
+        vector<thread> clients;
+        for (int c = 0; c < 4; c++) {
+            clients.emplace_back([&, c]() {
+                for (int i = 0; i < 100; i++) {
+                    PaymentRequest req("Client" + to_string(c), "Merchant", 100.0 + i, "INR");
+                    if (PaymentController::getInstance().handlePayment(&req)) {
+                        succeeded++;
+                    }
+                }
+            });
+        }
+        for (thread& client : clients) {
+            client.join();
+        }
+        cout << phases[phase] << string(16 - string(phases[phase]).size(), ' ') << "| " << succeeded << "/400 | "
+             << router.getSamples(GatewayType::PAYTM) - paytmBefore << "\t| "
+             << router.getSamples(GatewayType::RAZORPAY) - razorpayBefore << "\n";
+    }
+    router.print(cout);
+
+    PaymentLog::setEnabled(true);
+}
+
+// ----------------------------
+// Benchmark: journaled payments (group commit vs one fsync per record),
+// crash recovery and dedup lookups
+// ----------------------------
+void runJournalBenchmark() {
+    PaymentLog::setEnabled(false);
+    PaymentService& service = PaymentService::getInstance();
+    // Banks with a ledger, so recovery can ask them what was charged
+    FaultInjectingBankingSystem* paytmBank = new FaultInjectingBankingSystem(0, 0, 0.0, 0.0, 0, true);
+    FaultInjectingBankingSystem* razorpayBank = new FaultInjectingBankingSystem(0, 0, 0.0, 0.0, 0, true);
+    service.setGateway(GatewayType::PAYTM, new PaytmGateway(paytmBank));
+    service.setGateway(GatewayType::RAZORPAY, new RazorpayGateway(razorpayBank));
+    const string path = "payment_journal_bench.log";
+
+    const int clients = 8;
+    const int perClient = 250;
+    cout << "=== JOURNAL: " << clients * perClient << " payments from " << clients << " threads, zero-latency bank ===\n";
+    for (int group = 0; group < 2; group++) {
+        remove(path.c_str());
+        service.openJournal(path, group == 1);
+        vector<thread> threads;
+        auto start = chrono::steady_clock::now();
+        for (int c = 0; c < clients; c++) {
+            threads.emplace_back([c]() {
+                for (int i = 0; i < perClient; i++) {
+                    PaymentRequest req("Client" + to_string(c), "Merchant", 100.0 + i, "INR");
+                    PaymentController::getInstance().handlePayment(&req);
+                }
+            });
+        }
+        for (thread& t : threads) {
+            t.join();
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        long long syncs = service.getJournal()->getSyncs();
+        cout << (group ? "Group commit:     " : "fsync per record: ") << (long long)(clients * perClient / seconds)
+             << " payments/sec, " << syncs << " fsyncs (" << (2.0 * clients * perClient / syncs) << " records each)\n";
+    }
+
+    cout << "=== JOURNAL: crash with 300 of 1000 payments unfinished, 100 of them already charged ===\n";
+    remove(path.c_str());
+    vector<string> finishedKeys;
+    {
+        PaymentJournal crashed(path);
+        for (int i = 0; i < 1000; i++) {
+            PaymentRequest req("User" + to_string(i), "Merchant", 10.0 + i, "INR");
+            crashed.logBegin(req);
+            if (i % 10 == 0) {
+                // The bank charged, then we crashed before logging the outcome
+                paytmBank->processPayment(req.amount, req.idempotencyKey);
+            } else if (i % 10 >= 3) {
+                crashed.logEnd(req, true);
+                finishedKeys.push_back(req.idempotencyKey);
+            }
+        }
+    }
+    long long intactBytes;
+    {
+        ofstream torn(path, ios::app | ios::binary);
+        intactBytes = torn.tellp();
+        torn << "B\tpay-torn\tUser";
+    }
+    long long bankCallsBefore = paytmBank->getCalls() + razorpayBank->getCalls();
+    auto start = chrono::steady_clock::now();
+    size_t pendingCount = service.openJournal(path);
+    double loadMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    RecoveryReport report = service.recoverPendingPayments();
+    cout << "Recovered " << pendingCount << " pending payments in " << loadMs << " ms: " << report.alreadyCharged
+         << " already charged, " << report.resumedOk << "/" << report.resumed << " resumed ok, "
+         << report.unresolved << " held for reconciliation\n";
+
+    int deduped = 0;
+    for (const string& key : finishedKeys) {
+        PaymentRequest retry("Retry", "Merchant", 1.0, "INR", key);
+        if (PaymentController::getInstance().handlePayment(&retry)) {
+            deduped++;
+        }
+    }
+    cout << "Resubmitted " << finishedKeys.size() << " finished payments: " << deduped << " answered from the index, "
+         << paytmBank->getCalls() + razorpayBank->getCalls() - bankCallsBefore - report.resumed << " extra bank calls\n";
+    JournalRecovery after = PaymentJournal::recover(path);
+    cout << "Journal after restart: " << after.records << " records, " << after.pending.size() << " pending, "
+         << after.tornBytes << " torn bytes\n";
+    // The torn record must be gone and the first record written after the
+    // restart must start where it began, whole
+    {
+        ifstream in(path, ios::binary);
+        string contents((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        string next = contents.substr(min((size_t)intactBytes, contents.size()));
+        next = next.substr(0, next.find('\n'));
+        size_t tabs = count(next.begin(), next.end(), '\t');
+        bool intact = (next.compare(0, 2, "B\t") == 0 && tabs == 5) || (next.compare(0, 2, "E\t") == 0 && tabs == 2);
+        cout << "Torn record " << (contents.find("pay-torn") == string::npos ? "dropped" : "STILL IN THE JOURNAL")
+             << ", next record " << (intact ? "intact" : "CORRUPT: " + next) << "\n";
+    }
+    service.closeJournal();
+    remove(path.c_str());
+
+    // /dev/full fails every write with ENOSPC: no append may report success
+    if (::access("/dev/full", W_OK) == 0) {
+        PaymentJournal full("/dev/full");
+        atomic<int> refused(0);
+        vector<thread> appenders;
+        for (int c = 0; c < clients; c++) {
+            appenders.emplace_back([&full, &refused]() {
+                PaymentRequest req("Client", "Merchant", 100.0, "INR");
+                try {
+                    full.logBegin(req);
+                } catch (const runtime_error&) {
+                    refused++;
+                }
+            });
+        }
+        for (auto& t : appenders) {
+            t.join();
+        }
+        cout << "Journal on a full disk: " << refused.load() << "/" << clients << " appends refused\n";
+    }
+
+    const int keys = 1000000;
+    PaymentDedupIndex index;
+    vector<string> keyList;
+    for (int i = 0; i < keys; i++) {
+        keyList.push_back(PaymentRequest::newKey());
+        index.restore(keyList.back(), true);
+    }
+    start = chrono::steady_clock::now();
+    int hits = 0;
+    for (const string& key : keyList) {
+        hits += index.claim(key) == PaymentDedupIndex::ALREADY_SUCCEEDED;
+    }
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    cout << "=== DEDUP: " << hits << "/" << keys << " hits, " << (long long)(ns / keys) << " ns per lookup ===\n";
+
+    PaymentLog::setEnabled(true);
+}
+
+// ----------------------------
+// Load benchmark: millions of synthetic payments through the controller
+// against a zero-latency bank, so the numbers are the cost of our own code
+// ----------------------------
+void runLoadBenchmark(long long requests) {
+    PaymentLog::setEnabled(false);
+    PaymentService& service = PaymentService::getInstance();
+    service.setGateway(GatewayType::PAYTM, GatewayFactory::getInstance().getGateway(GatewayType::PAYTM,
+        new SimulatedBankingSystem(0, 0, 0.0)));
+    service.setGateway(GatewayType::RAZORPAY, GatewayFactory::getInstance().getGateway(GatewayType::RAZORPAY,
+        new SimulatedBankingSystem(0, 0, 0.0)));
+    MetricsRegistry::getInstance().reset();
+    // Millions of fresh keys; keep them out of the service's own index
+    PaymentDedupIndex* previous = service.swapDedupIndex(new PaymentDedupIndex());
+
+    const int clients = 4;
+    long long perClient = requests / clients;
+    LatencyHistogram endToEnd[GATEWAY_TYPE_COUNT];
+    atomic<long long> succeeded(0);
+    vector<thread> threads;
+    auto start = chrono::steady_clock::now();
+    for (int c = 0; c < clients; c++) {
+        threads.emplace_back([&, c]() {
+            string sender = "Client" + to_string(c);
+            long long ok = 0;
+            for (long long i = 0; i < perClient; i++) {
+                GatewayType type = (GatewayType)(i % GATEWAY_TYPE_COUNT);
+                PaymentRequest req(sender, "Merchant", 100.0 + i % 1000, "INR");
+                auto begin = chrono::steady_clock::now();
+                ok += PaymentController::getInstance().handlePayment(type, &req);
+                endToEnd[(int)type].record(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - begin).count());
+            }
+            succeeded += ok;
+        });
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "=== LOAD: " << perClient * clients << " payments from " << clients << " threads in " << seconds << " s, "
+         << (long long)(perClient * clients / seconds) << " payments/sec, " << succeeded << " succeeded ===\n";
+    for (int i = 0; i < GATEWAY_TYPE_COUNT; i++) {
+        cout << "  [" << getGatewayName((GatewayType)i) << "] end-to-end through the controller\n";
+        GatewayMetrics::printStage(cout, "total   ", endToEnd[i]);
+    }
+    MetricsRegistry::getInstance().print(cout);
+    delete service.swapDedupIndex(previous);
+
+    PaymentLog::setEnabled(true);
+}
+
 // ----------------------------
 // Main: Client code now goes through controller
 // ----------------------------
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--benchmark") {
+        runAsyncBenchmark();
+        runResilienceBenchmark();
+        runRoutingBenchmark();
+        runJournalBenchmark();
+        runLoadBenchmark(argc > 2 ? atoll(argv[2]) : 2000000);
+        return 0;
+    }
 
     srand(static_cast<unsigned>(time(nullptr)));
 
@@ -307,6 +2323,21 @@ int main() {
     cout << "------------------------------\n";
     bool res2 = PaymentController::getInstance().handlePayment(GatewayType::RAZORPAY, req2);
     cout << "Result: " << (res2 ? "SUCCESS" : "FAIL") << "\n";
+    cout << "------------------------------\n\n";
+
+    PaymentRequest* req3 = new PaymentRequest("Aditya", "Shubham", 750.0, "INR");
+
+    cout << "Processing via smart routing\n";
+    cout << "------------------------------\n";
+    bool res3 = PaymentController::getInstance().handlePayment(req3);
+    cout << "Result: " << (res3 ? "SUCCESS" : "FAIL") << "\n";
+    PaymentService::getInstance().getRouter().print(cout);
+    cout << "------------------------------\n\n";
+
+    cout << "Retrying the same request\n";
+    cout << "------------------------------\n";
+    bool res4 = PaymentController::getInstance().handlePayment(req3);
+    cout << "Result: " << (res4 ? "SUCCESS" : "FAIL") << "\n";
     cout << "------------------------------\n";
 
     return 0;
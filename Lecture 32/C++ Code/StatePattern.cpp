@@ -1,5 +1,21 @@
 #include <iostream>
 #include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <climits>
+#include <ctime>
+#include <mutex>
+#include <memory>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
 
 using namespace std;
 
@@ -298,7 +314,768 @@ void VendingMachine::printStatus() {
     cout << "Current state: " << currentState->getStateName() << endl << endl;
 }
 
-int main() {
+// ----------------------------
+// Table-driven multi-slot vending machine. Same states as above, but the
+// state is a small enum and every (state, event) pair maps to an action in
+// a table fixed at compile time, so handling an event is one indexed lookup
+// and one call. No state objects, no per-transition allocation; logging
+// only when verbose is on.
+// ----------------------------
+enum MachineState : uint8_t {
+    NO_COIN,
+    HAS_COIN,
+    DISPENSING,
+    SOLD_OUT,
+    STATE_COUNT
+};
+
+enum MachineEvent : uint8_t {
+    INSERT_COIN,
+    SELECT_ITEM,
+    DISPENSE,
+    RETURN_COIN,
+    REFILL,
+    EVENT_COUNT
+};
+
+struct VendingEvent {
+    MachineEvent type;
+    uint8_t slot;       // SELECT_ITEM, REFILL
+    uint16_t amount;    // coin value for INSERT_COIN, quantity for REFILL
+};
+
+// ----------------------------
+// Telemetry: every event a machine handles is appended to a small per-
+// machine ring of 8-byte binary records (no formatting, no allocation).
+// When a ring fills, the thread's uploader delta/varint-compresses it into
+// a batch; full or old batches are sent as one frame to the collector.
+// The write position lives in the machine itself, so logging an event
+// touches only the record's own cache line.
+// ----------------------------
+const uint8_t STOCK_SNAPSHOT = EVENT_COUNT;   // telemetry-only: slot stock when logging starts
+
+struct TelemetryRecord {
+    uint32_t timeMs;
+    uint8_t kind;       // event | previous state << 3 | next state << 5
+    uint8_t slot;
+    uint16_t amount;
+};
+
+struct TelemetryRing {
+    static const int CAPACITY = 32;
+    uint32_t machineId;
+    TelemetryRecord records[CAPACITY];
+};
+
+// Stream to the collector, shared by every uploader writing to it. Frames
+// from different uploaders go out whole, one at a time. A frame cut off by
+// a write error leaves the collector unable to find the next frame, so the
+// link is then marked broken and refuses all further frames.
+struct TelemetryLink {
+    int fd;
+    mutex mtx;
+    bool broken;
+
+    TelemetryLink(int fd) {
+        this->fd = fd;
+        broken = false;
+    }
+};
+
+class TelemetryUploader {
+private:
+    static const size_t HEADER_BYTES = 4;     // frame length, ahead of the batch
+
+    TelemetryLink* link;
+    size_t flushBytes;
+    uint32_t flushEveryMs;
+    uint32_t lastFlushMs;
+    vector<uint8_t> batch;          // frame header, then the encoded rings
+    size_t used;                    // batch bytes after the header
+    long long records;
+    long long frames;
+    long long failedFlushes;
+
+    static uint8_t* putVarint(uint8_t* out, uint32_t value) {
+        while (value >= 0x80) {
+            *out++ = (uint8_t)(value | 0x80);
+            value >>= 7;
+        }
+        *out++ = (uint8_t)value;
+        return out;
+    }
+
+public:
+    // Worst case for one encoded ring: three header varints, then per record
+    // a delta varint, kind, slot and amount varint
+    static const size_t MAX_RING_BYTES = 3 * 5 + TelemetryRing::CAPACITY * (5 + 1 + 1 + 3);
+
+    uint32_t nowMs;
+
+    TelemetryUploader(TelemetryLink* link, size_t flushBytes = 64 * 1024, uint32_t flushEveryMs = 60000) {
+        this->link = link;
+        this->flushBytes = flushBytes;
+        this->flushEveryMs = flushEveryMs;
+        lastFlushMs = 0;
+        used = 0;
+        records = frames = failedFlushes = 0;
+        nowMs = 0;
+        batch.resize(HEADER_BYTES + flushBytes + MAX_RING_BYTES);
+    }
+
+    // Batch layout per ring: machineId, count, first time, then per record
+    // time delta, kind, and slot/amount only for events that use them.
+    // Returns false if a flush it triggered failed; the batch then keeps
+    // growing until a flush succeeds.
+    bool drain(const TelemetryRing& ring, uint32_t count) {
+        if (count == 0) return true;
+        if (batch.size() < HEADER_BYTES + used + MAX_RING_BYTES) {
+            batch.resize(2 * (HEADER_BYTES + used + MAX_RING_BYTES));
+        }
+        uint8_t* out = batch.data() + HEADER_BYTES + used;
+        out = putVarint(out, ring.machineId);
+        out = putVarint(out, count);
+        out = putVarint(out, ring.records[0].timeMs);
+        uint32_t lastTime = ring.records[0].timeMs;
+        for (uint32_t i = 0; i < count; i++) {
+            const TelemetryRecord& r = ring.records[i];
+            out = putVarint(out, r.timeMs - lastTime);
+            lastTime = r.timeMs;
+            *out++ = r.kind;
+            uint8_t event = r.kind & 7;
+            if (event == SELECT_ITEM || event == DISPENSE || event == REFILL || event == STOCK_SNAPSHOT) {
+                *out++ = r.slot;
+            }
+            if (event == INSERT_COIN || event == REFILL || event == STOCK_SNAPSHOT) {
+                out = putVarint(out, r.amount);
+            }
+        }
+        used = out - batch.data() - HEADER_BYTES;
+        records += count;
+        if (used >= flushBytes || nowMs - lastFlushMs >= flushEveryMs) {
+            return flush();
+        }
+        return true;
+    }
+
+    // Frame: 4-byte length, then the batch, written whole. On failure the
+    // batch is kept for the next flush and false is returned.
+    bool flush() {
+        lastFlushMs = nowMs;
+        if (used == 0) return true;
+        uint32_t length = (uint32_t)used;
+        memcpy(batch.data(), &length, HEADER_BYTES);
+        size_t total = HEADER_BYTES + used;
+        lock_guard<mutex> lock(link->mtx);
+        if (link->broken) {
+            failedFlushes++;
+            return false;
+        }
+        size_t done = 0;
+        while (done < total) {
+            ssize_t n = ::write(link->fd, batch.data() + done, total - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                link->broken = done > 0;
+                failedFlushes++;
+                return false;
+            }
+            done += n;
+        }
+        used = 0;
+        frames++;
+        return true;
+    }
+
+    long long getRecords() const {
+        return records;
+    }
+    long long getFrames() const {
+        return frames;
+    }
+    long long getFailedFlushes() const {
+        return failedFlushes;
+    }
+    // Encoded bytes waiting for a successful flush
+    size_t getPendingBytes() const {
+        return used;
+    }
+};
+
+class MultiSlotVendingMachine {
+public:
+    static const int MAX_SLOTS = 8;
+
+private:
+    typedef MachineState (*Action)(MultiSlotVendingMachine&, const VendingEvent&);
+
+    MachineState state;
+    uint8_t telemetryCount;
+    TelemetryRing* telemetry;
+    TelemetryUploader* uploader;
+    uint8_t slotCount;
+    uint8_t selectedSlot;
+    bool verbose;
+    int prices[MAX_SLOTS];
+    int stock[MAX_SLOTS];
+    int totalStock;
+    int balance;
+
+    // Coin accounting: every coin in ends up in the cash box, refunded, or
+    // still as balance
+    long long coinsIn;
+    long long cashBox;
+    long long refunded;
+    long long sold[MAX_SLOTS];
+    long long refilled[MAX_SLOTS];
+    int initialStock[MAX_SLOTS];
+
+    MachineState refund(int amount) {
+        refunded += amount;
+        return state;
+    }
+
+    // Actions. Each returns the next state.
+    static MachineState acceptCoin(MultiSlotVendingMachine& m, const VendingEvent& e) {
+        m.coinsIn += e.amount;
+        m.balance += e.amount;
+        if (m.verbose) cout << "Coin inserted. Current balance: Rs " << m.balance << endl;
+        return HAS_COIN;
+    }
+
+    static MachineState rejectCoin(MultiSlotVendingMachine& m, const VendingEvent& e) {
+        m.coinsIn += e.amount;
+        if (m.verbose) cout << "Coin not accepted now. Coin returned: Rs " << e.amount << endl;
+        return m.refund(e.amount);
+    }
+
+    static MachineState selectSlot(MultiSlotVendingMachine& m, const VendingEvent& e) {
+        if (e.slot >= m.slotCount || m.stock[e.slot] == 0) {
+            if (m.verbose) cout << "Slot " << (int)e.slot << " is empty. Choose another item." << endl;
+            return HAS_COIN;
+        }
+        int price = m.prices[e.slot];
+        if (m.balance < price) {
+            if (m.verbose) cout << "Insufficient funds. Need Rs " << price - m.balance << " more." << endl;
+            return HAS_COIN;
+        }
+        if (m.verbose) cout << "Item " << (int)e.slot << " selected. Dispensing..." << endl;
+        int change = m.balance - price;
+        if (change > 0) {
+            if (m.verbose) cout << "Change returned: Rs " << change << endl;
+            m.refunded += change;
+        }
+        m.cashBox += price;
+        m.balance = 0;
+        m.selectedSlot = e.slot;
+        return DISPENSING;
+    }
+
+    static MachineState dispenseItem(MultiSlotVendingMachine& m, const VendingEvent&) {
+        m.stock[m.selectedSlot]--;
+        m.sold[m.selectedSlot]++;
+        m.totalStock--;
+        if (m.verbose) cout << "Item dispensed!" << endl;
+        if (m.totalStock > 0) {
+            return NO_COIN;
+        }
+        if (m.verbose) cout << "Machine is now sold out!" << endl;
+        return SOLD_OUT;
+    }
+
+    static MachineState returnBalance(MultiSlotVendingMachine& m, const VendingEvent&) {
+        if (m.verbose) cout << "Coin returned: Rs " << m.balance << endl;
+        m.refunded += m.balance;
+        m.balance = 0;
+        return NO_COIN;
+    }
+
+    static MachineState refillSlot(MultiSlotVendingMachine& m, const VendingEvent& e) {
+        if (e.slot < m.slotCount) {
+            if (m.verbose) cout << "Slot " << (int)e.slot << " refilled with " << e.amount << " items" << endl;
+            m.stock[e.slot] += e.amount;
+            m.refilled[e.slot] += e.amount;
+            m.totalStock += e.amount;
+        }
+        return m.totalStock > 0 ? NO_COIN : SOLD_OUT;
+    }
+
+    static MachineState ignore(MultiSlotVendingMachine& m, const VendingEvent&) {
+        if (m.verbose) cout << "Not allowed in state " << stateName(m.state) << endl;
+        return m.state;
+    }
+
+    static constexpr Action transitions[STATE_COUNT][EVENT_COUNT] = {
+        //              INSERT_COIN  SELECT_ITEM  DISPENSE      RETURN_COIN    REFILL
+        /* NO_COIN    */ {acceptCoin, ignore,      ignore,       ignore,        refillSlot},
+        /* HAS_COIN   */ {acceptCoin, selectSlot,  ignore,       returnBalance, ignore},
+        /* DISPENSING */ {rejectCoin, ignore,      dispenseItem, ignore,        ignore},
+        /* SOLD_OUT   */ {rejectCoin, ignore,      ignore,       ignore,        refillSlot},
+    };
+
+public:
+    MultiSlotVendingMachine() : MultiSlotVendingMachine(nullptr, nullptr, 0) {}
+
+    MultiSlotVendingMachine(const int* slotPrices, const int* slotStock, int slots) {
+        slotCount = (uint8_t)min(slots, MAX_SLOTS);
+        telemetry = nullptr;
+        uploader = nullptr;
+        telemetryCount = 0;
+        selectedSlot = 0;
+        verbose = false;
+        totalStock = 0;
+        balance = 0;
+        coinsIn = cashBox = refunded = 0;
+        for (int i = 0; i < MAX_SLOTS; i++) {
+            prices[i] = i < slotCount ? slotPrices[i] : 0;
+            stock[i] = initialStock[i] = i < slotCount ? slotStock[i] : 0;
+            sold[i] = refilled[i] = 0;
+            totalStock += stock[i];
+        }
+        state = totalStock > 0 ? NO_COIN : SOLD_OUT;
+    }
+
+    void handle(const VendingEvent& event) {
+        MachineState prev = state;
+        state = transitions[state][event.type](*this, event);
+        if (telemetry) {
+            logEvent(event.type, prev, event.type == DISPENSE ? selectedSlot : event.slot, event.amount);
+        }
+    }
+
+    inline void logEvent(uint8_t event, MachineState prev, uint8_t slot, uint16_t amount) {
+        telemetry->records[telemetryCount] = {uploader->nowMs, (uint8_t)(event | prev << 3 | state << 5), slot, amount};
+        if (++telemetryCount == TelemetryRing::CAPACITY) {
+            uploader->drain(*telemetry, telemetryCount);
+            telemetryCount = 0;
+        }
+    }
+
+    // Start logging to ring via the given uploader; the first records are
+    // the current stock
+    void attachTelemetry(TelemetryRing* ring, TelemetryUploader* to) {
+        telemetry = ring;
+        uploader = to;
+        telemetryCount = 0;
+        for (int i = 0; i < slotCount; i++) {
+            logEvent(STOCK_SNAPSHOT, state, (uint8_t)i, (uint16_t)stock[i]);
+        }
+    }
+
+    // Hand a partly filled ring to the uploader
+    void flushTelemetry() {
+        if (telemetry) {
+            uploader->drain(*telemetry, telemetryCount);
+            telemetryCount = 0;
+        }
+    }
+
+    void insertCoin(int coin) {
+        handle({INSERT_COIN, 0, (uint16_t)coin});
+    }
+    void selectItem(int slot) {
+        handle({SELECT_ITEM, (uint8_t)slot, 0});
+    }
+    void dispense() {
+        handle({DISPENSE, 0, 0});
+    }
+    void returnCoin() {
+        handle({RETURN_COIN, 0, 0});
+    }
+    void refill(int slot, int quantity) {
+        handle({REFILL, (uint8_t)slot, (uint16_t)quantity});
+    }
+
+    void setVerbose(bool on) {
+        verbose = on;
+    }
+
+    static const char* stateName(MachineState s) {
+        static const char* names[STATE_COUNT] = {"NO_COIN", "HAS_COIN", "DISPENSING", "SOLD_OUT"};
+        return names[s];
+    }
+
+    MachineState getState() const {
+        return state;
+    }
+    int getSlotCount() const {
+        return slotCount;
+    }
+    int getPrice(int slot) const {
+        return prices[slot];
+    }
+    int getStock(int slot) const {
+        return stock[slot];
+    }
+    int getBalance() const {
+        return balance;
+    }
+    long long getCashBox() const {
+        return cashBox;
+    }
+    long long getSold(int slot) const {
+        return sold[slot];
+    }
+
+    // Checks the coin and stock books balance; returns false on any mismatch
+    bool auditOk() const {
+        if (coinsIn != cashBox + refunded + balance) return false;
+        long long revenue = 0;
+        int remaining = 0;
+        for (int i = 0; i < slotCount; i++) {
+            revenue += sold[i] * prices[i];
+            if (stock[i] < 0 || initialStock[i] + refilled[i] - sold[i] != stock[i]) return false;
+            remaining += stock[i];
+        }
+        if (remaining != totalStock) return false;
+        // A sale is paid for when the item is selected and counted when dispensed
+        if (state == DISPENSING) revenue += prices[selectedSlot];
+        if (revenue != cashBox) return false;
+        if ((state == SOLD_OUT) != (totalStock == 0 && state != DISPENSING)) return false;
+        return state != NO_COIN || balance == 0;
+    }
+
+    void printStatus() {
+        cout << "\n--- Vending Machine Status ---" << endl;
+        for (int i = 0; i < slotCount; i++) {
+            cout << "Slot " << i << ": Rs " << prices[i] << ", " << stock[i] << " left" << endl;
+        }
+        cout << "Inserted coin: Rs " << balance << endl;
+        cout << "Cash box: Rs " << cashBox << endl;
+        cout << "Current state: " << stateName(state) << endl << endl;
+    }
+};
+
+constexpr MultiSlotVendingMachine::Action MultiSlotVendingMachine::transitions[STATE_COUNT][EVENT_COUNT];
+
+// ----------------------------
+// Collector side: decodes telemetry frames and keeps fleet analytics -
+// reconstructed stock and sales per slot, sales rates, and when each slot
+// is predicted to sell out at its current rate.
+// ----------------------------
+class FleetAggregator {
+private:
+    static const int SLOTS = MultiSlotVendingMachine::MAX_SLOTS;
+    struct MachineStats {
+        int slots = 0;
+        int stock[SLOTS] = {0};
+        long long sold[SLOTS] = {0};
+    };
+
+    vector<MachineStats> machines;
+    long long records;
+    long long bytes;
+    long long frames;
+    uint32_t firstMs;
+    uint32_t lastMs;
+
+    static bool getVarint(const uint8_t*& p, const uint8_t* end, uint32_t& value) {
+        value = 0;
+        for (int shift = 0; p < end && shift < 35; shift += 7) {
+            uint8_t byte = *p++;
+            value |= (uint32_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    void apply(uint32_t machineId, uint32_t timeMs, uint8_t kind, uint8_t slot, uint16_t amount) {
+        if (machineId >= machines.size()) {
+            machines.resize(machineId + 1);
+        }
+        MachineStats& m = machines[machineId];
+        uint8_t event = kind & 7;
+        uint8_t prev = (kind >> 3) & 3;
+        if (event == STOCK_SNAPSHOT && slot < SLOTS) {
+            m.stock[slot] = amount;
+            m.slots = max(m.slots, slot + 1);
+        } else if (event == DISPENSE && prev == DISPENSING && slot < m.slots) {
+            m.stock[slot]--;
+            m.sold[slot]++;
+        } else if (event == REFILL && (prev == NO_COIN || prev == SOLD_OUT) && slot < m.slots) {
+            m.stock[slot] += amount;
+        }
+        records++;
+        firstMs = min(firstMs, timeMs);
+        lastMs = max(lastMs, timeMs);
+    }
+
+public:
+    FleetAggregator() : records(0), bytes(0), frames(0), firstMs(UINT32_MAX), lastMs(0) {}
+
+    bool decode(const uint8_t* data, size_t size) {
+        const uint8_t* p = data;
+        const uint8_t* end = data + size;
+        frames++;
+        bytes += size;
+        while (p < end) {
+            uint32_t machineId, count, timeMs, delta, amount;
+            if (!getVarint(p, end, machineId) || !getVarint(p, end, count) || !getVarint(p, end, timeMs)) return false;
+            for (uint32_t i = 0; i < count; i++) {
+                if (!getVarint(p, end, delta) || p >= end) return false;
+                timeMs += delta;
+                uint8_t kind = *p++;
+                uint8_t event = kind & 7;
+                uint8_t slot = 0;
+                amount = 0;
+                if (event == SELECT_ITEM || event == DISPENSE || event == REFILL || event == STOCK_SNAPSHOT) {
+                    if (p >= end) return false;
+                    slot = *p++;
+                }
+                if ((event == INSERT_COIN || event == REFILL || event == STOCK_SNAPSHOT) && !getVarint(p, end, amount)) {
+                    return false;
+                }
+                apply(machineId, timeMs, kind, slot, (uint16_t)amount);
+            }
+        }
+        return true;
+    }
+
+    void report(ostream& out) {
+        double hours = max(1u, lastMs - firstMs) / 3600000.0;
+        long long totalSold = 0;
+        long long totalStock = 0;
+        // empty, < 1h, < 6h, < 24h, later, no sales yet
+        long long buckets[6] = {0};
+        struct Soonest { double hours; size_t machine; int slot; };
+        vector<Soonest> soonest;
+        for (size_t id = 0; id < machines.size(); id++) {
+            const MachineStats& m = machines[id];
+            for (int s = 0; s < m.slots; s++) {
+                totalSold += m.sold[s];
+                totalStock += m.stock[s];
+                if (m.stock[s] <= 0) {
+                    buckets[0]++;
+                    continue;
+                }
+                if (m.sold[s] == 0) {
+                    buckets[5]++;
+                    continue;
+                }
+                double sellOut = m.stock[s] / (m.sold[s] / hours);
+                buckets[sellOut < 1 ? 1 : sellOut < 6 ? 2 : sellOut < 24 ? 3 : 4]++;
+                soonest.push_back({sellOut, id, s});
+            }
+        }
+        size_t top = min<size_t>(5, soonest.size());
+        partial_sort(soonest.begin(), soonest.begin() + top, soonest.end(),
+                     [](const Soonest& a, const Soonest& b) { return a.hours < b.hours; });
+
+        out << "[Collector] " << frames << " frames, " << records << " events in " << bytes << " bytes ("
+            << (double)bytes / max(1LL, records) << " bytes/event vs " << sizeof(TelemetryRecord) << " raw)\n";
+        out << "[Collector] " << machines.size() << " machines over " << hours << "h: " << totalSold << " sold ("
+            << (long long)(totalSold / hours) << "/hour), " << totalStock << " items left\n";
+        out << "[Collector] Slots selling out: empty=" << buckets[0] << " <1h=" << buckets[1] << " <6h=" << buckets[2]
+            << " <24h=" << buckets[3] << " later=" << buckets[4] << " no-sales=" << buckets[5] << "\n";
+        for (size_t i = 0; i < top; i++) {
+            out << "[Collector]   machine " << soonest[i].machine << " slot " << soonest[i].slot << " sells out in "
+                << soonest[i].hours * 60 << " min\n";
+        }
+    }
+};
+
+// Collector process: reads frames until the simulator closes the socket
+void runTelemetryCollector(int fd) {
+    FleetAggregator aggregator;
+    vector<uint8_t> frame;
+    auto readFully = [fd](void* buffer, size_t size) {
+        size_t done = 0;
+        while (done < size) {
+            ssize_t n = ::read(fd, (char*)buffer + done, size - done);
+            if (n <= 0) return false;
+            done += n;
+        }
+        return true;
+    };
+    uint32_t length;
+    while (readFully(&length, sizeof(length))) {
+        frame.resize(length);
+        if (!readFully(frame.data(), length) || !aggregator.decode(frame.data(), length)) {
+            cout << "[Collector] Corrupt frame, stopping." << endl;
+            break;
+        }
+    }
+    aggregator.report(cout);
+    cout.flush();
+}
+
+// ----------------------------
+// Fleet simulator: random customer traffic over many machines, split by
+// machine range across threads (no sharing), then a full audit. With
+// telemetry on, a collector process is forked and fed over a socket; the
+// simulated clock spans 24 hours.
+// ----------------------------
+struct FastRandom {
+    uint64_t s;
+    FastRandom(uint64_t seed) : s(seed * 0x9E3779B97F4A7C15ULL + 1) {}
+    uint64_t next() {
+        s ^= s << 13;
+        s ^= s >> 7;
+        s ^= s << 17;
+        return s;
+    }
+};
+
+VendingEvent randomEvent(FastRandom& rng, int slots) {
+    static const uint16_t coins[4] = {5, 10, 20, 50};
+    uint64_t r = rng.next();
+    uint32_t roll = r % 100;
+    uint8_t slot = (uint8_t)((r >> 8) % slots);
+    if (roll < 40) return {INSERT_COIN, 0, coins[(r >> 16) & 3]};
+    if (roll < 65) return {SELECT_ITEM, slot, 0};
+    if (roll < 88) return {DISPENSE, 0, 0};
+    if (roll < 95) return {RETURN_COIN, 0, 0};
+    return {REFILL, slot, (uint16_t)(1 + (r >> 20) % 10)};
+}
+
+// Returns the cost per event in nanoseconds
+double runFleetSimulation(int machineCount, long long events, bool withTelemetry) {
+    const int slots = MultiSlotVendingMachine::MAX_SLOTS;
+    vector<MultiSlotVendingMachine> fleet;
+    fleet.reserve(machineCount);
+    for (int i = 0; i < machineCount; i++) {
+        int prices[slots];
+        int stock[slots];
+        for (int s = 0; s < slots; s++) {
+            prices[s] = 10 + 5 * ((i + s) % 9);
+            stock[s] = 5 + (i * 7 + s) % 10;
+        }
+        fleet.emplace_back(prices, stock, slots);
+    }
+
+    if (machineCount < 1) {
+        cout << "A fleet needs at least one machine" << endl;
+        return 0;
+    }
+    // Every thread owns a non-empty range of machines
+    int threads = (int)min<long long>(max(1u, thread::hardware_concurrency()), machineCount);
+    cout << "=== FLEET: " << machineCount << " machines x " << slots << " slots, " << events << " events, "
+         << threads << " thread(s), " << sizeof(MultiSlotVendingMachine) << " bytes per machine"
+         << (withTelemetry ? ", telemetry on" : "") << " ===" << endl;
+
+    int sockets[2] = {-1, -1};
+    pid_t collector = -1;
+    unique_ptr<TelemetryLink> link;
+    vector<TelemetryRing> rings;
+    vector<unique_ptr<TelemetryUploader>> uploaders;
+    if (withTelemetry) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0 || (collector = fork()) < 0) {
+            cout << "Cannot start the telemetry collector" << endl;
+            return 0;
+        }
+        if (collector == 0) {
+            close(sockets[0]);
+            runTelemetryCollector(sockets[1]);
+            _exit(0);
+        }
+        close(sockets[1]);
+        link.reset(new TelemetryLink(sockets[0]));
+        rings.resize(machineCount);
+        for (int t = 0; t < threads; t++) {
+            uploaders.emplace_back(new TelemetryUploader(link.get()));
+        }
+        for (int i = 0; i < machineCount; i++) {
+            int owner = (int)((long long)i * threads / machineCount);
+            while ((long long)machineCount * (owner + 1) / threads <= i) owner++;
+            rings[i].machineId = i;
+            fleet[i].attachTelemetry(&rings[i], uploaders[owner].get());
+        }
+    }
+    const uint64_t simulatedMs = 24ULL * 3600 * 1000;
+
+    vector<thread> workers;
+    clock_t cpuStart = clock();
+    auto start = chrono::steady_clock::now();
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            int first = (int)((long long)machineCount * t / threads);
+            int last = (int)((long long)machineCount * (t + 1) / threads);
+            long long count = events / threads;
+            FastRandom rng(t + 1);
+            TelemetryUploader* uploader = withTelemetry ? uploaders[t].get() : nullptr;
+            for (long long i = 0; i < count; i++) {
+                int machine = first + (int)(rng.next() % (last - first));
+                if (uploader) {
+                    uploader->nowMs = (uint32_t)(i * simulatedMs / count);
+                }
+                fleet[machine].handle(randomEvent(rng, slots));
+            }
+            if (uploader) {
+                for (int m = first; m < last; m++) {
+                    fleet[m].flushTelemetry();
+                }
+                uploader->flush();
+            }
+        });
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    // CPU time of this process only; the collector runs in its own
+    double cpuSeconds = (double)(clock() - cpuStart) / CLOCKS_PER_SEC;
+
+    int failedAudits = 0;
+    long long itemsSold = 0;
+    long long cash = 0;
+    int stateCounts[STATE_COUNT] = {0};
+    for (const MultiSlotVendingMachine& machine : fleet) {
+        if (!machine.auditOk()) failedAudits++;
+        for (int s = 0; s < slots; s++) itemsSold += machine.getSold(s);
+        cash += machine.getCashBox();
+        stateCounts[machine.getState()]++;
+    }
+    cout << (long long)(events / seconds) << " events/sec, " << seconds * 1e9 / events << " ns per event wall, "
+         << cpuSeconds * 1e9 / events << " ns CPU\n";
+    cout << "Items sold: " << itemsSold << ", cash collected: Rs " << cash << "\n";
+    cout << "Machines by state:";
+    for (int s = 0; s < STATE_COUNT; s++) {
+        cout << " " << MultiSlotVendingMachine::stateName((MachineState)s) << "=" << stateCounts[s];
+    }
+    cout << "\nCoin/stock audit: " << failedAudits << " machine(s) out of balance\n";
+
+    if (withTelemetry) {
+        long long logged = 0;
+        long long frames = 0;
+        long long failed = 0;
+        for (auto& uploader : uploaders) {
+            logged += uploader->getRecords();
+            frames += uploader->getFrames();
+            failed += uploader->getFailedFlushes();
+        }
+        long long stockLeft = 0;
+        for (const MultiSlotVendingMachine& machine : fleet) {
+            for (int s = 0; s < slots; s++) stockLeft += machine.getStock(s);
+        }
+        cout << "Telemetry: " << logged << " events sent in " << frames << " frames (" << failed
+             << " failed flushes); simulator has " << itemsSold << " sold, " << stockLeft << " items left" << endl;
+
+        // A sink that fails every write: the batch must stay, unframed
+        int full = ::open("/dev/full", O_WRONLY);
+        if (full >= 0) {
+            TelemetryLink fullLink(full);
+            TelemetryUploader failing(&fullLink);
+            failing.drain(rings[0], TelemetryRing::CAPACITY);
+            bool sent = failing.flush();
+            cout << "Upload to a full disk: flush " << (sent ? "succeeded" : "failed") << ", "
+                 << failing.getPendingBytes() << " bytes kept, " << failing.getFrames() << " frames counted" << endl;
+            close(full);
+        }
+        close(sockets[0]);
+        waitpid(collector, nullptr, 0);
+    }
+    return cpuSeconds * 1e9 / events;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--benchmark") {
+        long long events = argc > 2 ? atoll(argv[2]) : 50000000;
+        double plain = runFleetSimulation(100000, events, false);
+        double logged = runFleetSimulation(100000, events, true);
+        cout << "Telemetry overhead: " << logged - plain << " ns CPU per event" << endl;
+        return 0;
+    }
+
     cout << "=== Water Bottle VENDING MACHINE ===" <<endl;
     
     int itemCount = 2;
@@ -345,5 +1122,31 @@ int main() {
     machine.refill(2);
     machine.printStatus(); // State changes NO_COIN
     
+    cout << "=== MULTI-SLOT VENDING MACHINE ===" <<endl;
+    int prices[] = {20, 35};
+    int stock[] = {1, 3};
+    MultiSlotVendingMachine snacks(prices, stock, 2);
+    snacks.setVerbose(true);
+    snacks.printStatus();
+
+    cout << "1. Buying from slot 1 with change:" <<endl;
+    snacks.insertCoin(20);
+    snacks.selectItem(1);  // Insufficient funds
+    snacks.insertCoin(20);
+    snacks.selectItem(1);  // Rs 5 change
+    snacks.dispense();
+
+    cout << "2. Emptying slot 0, then selecting it again:" <<endl;
+    snacks.insertCoin(20);
+    snacks.selectItem(0);
+    snacks.dispense();
+    snacks.insertCoin(50);
+    snacks.selectItem(0);  // Slot empty, still HAS_COIN
+    snacks.returnCoin();
+
+    cout << "3. Refilling slot 0:" <<endl;
+    snacks.refill(0, 4);
+    snacks.printStatus();
+    
     return 0;
 }
\ No newline at end of file
@@ -2,6 +2,12 @@
 #include <vector>
 #include <queue>
 #include <deque>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
 
 using namespace std;
 
@@ -35,25 +41,63 @@ public:
     }
 };
 
-// Board class - Dumb object that only manages the grid
+// Board class - Dumb object that only manages the grid.
+// Cells are packed 2 bits each (32 per word): code 0 is the empty cell and
+// codes 1..3 index a small table of the player symbols seen on this board.
 class Board {
 private:
-    vector<vector<Symbol*>> grid;
+    vector<uint64_t> cells;
     int size;
-    Symbol* emptyCell;
+    int filledCount;
+    Symbol emptyCell;
+    Symbol* symbols[4];
+    int symbolCount;
+
+    // Code for a symbol, registering it on first use. -1 if the table is full.
+    int codeFor(Symbol* mark) {
+        for(int code = 1; code <= symbolCount; code++) {
+            if(symbols[code] == mark) {
+                return code;
+            }
+        }
+        if(symbolCount == 3) {
+            return -1;
+        }
+        symbols[++symbolCount] = mark;
+        return symbolCount;
+    }
     
 public:
-    Board(int s) {
+    Board(int s) : emptyCell('-') {
         size = s;
-        emptyCell = new Symbol('-');
-        grid = vector<vector<Symbol*>>(size, vector<Symbol*>(size, emptyCell));
+        filledCount = 0;
+        symbols[0] = &emptyCell;
+        symbols[1] = symbols[2] = symbols[3] = nullptr;
+        symbolCount = 0;
+        cells = vector<uint64_t>(((size_t)size * size + 31) / 32, 0);
+    }
+    
+    // Raw 2-bit code of an in-range cell, no bounds check
+    int getCellCode(int row, int col) {
+        size_t index = (size_t)row * size + col;
+        return (cells[index >> 5] >> ((index & 31) << 1)) & 3;
+    }
+
+    // Code used for this symbol on the board, 0 if it has never been placed
+    int getSymbolCode(Symbol* mark) {
+        for(int code = 1; code <= symbolCount; code++) {
+            if(symbols[code] == mark) {
+                return code;
+            }
+        }
+        return 0;
     }
     
     bool isCellEmpty(int row, int col) {
         if(row < 0 || row >= size || col < 0 || col >= size) {
             return false;
         }
-        return grid[row][col] == emptyCell;
+        return getCellCode(row, col) == 0;
     }
     
     bool placeMark(int row, int col, Symbol* mark) {
@@ -63,15 +107,21 @@ public:
         if(!isCellEmpty(row, col)) {
             return false;
         }
-        grid[row][col] = mark;
+        int code = codeFor(mark);
+        if(code < 0) {
+            return false;
+        }
+        size_t index = (size_t)row * size + col;
+        cells[index >> 5] |= (uint64_t)code << ((index & 31) << 1);
+        filledCount++;
         return true;
     }
     
     Symbol* getCell(int row, int col) {
         if(row < 0 || row >= size || col < 0 || col >= size) {
-            return emptyCell;
+            return &emptyCell;
         }
-        return grid[row][col];
+        return symbols[getCellCode(row, col)];
     }
     
     int getSize() {
@@ -79,7 +129,15 @@ public:
     }
     
     Symbol* getEmptyCell() {
-        return emptyCell;
+        return &emptyCell;
+    }
+
+    bool isFull() {
+        return filledCount == size * size;
+    }
+
+    size_t memoryBytes() {
+        return sizeof(Board) + cells.capacity() * sizeof(uint64_t);
     }
     
     void display() {
@@ -92,7 +150,7 @@ public:
         for(int i = 0; i < size; i++) {
             cout << i << " ";
             for(int j = 0; j < size; j++) {
-                cout << grid[i][j]->getMark() << " ";
+                cout << getCell(i, j)->getMark() << " ";
             }
             cout << endl;
         }
@@ -100,6 +158,504 @@ public:
     }
 };
 
+// Result of one computer move search
+struct SearchResult {
+    int row;
+    int col;
+    int score;
+    int depth;
+    bool solved;
+    long long positions;
+    long long tableHits;
+    double millis;
+};
+
+// Negamax solver with alpha-beta pruning, a transposition table and
+// symmetry reduction. Works on its own flat copy of the board where
+// 1 = the solver's stones and 2 = the opponent's stones.
+class TicTacToeSolver {
+private:
+    enum Bound { EXACT, LOWER, UPPER };
+
+    struct TTEntry {
+        uint64_t key;
+        int score;
+        int16_t depth;
+        uint8_t bound;
+    };
+
+    static const int WIN = 1000000;
+    static const int WIN_THRESHOLD = WIN / 2;
+    static const int INF = WIN + 1;
+
+    int size;
+    int winLength;
+    int cellCount;
+    int filled;
+    vector<int8_t> cells;
+
+    // 8 board symmetries: symCell[s][cell] = cell after applying symmetry s
+    vector<vector<int>> symCell;
+    vector<uint64_t> zobrist;       // zobrist[(player - 1) * cellCount + cell]
+    uint64_t sideKey;
+    uint64_t symHash[8];
+
+    vector<TTEntry> table;
+    uint64_t tableMask;
+
+    vector<int> moveOrder;          // centre-first static ordering
+    vector<vector<int>> windows;    // every line segment of length winLength
+    vector<int> windowWeight;       // by stones of one player in an open window, 0..winLength
+
+    // The clock is read after every CHECK_WORK cells of work rather than
+    // every N positions, because one position costs O(cells + windows)
+    static const long long CHECK_WORK = 1 << 16;
+
+    long long positions;
+    long long tableHits;
+    long long work;
+    long long nextCheck;
+    bool timeUp;
+    chrono::steady_clock::time_point deadline;
+
+    void spend(long long cells) {
+        work += cells;
+        if(work >= nextCheck) {
+            nextCheck = work + CHECK_WORK;
+            if(chrono::steady_clock::now() > deadline) {
+                timeUp = true;
+            }
+        }
+    }
+
+    void buildSymmetries() {
+        symCell = vector<vector<int>>(8, vector<int>(cellCount));
+        int n = size - 1;
+        for(int r = 0; r < size; r++) {
+            for(int c = 0; c < size; c++) {
+                int cell = r * size + c;
+                symCell[0][cell] = r * size + c;
+                symCell[1][cell] = c * size + (n - r);
+                symCell[2][cell] = (n - r) * size + (n - c);
+                symCell[3][cell] = (n - c) * size + r;
+                symCell[4][cell] = r * size + (n - c);
+                symCell[5][cell] = (n - r) * size + c;
+                symCell[6][cell] = c * size + r;
+                symCell[7][cell] = (n - c) * size + (n - r);
+            }
+        }
+    }
+
+    void buildWindows() {
+        int dr[4] = {0, 1, 1, 1};
+        int dc[4] = {1, 0, 1, -1};
+        for(int r = 0; r < size; r++) {
+            for(int c = 0; c < size; c++) {
+                for(int d = 0; d < 4; d++) {
+                    int endR = r + dr[d] * (winLength - 1);
+                    int endC = c + dc[d] * (winLength - 1);
+                    if(endR < 0 || endR >= size || endC < 0 || endC >= size) {
+                        continue;
+                    }
+                    vector<int> window;
+                    for(int i = 0; i < winLength; i++) {
+                        window.push_back((r + dr[d] * i) * size + (c + dc[d] * i));
+                    }
+                    windows.push_back(window);
+                }
+            }
+        }
+        windowWeight = vector<int>(winLength + 1, 0);
+        int weight = 1;
+        for(int i = 1; i < winLength; i++) {
+            windowWeight[i] = weight;
+            weight = min(weight * 8, 100000);
+        }
+    }
+
+    void place(int cell, int player) {
+        cells[cell] = player;
+        filled++;
+        uint64_t* keys = &zobrist[(player - 1) * cellCount];
+        for(int s = 0; s < 8; s++) {
+            symHash[s] ^= keys[symCell[s][cell]];
+        }
+    }
+
+    void remove(int cell, int player) {
+        cells[cell] = 0;
+        filled--;
+        uint64_t* keys = &zobrist[(player - 1) * cellCount];
+        for(int s = 0; s < 8; s++) {
+            symHash[s] ^= keys[symCell[s][cell]];
+        }
+    }
+
+    // Symmetric positions share one table entry
+    uint64_t canonicalHash(int player) {
+        uint64_t h = symHash[0];
+        for(int s = 1; s < 8; s++) {
+            h = min(h, symHash[s]);
+        }
+        return player == 1 ? h : h ^ sideKey;
+    }
+
+    int countDirection(int cell, int dr, int dc, int player) {
+        int r = cell / size + dr;
+        int c = cell % size + dc;
+        int count = 0;
+        while(r >= 0 && r < size && c >= 0 && c < size && cells[r * size + c] == player) {
+            count++;
+            r += dr;
+            c += dc;
+        }
+        return count;
+    }
+
+    // Would placing player's stone on this empty cell complete a line?
+    bool completesLine(int cell, int player) {
+        int dr[4] = {0, 1, 1, 1};
+        int dc[4] = {1, 0, 1, -1};
+        for(int d = 0; d < 4; d++) {
+            int line = 1 + countDirection(cell, dr[d], dc[d], player)
+                         + countDirection(cell, -dr[d], -dc[d], player);
+            if(line >= winLength) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Open-window heuristic for positions cut off by the depth limit
+    int evaluate(int player) {
+        spend((long long)windows.size() * winLength);
+        int score = 0;
+        for(auto& window : windows) {
+            int mine = 0, theirs = 0;
+            for(int cell : window) {
+                if(cells[cell] == player) mine++;
+                else if(cells[cell] != 0) theirs++;
+            }
+            if(theirs == 0) score += windowWeight[mine];
+            else if(mine == 0) score -= windowWeight[theirs];
+        }
+        return max(-WIN_THRESHOLD + 1, min(WIN_THRESHOLD - 1, score));
+    }
+
+    // Mate scores are stored relative to the node, not the root
+    int toTable(int score, int ply) {
+        if(score > WIN_THRESHOLD) return score + ply;
+        if(score < -WIN_THRESHOLD) return score - ply;
+        return score;
+    }
+
+    int fromTable(int score, int ply) {
+        if(score > WIN_THRESHOLD) return score - ply;
+        if(score < -WIN_THRESHOLD) return score + ply;
+        return score;
+    }
+
+    int negamax(int depth, int ply, int alpha, int beta, int player) {
+        positions++;
+        spend(cellCount);
+        if(timeUp) {
+            return 0;
+        }
+
+        int empties = cellCount - filled;
+        if(empties == 0) {
+            return 0;
+        }
+
+        int opponent = 3 - player;
+        int threatCell = -1;
+        int threats = 0;
+        for(int cell : moveOrder) {
+            if(cells[cell] != 0) continue;
+            if(completesLine(cell, player)) {
+                return WIN - (ply + 1);
+            }
+            if(completesLine(cell, opponent)) {
+                threats++;
+                threatCell = cell;
+            }
+        }
+        // Two open threats cannot both be blocked
+        if(threats >= 2 && empties >= 2) {
+            return -(WIN - (ply + 2));
+        }
+        if(depth <= 0) {
+            return evaluate(player);
+        }
+
+        // A search that covers every remaining move is exact for any depth
+        int searchDepth = min(depth, empties);
+        int alphaOrig = alpha;
+        uint64_t key = canonicalHash(player);
+        TTEntry& entry = table[key & tableMask];
+        if(entry.key == key && entry.depth >= searchDepth) {
+            tableHits++;
+            int stored = fromTable(entry.score, ply);
+            if(entry.bound == EXACT) return stored;
+            if(entry.bound == LOWER) alpha = max(alpha, stored);
+            else beta = min(beta, stored);
+            if(alpha >= beta) return stored;
+        }
+
+        int best = -INF;
+        for(int cell : moveOrder) {
+            if(cells[cell] != 0) continue;
+            if(threats == 1 && cell != threatCell) continue;
+
+            place(cell, player);
+            int score = -negamax(searchDepth - 1, ply + 1, -beta, -alpha, opponent);
+            remove(cell, player);
+            if(timeUp) {
+                return 0;
+            }
+
+            if(score > best) best = score;
+            if(best > alpha) alpha = best;
+            if(alpha >= beta) break;
+        }
+
+        TTEntry& slot = table[key & tableMask];
+        slot.key = key;
+        slot.score = toTable(best, ply);
+        slot.depth = searchDepth;
+        if(best <= alphaOrig) slot.bound = UPPER;
+        else if(best >= beta) slot.bound = LOWER;
+        else slot.bound = EXACT;
+        return best;
+    }
+
+    // One full-width iteration at the root; returns the best cell
+    int searchRoot(int depth, vector<int>& rootMoves, int& bestScore) {
+        int alpha = -INF;
+        int bestCell = -1;
+        bestScore = -INF;
+        for(int cell : rootMoves) {
+            place(cell, 1);
+            int score;
+            if(completesLine(cell, 1) || winsOnBoard(cell)) {
+                score = WIN - 1;
+            } else {
+                score = -negamax(depth - 1, 1, -INF, -alpha, 2);
+            }
+            remove(cell, 1);
+            if(timeUp) {
+                return -1;
+            }
+            if(score > bestScore) {
+                bestScore = score;
+                bestCell = cell;
+            }
+            alpha = max(alpha, score);
+        }
+        return bestCell;
+    }
+
+    // completesLine() checks an empty cell; this checks a placed stone
+    bool winsOnBoard(int cell) {
+        int player = cells[cell];
+        cells[cell] = 0;
+        bool win = completesLine(cell, player);
+        cells[cell] = player;
+        return win;
+    }
+
+public:
+    TicTacToeSolver(int boardSize, int winLength, int tableBits = 20) {
+        size = boardSize;
+        this->winLength = winLength;
+        cellCount = size * size;
+        filled = 0;
+        cells = vector<int8_t>(cellCount, 0);
+        positions = 0;
+        tableHits = 0;
+        work = 0;
+        nextCheck = CHECK_WORK;
+        timeUp = false;
+
+        buildSymmetries();
+        buildWindows();
+
+        mt19937_64 rng(0x5eed1234abcdULL);
+        zobrist = vector<uint64_t>(2 * cellCount);
+        for(auto& key : zobrist) {
+            key = rng();
+        }
+        sideKey = rng();
+
+        table = vector<TTEntry>(1ULL << tableBits, TTEntry{0, 0, -1, EXACT});
+        tableMask = (1ULL << tableBits) - 1;
+
+        for(int cell = 0; cell < cellCount; cell++) {
+            moveOrder.push_back(cell);
+        }
+        double centre = (size - 1) / 2.0;
+        stable_sort(moveOrder.begin(), moveOrder.end(), [&](int a, int b) {
+            double da = abs(a / size - centre) + abs(a % size - centre);
+            double db = abs(b / size - centre) + abs(b % size - centre);
+            return da < db;
+        });
+    }
+
+    // position: 0 = empty, 1 = solver to move, 2 = opponent
+    SearchResult findBestMove(const vector<int8_t>& position, int timeLimitMs) {
+        auto start = chrono::steady_clock::now();
+        deadline = start + chrono::milliseconds(timeLimitMs);
+        timeUp = false;
+        positions = 0;
+        tableHits = 0;
+        work = 0;
+        nextCheck = CHECK_WORK;
+
+        filled = 0;
+        for(int s = 0; s < 8; s++) {
+            symHash[s] = 0;
+        }
+        for(int cell = 0; cell < cellCount; cell++) {
+            cells[cell] = 0;
+        }
+        for(int cell = 0; cell < cellCount; cell++) {
+            if(position[cell] != 0) {
+                place(cell, position[cell]);
+            }
+        }
+
+        vector<int> rootMoves;
+        for(int cell : moveOrder) {
+            if(cells[cell] == 0) {
+                rootMoves.push_back(cell);
+            }
+        }
+
+        SearchResult result = {-1, -1, 0, 0, false, 0, 0, 0.0};
+        if(rootMoves.empty()) {
+            return result;
+        }
+        int bestCell = rootMoves[0];
+        int empties = (int)rootMoves.size();
+
+        // Iterative deepening until solved or out of time
+        for(int depth = 1; depth <= empties; depth++) {
+            int score;
+            int cell = searchRoot(depth, rootMoves, score);
+            if(timeUp || cell < 0) {
+                break;
+            }
+            bestCell = cell;
+            result.score = score;
+            result.depth = depth;
+
+            // Try the previous best move first in the next iteration
+            rootMoves.erase(find(rootMoves.begin(), rootMoves.end(), cell));
+            rootMoves.insert(rootMoves.begin(), cell);
+
+            if(depth == empties || abs(score) > WIN_THRESHOLD) {
+                result.solved = true;
+                break;
+            }
+        }
+
+        result.row = bestCell / size;
+        result.col = bestCell % size;
+        result.positions = positions;
+        result.tableHits = tableHits;
+        result.millis = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    static bool isWinScore(int score) {
+        return score > WIN_THRESHOLD;
+    }
+
+    static bool isLossScore(int score) {
+        return score < -WIN_THRESHOLD;
+    }
+};
+
+// Strategy Pattern for how a player picks its move
+class PlayerStrategy {
+public:
+    virtual bool makeMove(Board* board, Symbol* symbol, int& row, int& col) = 0;
+    virtual ~PlayerStrategy() {}
+};
+
+// Human player reads the move from stdin
+class HumanPlayerStrategy : public PlayerStrategy {
+public:
+    bool makeMove(Board*, Symbol* symbol, int& row, int& col) override {
+        cout << "(" << symbol->getMark() << ") - Enter row and column: ";
+        if(!(cin >> row >> col)) {
+            return false;
+        }
+        return true;
+    }
+};
+
+// Computer player backed by the negamax solver
+class ComputerPlayerStrategy : public PlayerStrategy {
+private:
+    int winLength;
+    int timeLimitMs;
+    TicTacToeSolver* solver;
+    int solverSize;
+
+public:
+    ComputerPlayerStrategy(int winLength, int timeLimitMs = 1000) {
+        this->winLength = winLength;
+        this->timeLimitMs = timeLimitMs;
+        solver = nullptr;
+        solverSize = 0;
+    }
+
+    bool makeMove(Board* board, Symbol* symbol, int& row, int& col) override {
+        int size = board->getSize();
+        // Solver (and its transposition table) is kept across moves
+        if(solver == nullptr || solverSize != size) {
+            delete solver;
+            solver = new TicTacToeSolver(size, min(winLength, size));
+            solverSize = size;
+        }
+
+        int myCode = board->getSymbolCode(symbol);
+        vector<int8_t> position(size * size, 0);
+        for(int i = 0; i < size; i++) {
+            for(int j = 0; j < size; j++) {
+                int code = board->getCellCode(i, j);
+                if(code != 0) {
+                    position[i * size + j] = (code == myCode) ? 1 : 2;
+                }
+            }
+        }
+
+        SearchResult result = solver->findBestMove(position, timeLimitMs);
+        if(result.row < 0) {
+            return false;
+        }
+        row = result.row;
+        col = result.col;
+
+        cout << "(" << symbol->getMark() << ") computer plays " << row << " " << col
+             << " [searched " << result.positions << " positions, "
+             << result.tableHits << " table hits, depth " << result.depth
+             << ", " << result.millis << " ms";
+        if(result.solved) {
+            if(TicTacToeSolver::isWinScore(result.score)) cout << ", solved: win";
+            else if(TicTacToeSolver::isLossScore(result.score)) cout << ", solved: loss";
+            else cout << ", solved: draw";
+        }
+        cout << "]" << endl;
+        return true;
+    }
+
+    ~ComputerPlayerStrategy() {
+        delete solver;
+    }
+};
+
 // Player class --> 
 class TicTacToePlayer {
 private:
@@ -107,13 +663,15 @@ private:
     string name;
     Symbol* symbol;
     int score;
+    PlayerStrategy* strategy;
     
 public:
-    TicTacToePlayer(int playerId, string n, Symbol* s) {
+    TicTacToePlayer(int playerId, string n, Symbol* s, PlayerStrategy* strategy = nullptr) {
         this->playerId = playerId;
         name = n;
         symbol = s;
         score = 0;
+        this->strategy = strategy ? strategy : new HumanPlayerStrategy();
     }
     
     // Getters and setters
@@ -125,6 +683,10 @@ public:
         return symbol; 
     }
 
+    PlayerStrategy* getStrategy() {
+        return strategy;
+    }
+
     int getScore() { 
         return score; 
     }
@@ -135,6 +697,7 @@ public:
     
     ~TicTacToePlayer() {
         delete symbol;
+        delete strategy;
     }
 };
 
@@ -156,12 +719,14 @@ public:
     
     bool checkWinCondition(Board* board, Symbol* symbol) override {
         int size = board->getSize();
+        int code = board->getSymbolCode(symbol);
+        if(code == 0) return false;
         
         // Check rows
         for(int i = 0; i < size; i++) {
             bool win = true;
             for(int j = 0; j < size; j++) {
-                if(board->getCell(i, j) != symbol) {
+                if(board->getCellCode(i, j) != code) {
                     win = false;
                     break;
                 }
@@ -173,7 +738,7 @@ public:
         for(int j = 0; j < size; j++) {
             bool win = true;
             for(int i = 0; i < size; i++) {
-                if(board->getCell(i, j) != symbol) {
+                if(board->getCellCode(i, j) != code) {
                     win = false;
                     break;
                 }
@@ -184,7 +749,7 @@ public:
         // Check main diagonal
         bool win = true;
         for(int i = 0; i < size; i++) {
-            if(board->getCell(i, i) != symbol) {
+            if(board->getCellCode(i, i) != code) {
                 win = false;
                 break;
             }
@@ -194,7 +759,7 @@ public:
         // Check anti-diagonal
         win = true;
         for(int i = 0; i < size; i++) {
-            if(board->getCell(i, size-1-i) != symbol) {
+            if(board->getCellCode(i, size-1-i) != code) {
                 win = false;
                 break;
             }
@@ -204,15 +769,40 @@ public:
     
     // If all cells are filled and no winner
     bool checkDrawCondition(Board* board) override {
+        return board->isFull();
+    }
+};
+
+// k-in-a-row rules (Gomoku style) - a line of winLength marks anywhere wins
+class KInARowTicTacToeRules : public StandardTicTacToeRules {
+private:
+    int winLength;
+
+public:
+    KInARowTicTacToeRules(int k) {
+        winLength = k;
+    }
+
+    bool checkWinCondition(Board* board, Symbol* symbol) override {
         int size = board->getSize();
+        int dr[4] = {0, 1, 1, 1};
+        int dc[4] = {1, 0, 1, -1};
+        int code = board->getSymbolCode(symbol);
+        if(code == 0) return false;
         for(int i = 0; i < size; i++) {
             for(int j = 0; j < size; j++) {
-                if(board->getCell(i, j) == board->getEmptyCell()) {
-                    return false;
+                if(board->getCellCode(i, j) != code) continue;
+                for(int d = 0; d < 4; d++) {
+                    int count = 1;
+                    while(count < winLength &&
+                          board->getCell(i + dr[d] * count, j + dc[d] * count) == symbol) {
+                        count++;
+                    }
+                    if(count == winLength) return true;
                 }
             }
         }
-        return true;
+        return false;
     }
 };
 
@@ -226,14 +816,20 @@ private:
     bool gameOver;
     
 public:
-    TicTacToeGame(int boardSize) {
+    TicTacToeGame(int boardSize, TicTacToeRules* rules = nullptr) {
         board = new Board(boardSize);
-        rules = new StandardTicTacToeRules();
+        this->rules = rules ? rules : new StandardTicTacToeRules();
         gameOver = false;
     }
     
-    void addPlayer(TicTacToePlayer* player) {
+    // The packed board has codes for 3 symbols only
+    bool addPlayer(TicTacToePlayer* player) {
+        if(players.size() == 3) {
+            cout << "At most 3 players are supported!" << endl;
+            return false;
+        }
         players.push_back(player);
+        return true;
     }
     
     void addObserver(IObserver* observer) {
@@ -259,14 +855,16 @@ public:
             
             // Take out the current player from dequeue
             TicTacToePlayer* currentPlayer = players.front();
-            cout << currentPlayer->getName() << " (" << currentPlayer->getSymbol()->getMark() << ") - Enter row and column: ";
+            cout << currentPlayer->getName() << " ";
             
             int row, col;
-            cin >> row >> col;
+            if(!currentPlayer->getStrategy()->makeMove(board, currentPlayer->getSymbol(), row, col)) {
+                cout << "No move available, ending game." << endl;
+                return;
+            }
             
             // check if move is valid
-            if(rules->isValidMove(board, row, col)) {
-                board->placeMark(row, col, currentPlayer->getSymbol());
+            if(rules->isValidMove(board, row, col) && board->placeMark(row, col, currentPlayer->getSymbol())) {
                 notify(currentPlayer->getName() + " played (" + to_string(row) + "," + to_string(col) + ")");
                 
                 if(rules->checkWinCondition(board, currentPlayer->getSymbol())) {
@@ -306,21 +904,90 @@ public:
 
 // Enum & Factory Pattern for game creation
 enum GameType {
-    STANDARD
+    STANDARD,
+    K_IN_A_ROW
 };
 
 class TicTacToeGameFactory {
 public:
-    static TicTacToeGame* createGame(GameType gt, int boardSize) {
+    static TicTacToeGame* createGame(GameType gt, int boardSize, int winLength = 0) {
         if(GameType::STANDARD == gt) {
             return new TicTacToeGame(boardSize);
         }
+        if(GameType::K_IN_A_ROW == gt) {
+            return new TicTacToeGame(boardSize, new KInARowTicTacToeRules(winLength));
+        }
         return nullptr;
     }
 };
 
+// Benchmark: many concurrent large boards, measuring memory and move throughput
+void runBoardBenchmark(int games, int boardSize, int movesPerGame) {
+    cout << "=== BOARD BENCHMARK: " << games << " games of " << boardSize << "x" << boardSize << " ===" << endl;
+
+    Symbol* x = new Symbol('X');
+    Symbol* o = new Symbol('O');
+    vector<Board*> boards;
+    size_t packedBytes = 0;
+    for(int g = 0; g < games; g++) {
+        boards.push_back(new Board(boardSize));
+        packedBytes += boards.back()->memoryBytes();
+    }
+
+    // Same boards stored as vector<vector<Symbol*>>
+    size_t pointerBytes = (size_t)games * (sizeof(vector<vector<Symbol*>>)
+                          + boardSize * (sizeof(vector<Symbol*>) + boardSize * sizeof(Symbol*)));
+
+    cout << "Packed grid memory:  " << packedBytes / (1024.0 * 1024.0) << " MB" << endl;
+    cout << "Pointer grid memory: " << pointerBytes / (1024.0 * 1024.0) << " MB" << endl;
+
+    // Interleave moves across all games like a server hosting them concurrently
+    uint64_t seed = 88172645463325252ULL;
+    long long placed = 0;
+    long long reads = 0;
+    long long marksSeen = 0;
+    auto start = chrono::steady_clock::now();
+    for(int m = 0; m < movesPerGame; m++) {
+        Symbol* mark = (m % 2 == 0) ? x : o;
+        for(int g = 0; g < games; g++) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            int row = (int)(seed % boardSize);
+            int col = (int)((seed >> 32) % boardSize);
+            if(boards[g]->placeMark(row, col, mark)) {
+                placed++;
+            }
+            // Read the neighbourhood, as a win check would
+            for(int d = -2; d <= 2; d++) {
+                if(boards[g]->getCell(row, col + d) != boards[g]->getEmptyCell()) {
+                    marksSeen++;
+                }
+                reads++;
+            }
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Moves placed: " << placed << " in " << seconds << " s ("
+         << (long long)(placed / seconds) << " moves/sec)" << endl;
+    cout << "Cell reads:   " << reads << " (" << (long long)(reads / seconds) << " reads/sec, "
+         << marksSeen << " marked)" << endl;
+
+    for(auto board : boards) {
+        delete board;
+    }
+    delete x;
+    delete o;
+}
+
 // Main function for Tic Tac Toe
-int main() {
+int main(int argc, char* argv[]) {
+    if(argc > 1 && string(argv[1]) == "--benchmark") {
+        runBoardBenchmark(10000, 100, 200);
+        return 0;
+    }
+
     cout << "=== TIC TAC TOE GAME ===" << endl;
     
     // Create game with custom board size
@@ -328,7 +995,23 @@ int main() {
     cout << "Enter board size (e.g., 3 for 3x3): ";
     cin >> boardSize;
     
-    TicTacToeGame* game = TicTacToeGameFactory::createGame(GameType::STANDARD, boardSize);
+    int winLength;
+    cout << "Enter marks in a row needed to win (" << boardSize << " for standard): ";
+    cin >> winLength;
+    if(winLength <= 0 || winLength > boardSize) {
+        winLength = boardSize;
+    }
+
+    char vsComputer;
+    cout << "Play against computer? (y/n): ";
+    cin >> vsComputer;
+
+    TicTacToeGame* game;
+    if(winLength == boardSize) {
+        game = TicTacToeGameFactory::createGame(GameType::STANDARD, boardSize);
+    } else {
+        game = TicTacToeGameFactory::createGame(GameType::K_IN_A_ROW, boardSize, winLength);
+    }
     
     // Add observer
     IObserver* notifier = new ConsoleNotifier();
@@ -336,7 +1019,12 @@ int main() {
     
     // Create players with custom symbols
     TicTacToePlayer* player1 = new TicTacToePlayer(1, "Aditya", new Symbol('X'));
-    TicTacToePlayer* player2 = new TicTacToePlayer(2, "Harshita", new Symbol('O'));
+    TicTacToePlayer* player2;
+    if(vsComputer == 'y' || vsComputer == 'Y') {
+        player2 = new TicTacToePlayer(2, "Computer", new Symbol('O'), new ComputerPlayerStrategy(winLength));
+    } else {
+        player2 = new TicTacToePlayer(2, "Harshita", new Symbol('O'));
+    }
     
     game->addPlayer(player1);
     game->addPlayer(player2);
@@ -351,4 +1039,4 @@ int main() {
     delete notifier;
     
     return 0;
-}
\ No newline at end of file
+}